@@ -70,11 +70,13 @@
 #include <cstddef>                      // for size_t
 #include <cassert>                      // for assert
 
-#include <algorithm>                    // for copy, min, fill_n, max
+#include <algorithm>                    // for copy, min, fill_n, max, sort, etc
 #include <array>                        // for array, array<>::iterator, etc
+#include <chrono>                       // for steady_clock, nanoseconds
 #include <functional>                   // for __bind, __base, bind, etc
 #include <limits>                       // for numeric_limits
 #include <memory>                       // for unique_ptr, etc
+#include <new>                          // for operator new
 #include <stdexcept>                    // for runtime_error
 #include <tuple>                        // for get, make_tuple
 #include <type_traits>                  // for move, etc
@@ -90,10 +92,113 @@
 
 namespace agd = ::animation::geometry::dimension;
 
+wobbly::Allocator::~Allocator ()
+{
+}
+
+namespace
+{
+    class HeapAllocator :
+        public wobbly::Allocator
+    {
+        public:
+
+            void * Allocate (size_t size) override
+            {
+                return ::operator new (size);
+            }
+
+            void Deallocate (void *block, size_t) noexcept override
+            {
+                ::operator delete (block);
+            }
+    };
+}
+
+wobbly::Allocator &
+wobbly::Allocator::Heap ()
+{
+    static HeapAllocator heap;
+    return heap;
+}
+
+wobbly::RecyclingAllocator::RecyclingAllocator (Allocator &upstream) :
+    mUpstream (upstream)
+{
+    mFree.fill (nullptr);
+}
+
+wobbly::RecyclingAllocator::~RecyclingAllocator ()
+{
+    for (size_t sizeClass = 0; sizeClass < SizeClasses; ++sizeClass)
+    {
+        while (FreeBlock *block = mFree[sizeClass])
+        {
+            mFree[sizeClass] = block->next;
+            mUpstream.Deallocate (block, SmallestRecycled << sizeClass);
+        }
+    }
+}
+
+size_t
+wobbly::RecyclingAllocator::SizeClass (size_t size)
+{
+    size_t sizeClass = 0;
+
+    while ((SmallestRecycled << sizeClass) < size)
+        ++sizeClass;
+
+    return sizeClass;
+}
+
+void *
+wobbly::RecyclingAllocator::Allocate (size_t size)
+{
+    static_assert ((SmallestRecycled << (SizeClasses - 1)) == LargestRecycled,
+                   "Each size class up to LargestRecycled needs a free list");
+
+    if (size > LargestRecycled)
+        return mUpstream.Allocate (size);
+
+    size_t const sizeClass = SizeClass (size);
+
+    if (FreeBlock *block = mFree[sizeClass])
+    {
+        mFree[sizeClass] = block->next;
+        return block;
+    }
+
+    return mUpstream.Allocate (SmallestRecycled << sizeClass);
+}
+
+void
+wobbly::RecyclingAllocator::Deallocate (void *block, size_t size) noexcept
+{
+    if (size > LargestRecycled)
+    {
+        mUpstream.Deallocate (block, size);
+        return;
+    }
+
+    size_t const sizeClass = SizeClass (size);
+
+    mFree[sizeClass] = new (block) FreeBlock { mFree[sizeClass] };
+}
+
 void
 wobbly::Anchor::MovableAnchorDeleter::operator () (MovableAnchor *anchor)
 {
-    delete anchor;
+    if (!allocator)
+    {
+        delete anchor;
+        return;
+    }
+
+    /* The block starts wherever the most derived anchor does */
+    void *block = dynamic_cast <void *> (anchor);
+
+    anchor->~MovableAnchor ();
+    allocator->Deallocate (block, size);
 }
 
 wobbly::Anchor::Anchor ()
@@ -110,6 +215,49 @@ wobbly::Anchor::MoveBy (animation::Vector const &delta) noexcept
     priv->MoveBy (delta);
 }
 
+wobbly::QueuedAnchor::QueuedAnchor (Anchor &&anchor, Registry &registry) :
+    anchor (std::move (anchor)),
+    registry (registry),
+    sent (Vector (0, 0)),
+    sentTotal (0, 0),
+    appliedTotal (0, 0)
+{
+    registry.push_back (this);
+}
+
+wobbly::QueuedAnchor::~QueuedAnchor ()
+{
+    /* Anything moved since the last step still applies before the
+     * anchor lets go */
+    Apply ();
+
+    registry.erase (std::find (registry.begin (), registry.end (), this));
+}
+
+void
+wobbly::QueuedAnchor::MoveBy (Vector const &delta) noexcept
+{
+    agd::pointwise_add (sentTotal, delta);
+
+    sent.Back () = sentTotal;
+    sent.Publish ();
+}
+
+void
+wobbly::QueuedAnchor::Apply ()
+{
+    Vector const &total (sent.Front ());
+    Vector delta (total);
+
+    agd::pointwise_subtract (delta, appliedTotal);
+
+    if (agd::equals (delta, Vector (0, 0)))
+        return;
+
+    appliedTotal = total;
+    anchor.MoveBy (delta);
+}
+
 wobbly::Anchor
 wobbly::Anchor::Create (Impl &&impl)
 {
@@ -236,130 +384,352 @@ wobbly::Spring::ScaleLength (Vector scaleFactor)
 
 namespace
 {
-    std::vector <wobbly::Spring>
-    GenerateBaseSpringMesh (wobbly::MeshArray       &points,
-                            wobbly::MeshArray       &forces,
-                            animation::Vector const &springDimensions)
+    template <size_t Width, size_t Height>
+    typename wobbly::BasicSpringMesh <Width, Height>::IndexedSprings
+    GenerateBaseSpringMesh (animation::Vector const &springDimensions,
+                            wobbly::Allocator       &allocator)
     {
         using namespace wobbly;
-        std::vector <Spring> springs;
+        typename BasicSpringMesh <Width, Height>::IndexedSprings springs (allocator);
 
         double const springWidth = agd::get <0> (springDimensions);
         double const springHeight = agd::get <1> (springDimensions);
 
-        size_t const nSprings = SpringCountForGridSize (config::Width,
-                                                        config::Height);
+        size_t const nSprings = SpringCountForGridSize (Width, Height);
+
+        springs.first.reserve (nSprings);
+        springs.second.reserve (nSprings);
+        springs.desired.reserve (nSprings * 2);
 
-        springs.reserve (nSprings);
+        auto const addSpring = [&springs](size_t        first,
+                                          size_t        second,
+                                          Vector const &distance) {
+            springs.first.push_back (first);
+            springs.second.push_back (second);
+            springs.desired.push_back (agd::get <0> (distance));
+            springs.desired.push_back (agd::get <1> (distance));
+        };
 
-        for (size_t j = 0; j < config::Height; ++j)
+        for (size_t j = 0; j < Height; ++j)
         {
-            for (size_t i = 0; i < config::Width; ++i)
+            for (size_t i = 0; i < Width; ++i)
             {
-                typedef PointView <double> DPV;
-                typedef PointView <double const> CDPV;
-
-                size_t current = j * config::Width + i;
-                size_t below = (j + 1) * config::Width + i;
-                size_t right = j * config::Width + i + 1;
+                size_t current = j * Width + i;
+                size_t below = (j + 1) * Width + i;
+                size_t right = j * Width + i + 1;
 
                 /* Spring from us to object below us */
-                if (j < config::Height - 1)
-                {
-                    springs.emplace_back (DPV (forces, current),
-                                          DPV (forces, below),
-                                          CDPV (points, current),
-                                          CDPV (points, below),
-                                          Vector (0.0, springHeight));
-                }
+                if (j < Height - 1)
+                    addSpring (current, below, Vector (0.0, springHeight));
 
                 /* Spring from us to object right of us */
-                if (i < config::Width - 1)
-                {
-                    springs.emplace_back (DPV (forces, current),
-                                          DPV (forces, right),
-                                          CDPV (points, current),
-                                          CDPV (points, right),
-                                          Vector (springWidth, 0.0f));
-                }
+                if (i < Width - 1)
+                    addSpring (current, right, Vector (springWidth, 0.0f));
             }
         }
 
-        assert (springs.size () == nSprings);
+        assert (springs.Count () == nSprings);
 
         return springs;
     }
 }
 
-wobbly::SpringMesh::SpringMesh (MeshArray    &points,
-                                Vector const &springDimensions) :
-    mSprings (GenerateBaseSpringMesh (points, mForces, springDimensions)),
+template <size_t Width, size_t Height>
+wobbly::BasicSpringMesh <Width, Height>::BasicSpringMesh (MeshArray    &points,
+                                                          Vector const &springDimensions,
+                                                          Allocator    &allocator) :
+    mAllocator (allocator),
+    mSprings (points,
+              mForces,
+              GenerateBaseSpringMesh <Width, Height> (springDimensions,
+                                                      allocator)),
     mInserted ()
 {
 }
 
+template <size_t Width, size_t Height>
 void
-wobbly::SpringMesh::Scale (Vector const &scaleFactor)
+wobbly::BasicSpringMesh <Width, Height>::Scale (Vector const &scaleFactor)
 {
-    mSprings.Each ([&scaleFactor](Spring &spring) {
-        spring.ScaleLength (scaleFactor);
-    });
+    mSprings.Scale (scaleFactor);
 }
 
-namespace
+template <size_t Width, size_t Height>
+void
+wobbly::BasicSpringMesh <Width, Height>::SpringVector::Scale (Vector const &scaleFactor)
 {
-    wobbly::Spring const &
-    FindSpringToSplit (animation::Point                 const &install,
-                       wobbly::SpringMesh::SpringVector const &vector)
+    size_t const nBase = mBase.Count ();
+    for (size_t i = 0; i < nBase; ++i)
     {
-        using namespace wobbly;
+        PointView <double> desired (mBase.desired.data (), i);
+        agd::pointwise_scale (desired, scaleFactor);
+    }
+
+    for (auto &spring : mAnchorSprings)
+        spring.ScaleLength (scaleFactor);
+}
 
-        wobbly::Spring const *found = nullptr;
-        double primaryDistance = std::numeric_limits <double>::max ();
-        double secondaryDistance = std::numeric_limits <double>::max ();
+template <size_t Width, size_t Height>
+wobbly::TemporaryOwner <wobbly::Spring>
+wobbly::BasicSpringMesh <Width, Height>::SpringVector::TakeClosest (Point const &install)
+{
+    double primaryDistance = std::numeric_limits <double>::max ();
+    double secondaryDistance = std::numeric_limits <double>::max ();
+
+    std::experimental::optional <size_t> found;
+    bool foundInBase = false;
+
+    auto const consider = [&](PointView <double const> const &first,
+                              PointView <double const> const &second,
+                              size_t                         index,
+                              bool                           base) {
+        double currentSpringPrimaryDistance = agd::distance (first, install);
+        if (currentSpringPrimaryDistance < primaryDistance)
+        {
+            primaryDistance = currentSpringPrimaryDistance;
+            secondaryDistance = std::numeric_limits <double>::max ();
+            found = index;
+            foundInBase = base;
+        }
 
-        vector.Each ([&](Spring const &spring) {
-            double currentSpringPrimaryDistance =
-                agd::distance (spring.FirstPosition (), install);
-            if (currentSpringPrimaryDistance < primaryDistance)
+        /* Branch will be taken for any match of spring with
+         * best primary distance */
+        if (currentSpringPrimaryDistance == primaryDistance)
+        {
+            double currentSpringSecondaryDistance =
+                agd::distance (second, install);
+            if (currentSpringSecondaryDistance < secondaryDistance)
             {
-                primaryDistance = currentSpringPrimaryDistance;
-                secondaryDistance = std::numeric_limits <double>::max ();
-                found = &spring;
+                found = index;
+                foundInBase = base;
+                secondaryDistance = currentSpringSecondaryDistance;
             }
+        }
+    };
 
-            /* Branch will be taken for any match of spring with
-             * best primary distance */
-            if (currentSpringPrimaryDistance == primaryDistance)
-            {
-                double currentSpringSecondaryDistance =
-                    agd::distance (spring.SecondPosition (), install);
-                if (currentSpringSecondaryDistance < secondaryDistance)
-                {
-                    found = &spring;
+    size_t const nBase = mBase.Count ();
+    for (size_t i = 0; i < nBase; ++i)
+        consider (PointView <double const> (mPositions, mBase.first[i]),
+                  PointView <double const> (mPositions, mBase.second[i]),
+                  i,
+                  true);
 
-                    /* This variable is used again on the next iteration
-                     * of the loop, but cppcheck can't see through the
-                     * implicit reference capture */
-                    // cppcheck-suppress unreadVariable
-                    secondaryDistance = currentSpringSecondaryDistance;
-                }
-            }
-        });
+    for (size_t i = 0; i < mAnchorSprings.size (); ++i)
+        consider (mAnchorSprings[i].FirstPosition (),
+                  mAnchorSprings[i].SecondPosition (),
+                  i,
+                  false);
+
+    assert (found);
+
+    return foundInBase ? TakeBase (*found) : TakeAnchored (*found);
+}
+
+template <size_t Width, size_t Height>
+wobbly::TemporaryOwner <wobbly::Spring>
+wobbly::BasicSpringMesh <Width, Height>::SpringVector::TakeBase (size_t index)
+{
+    size_t const first = mBase.first[index];
+    size_t const second = mBase.second[index];
+    Vector const desired (mBase.desired[index * 2],
+                          mBase.desired[index * 2 + 1]);
+
+    mBase.first.erase (mBase.first.begin () + index);
+    mBase.second.erase (mBase.second.begin () + index);
+    mBase.desired.erase (mBase.desired.begin () + index * 2,
+                         mBase.desired.begin () + index * 2 + 2);
+    mIncidenceValid = false;
+
+    /* Hand out a Spring viewing the same points, so that the caller
+     * can use it in the same way as a spring in the anchor table */
+    Spring steal (PointView <double> (mForces, first),
+                  PointView <double> (mForces, second),
+                  PointView <double const> (mPositions, first),
+                  PointView <double const> (mPositions, second),
+                  desired);
+
+    /* Springs between mesh points are never tracked, so they
+     * can always go straight back into the index arrays. They go back
+     * where GenerateBaseSpringMesh put them (ordered by first point,
+     * then the spring below before the one to the right), so that once
+     * every spring is back the mesh is a plain grid again.
+     *
+     * Everything needed to put it back is read from the spring itself,
+     * which keeps the replacer small enough to be stored in the
+     * TemporaryOwner without an allocation */
+    auto const replacer = [this](Spring &&spring) {
+        size_t const first = (&spring.FirstPosition ().get <0> () -
+                              mPositions.data ()) / 2;
+        size_t const second = (&spring.SecondPosition ().get <0> () -
+                               mPositions.data ()) / 2;
+        Vector const &desired (spring.DesiredDistance ());
+        size_t index = 0;
+
+        while (index < mBase.Count () &&
+               (mBase.first[index] < first ||
+                (mBase.first[index] == first && mBase.second[index] > second)))
+            ++index;
+
+        mBase.first.insert (mBase.first.begin () + index, first);
+        mBase.second.insert (mBase.second.begin () + index, second);
+        mBase.desired.insert (mBase.desired.begin () + index * 2,
+                              { agd::get <0> (desired), agd::get <1> (desired) });
+        mIncidenceValid = false;
+    };
+
+    TemporaryOwner <Spring> tmp (std::move (steal), replacer);
+    return tmp;
+}
+
+template <size_t Width, size_t Height>
+bool
+wobbly::BasicSpringMesh <Width, Height>::SpringVector::IsGrid () const
+{
+    /* Base springs are always kept in generated order, see TakeBase */
+    return mAnchorSprings.empty () &&
+           mBase.Count () == SpringCountForGridSize (Width, Height);
+}
+
+template <size_t Width, size_t Height>
+bool
+wobbly::BasicSpringMesh <Width, Height>::IsGrid () const
+{
+    return mSprings.IsGrid ();
+}
+
+template <size_t Width, size_t Height>
+wobbly::TemporaryOwner <wobbly::Spring>
+wobbly::BasicSpringMesh <Width, Height>::SpringVector::TakeAnchored (size_t index)
+{
+    auto it = mAnchorSprings.begin () + index;
+    Spring steal (std::move (*it));
+    mAnchorSprings.erase (it);
+    mIncidenceValid = false;
+
+    auto const replacer = [this](Spring &&spring) {
+        auto const idExists =
+            [this, &spring](Spring::ID const &id) {
+                return spring.HasID (id);
+            };
+
+        auto exists =
+            std::remove_if (std::begin (mPending),
+                            std::end (mPending),
+                            idExists);
+
+        if (exists != mPending.end ())
+            mPending.erase (exists);
+        else
+            mAnchorSprings.emplace_back (std::move (spring));
+
+        mIncidenceValid = false;
+    };
+
+    TemporaryOwner <Spring> tmp (std::move (steal), replacer);
+    return tmp;
+}
+
+namespace
+{
+    size_t const NotInMesh = std::numeric_limits <size_t>::max ();
+
+    /* Which mesh point view is looking at, if any */
+    template <typename MeshArray>
+    size_t MeshIndexOf (animation::PointView <double const> const &view,
+                        MeshArray                           const &mesh)
+    {
+        double const *point = &view.get <0> ();
+        std::less <double const *> const before;
+
+        if (before (point, mesh.data ()) ||
+            !before (point, mesh.data () + mesh.size ()))
+            return NotInMesh;
+
+        return (point - mesh.data ()) / 2;
+    }
+
+    /* Fills offsets and entries for a table of springs given the mesh
+     * index of the ends of each spring */
+    template <size_t TotalIndices, typename EndIndex>
+    void BuildIncidenceTable (size_t               nSprings,
+                              EndIndex      const &endIndex,
+                              std::vector <size_t> &offsets,
+                              std::vector <size_t> &entries)
+    {
+        offsets.assign (TotalIndices + 1, 0);
+
+        for (size_t i = 0; i < nSprings; ++i)
+            for (size_t end = 0; end < 2; ++end)
+                if (endIndex (i, end) != NotInMesh)
+                    ++offsets[endIndex (i, end) + 1];
+
+        for (size_t i = 0; i < TotalIndices; ++i)
+            offsets[i + 1] += offsets[i];
+
+        /* Filling in spring order keeps each point's entries in
+         * spring order too. Each point's offset is used as its cursor,
+         * which leaves it at the start of the next point, so they are
+         * shifted back afterwards. This saves allocating separate
+         * cursors whenever the springs change */
+        entries.resize (offsets.back ());
+
+        for (size_t i = 0; i < nSprings; ++i)
+            for (size_t end = 0; end < 2; ++end)
+                if (endIndex (i, end) != NotInMesh)
+                    entries[offsets[endIndex (i, end)]++] = (i << 1) | end;
+
+        for (size_t i = TotalIndices; i > 0; --i)
+            offsets[i] = offsets[i - 1];
 
-        assert (found != nullptr);
-        return *found;
+        offsets[0] = 0;
     }
 }
 
-wobbly::SpringMesh::InstallResult
-wobbly::SpringMesh::InstallAnchorSprings (Point         const &install,
-                                          PosPreference const &firstPref,
-                                          PosPreference const &secondPref)
+template <size_t Width, size_t Height>
+void
+wobbly::BasicSpringMesh <Width, Height>::SpringVector::BuildIncidence () const
+{
+    auto const baseEnd = [this](size_t spring, size_t end) {
+        return end ? mBase.second[spring] : mBase.first[spring];
+    };
+
+    BuildIncidenceTable <Width * Height> (mBase.Count (),
+                                          baseEnd,
+                                          mIncidence.baseOffsets,
+                                          mIncidence.baseEntries);
+
+    auto const anchorEnd = [this](size_t spring, size_t end) {
+        Spring const &s (mAnchorSprings[spring]);
+        return MeshIndexOf (end ? s.SecondPosition () : s.FirstPosition (),
+                            mPositions);
+    };
+
+    BuildIncidenceTable <Width * Height> (mAnchorSprings.size (),
+                                          anchorEnd,
+                                          mIncidence.anchorOffsets,
+                                          mIncidence.anchorEntries);
+
+    mIncidence.detached.clear ();
+    for (size_t i = 0; i < mAnchorSprings.size (); ++i)
+        if (anchorEnd (i, 0) == NotInMesh && anchorEnd (i, 1) == NotInMesh)
+            mIncidence.detached.push_back (i);
+
+    mIncidenceValid = true;
+}
+
+template <size_t Width, size_t Height>
+typename wobbly::BasicSpringMesh <Width, Height>::InstallResult
+wobbly::BasicSpringMesh <Width, Height>::InstallAnchorSprings (Point         const &install,
+                                                               PosPreference const &firstPref,
+                                                               PosPreference const &secondPref)
 {
-    Spring const &found (FindSpringToSplit (install, mSprings));
+    /* Move out the split spring first. The stolen spring stays alive
+     * for as long as the returned owner does, so its views remain
+     * valid throughout the rest of this function */
+    auto stolen (mSprings.TakeClosest (install));
+    Spring const &found (stolen);
 
-    std::unique_ptr <double[]> data (new double[4]);
+    auto data (AllocateArray <double> (mAllocator, 4));
     std::fill_n (data.get (), 4, 0);
     animation::PointView <double> anchorView (data.get (), 0);
     agd::assign (anchorView, install);
@@ -396,13 +766,6 @@ wobbly::SpringMesh::InstallAnchorSprings (Point         const &install,
                                              delta);
         };
 
-    /* Move out the split spring first */
-    auto stolen =
-        mSprings.TakeMatching ([&found](Spring const &spring) {
-            return &spring == &found;
-        });
-
-    /* After this point, "found" is invalidated */
     auto first (insertSpring (std::move (firstPoint),
                               std::move (firstDesired),
                               std::move (firstForce)));
@@ -427,21 +790,109 @@ wobbly::SpringMesh::InstallAnchorSprings (Point         const &install,
 
 namespace wobbly
 {
-    class Model::Private
+    template <size_t Width, size_t Height>
+    struct BasicModel <Width, Height>::Snapshot::Frame
+    {
+        BasicBezierMesh <Width, Height> mesh;
+        Surface                         surface;
+        unsigned long long              sequence;
+    };
+
+    template <size_t Width, size_t Height>
+    class BasicModel <Width, Height>::Private
     {
         public:
 
+            typedef BasicMeshArray <Width, Height> MeshArray;
+            typedef BasicAnchorArray <Width, Height> AnchorArray;
+            typedef BasicTargetMesh <Width, Height> TargetMesh;
+            typedef BasicConstrainmentStep <Width, Height> ConstrainmentStep;
+            typedef BasicBezierMesh <Width, Height> BezierMesh;
+            typedef BasicEulerIntegration <Width, Height> EulerIntegration;
+            typedef BasicImplicitEulerIntegration <Width, Height> ImplicitEulerIntegration;
+            typedef SpringStep <EulerIntegration, Width, Height> MeshSpringStep;
+            typedef EquilibriumSolver <Width, Height> Solver;
+            typedef LaneBatch <Width, Height> Lanes;
+            typedef typename Snapshot::Frame Frame;
+
             Private (Point    const &initialPosition,
                      double         width,
                      double         height,
-                     Settings const &settings);
+                     Settings const &settings,
+                     Allocator      &allocator);
 
             std::array <animation::Point, 4> const
             Extremes () const;
 
-            template <typename... Args>
             animation::Point
-            TargetPositionByFullIntegration (Args&& ...additionalSteps) const;
+            TargetPositionBySolving () const;
+
+            bool CachedTargetValid () const;
+            void InvalidateCachedTarget ();
+
+            /* Whether the mesh can be stepped in a LaneBatch alongside
+             * other models, which is the case at Full detail without
+             * interpolation or adaptive stepping while nothing holds it
+             * and no anchors are inserted. Stepping it there and storing
+             * it back is then the same as Step. */
+            bool SteppableInLanes () const;
+            size_t LoadLane (Lanes &lanes) const;
+            void StoreLane (Lanes const &lanes, size_t lane, bool more);
+
+            /* Tells whoever is stepping the model that it may have been
+             * set moving, see mActivated */
+            void Activated () const;
+
+            /* Moves each queued anchor by whatever was sent to it since
+             * the last step */
+            void ApplyQueuedMotion ();
+
+            /* How many of steps to integrate at the current detail */
+            unsigned int StepsAtDetail (unsigned int steps);
+
+            /* Puts the mesh at rest where it would settle, see
+             * Detail::Rigid */
+            void SettleRigidly ();
+
+            /* Writes where each point would settle into rest */
+            void RestPositions (MeshArray &rest) const;
+
+            /* How much more energy the mesh has than it will have at
+             * rest, not counting drift, the velocity of the mesh as a
+             * whole that rest already takes in */
+            double EnergyAboveRest (MeshArray         const &rest,
+                                    animation::Vector const &drift) const;
+
+            /* See BasicModel::SettleTime */
+            double StepsToSettle (double threshold) const;
+
+            /* Integrates steps at once with as few implicit steps as
+             * CatchUpStepLength allows, returning true if any of them
+             * would need more */
+            bool CatchUp (unsigned int steps);
+
+            /* Integrates steps with explicit steps as long as they can
+             * be, see SetAdaptiveStepping, returning true if the mesh
+             * would need more */
+            bool StepAdaptively (unsigned int steps);
+
+            /* Kinetic energy of the mesh plus the energy in its springs */
+            double Energy () const;
+
+            /* Hands the mesh as it is now to whoever is reading
+             * snapshots, if anyone is */
+            void Publish ();
+
+            /* The mesh to deform and publish, which is mRendered when
+             * interpolating */
+            BezierMesh const & RenderedMesh () const;
+
+            /* See BasicModel::InterpolationFactor */
+            double InterpolationFactor () const;
+
+            /* Blends mRendered from mPrevious and the mesh as it is now
+             * by InterpolationFactor, if interpolating */
+            void Interpolate ();
 
             animation::Point
             TargetPosition () const;
@@ -451,6 +902,9 @@ namespace wobbly
 
             double mWidth, mHeight;
 
+            /* Where the springs and anchors come from */
+            Allocator                     &mAllocator;
+
             /* Anchor - is the point locked or unlocked */
             AnchorArray                   mAnchors;
 
@@ -464,99 +918,261 @@ namespace wobbly
             BezierMesh                    mPositions;
 
             /* Force of each point on the grid */
-            SpringStep <EulerIntegration> mSpring;
+            MeshSpringStep                mSpring;
 
             /* Velocity of the point on the grid */
             EulerIntegration              mVelocityIntegrator;
 
-            Model::Settings        const &mSettings;
+            /* State which stepping only touches to catch up, solve for
+             * where the mesh rests or interpolate. It is kept out of
+             * line so that the meshes above stay close together, which
+             * for pooled models puts them close to their neighbours' */
+            struct Cold
+            {
+                /* The factors of the integrator and the solver are only
+                 * allocated when first needed, which can be during a step
+                 * that ModelPool runs on another thread. They come from
+                 * the heap, since the model's allocator need not be safe
+                 * to use there. */
+                explicit Cold (double const &springConstant) :
+                    catchUp (springConstant, Allocator::Heap ()),
+                    solver (Allocator::Heap ())
+                {
+                }
+
+                ImplicitEulerIntegration catchUp;
+                Solver                   solver;
+                MeshArray                previous;
+                BezierMesh               rendered;
+            };
+
+            AllocatedObject <Cold>        mCold;
+
+            /* Takes over from mVelocityIntegrator in CatchUp */
+            ImplicitEulerIntegration      &mCatchUpIntegrator;
+
+            /* Rest position of the mesh, see TargetPositionBySolving */
+            Solver                        &mSolver;
+
+            /* See SetInterpolation. mPrevious is the mesh before the
+             * last step, or the mesh as it is once nothing is moving */
+            MeshArray                     &mPrevious;
+            BezierMesh                    &mRendered;
+
+            /* The target position last solved for while nothing held the
+             * mesh, along with the friction it was solved with, since that
+             * is the only setting that the solution depends on. Stepping a
+             * mesh which nothing holds does not change where it will
+             * settle, so this stays valid until an anchor is created, the
+             * mesh is resized or stepped while held, or settings change. */
+            std::experimental::optional <animation::Point> mutable mCachedTarget;
+            double mutable                                         mCachedFriction;
+
+            Settings               const &mSettings;
+
+            Surface                       mSurface;
 
             bool mCurrentlyUnequal;
+
+            /* Set by a BasicModelPool so that it knows to start stepping
+             * the model again once it is grabbed, moved or resized */
+            std::function <void ()>       mActivated;
+
+            /* Snapshots for another thread, once PublishSnapshots has
+             * been called */
+            std::unique_ptr <TripleBuffer <Frame>> mSnapshots;
+            unsigned long long                     mPublished = 0;
+
+            /* Anchors created by GrabQueuedAnchor and InsertQueuedAnchor */
+            QueuedAnchor::Registry mQueuedAnchors;
+
+            Detail       mDetail = Detail::Full;
+
+            /* Steps not yet integrated at Reduced detail */
+            unsigned int mDeferredSteps = 0;
+
+            /* Time which Advance has not stepped yet, always less than
+             * StepInterval, and the timestamp last given to AdvanceTo */
+            std::chrono::nanoseconds mAccumulated = std::chrono::nanoseconds (0);
+            std::experimental::optional <std::chrono::nanoseconds> mLastTimestamp;
+
+            /* See SetInterpolation */
+            bool mInterpolating = false;
+
+            /* See SetAdaptiveStepping, SubSteps and Diverged */
+            bool         mAdaptive = false;
+            unsigned int mSubSteps = 0;
+            bool         mDiverged = false;
+
+            /* See SleepingPoints and SleepingSprings */
+            size_t mSleptPoints = 0;
+            size_t mSleptSprings = 0;
     };
 }
 
-wobbly::Model::Private::Private (Point    const &initialPosition,
-                                 double         width,
-                                 double         height,
-                                 Settings const &settings) :
+template <size_t Width, size_t Height>
+wobbly::BasicModel <Width, Height>::Private::Private (Point    const &initialPosition,
+                                                      double         width,
+                                                      double         height,
+                                                      Settings const &settings,
+                                                      Allocator      &allocator) :
     mWidth (width),
     mHeight (height),
+    mAllocator (allocator),
     mTargets ([this](MeshArray &mesh) {
-                  /* Use a full integration to compute the target position
-                   * in case the anchor count ever drops to 1 - we don't
-                   * want to short-circuit our own computation by just
-                   * returning the existing targets array.
+                  /* Solve for the target position in case the anchor count
+                   * ever drops to 1 - we don't want to short-circuit our
+                   * own computation by just returning the existing
+                   * targets array.
                    *
-                   * Note that we do not pass the constrainment step here -
-                   * the constrainment step uses the targets, which we're
-                   * trying to compute. */
-                  auto target (TargetPositionByFullIntegration ());
-                  mesh::CalculatePositionArray (target,
-                                                mesh,
-                                                TileSize ());
+                   * On the first activation, nothing has changed since
+                   * the mesh was last free, so the cached target is still
+                   * good if there is one. */
+                  auto target (CachedTargetValid () ? *mCachedTarget :
+                                                      TargetPositionBySolving ());
+                  mesh::CalculatePositionArray <Width, Height> (target,
+                                                                mesh,
+                                                                TileSize ());
               }),
     mConstrainment (settings.maximumRange, mTargets),
     mSpring (mVelocityIntegrator,
              mPositions.PointArray (),
              settings.springConstant,
              settings.friction,
-             TileSize ()),
+             TileSize (),
+             allocator),
+    mCold (AllocateObject <Cold> (allocator, settings.springConstant)),
+    mCatchUpIntegrator (mCold->catchUp),
+    mSolver (mCold->solver),
+    mPrevious (mCold->previous),
+    mRendered (mCold->rendered),
+    mCachedFriction (settings.friction),
     mSettings (settings),
+    mSurface (Surface::SinglePatch),
     mCurrentlyUnequal (false)
 {
     /* First construct the position array */
-    mesh::CalculatePositionArray (initialPosition,
-                                  mPositions.PointArray (),
-                                  TileSize ());
+    mesh::CalculatePositionArray <Width, Height> (initialPosition,
+                                                  mPositions.PointArray (),
+                                                  TileSize ());
 
     /* Copy that into the mesh estimation */
     std::copy (mPositions.PointArray ().begin (),
                mPositions.PointArray ().end (),
                mTargets.PointArray ().begin ());
+
+    mPrevious = mPositions.PointArray ();
+    mRendered = mPositions;
 }
 
-wobbly::Model::Settings wobbly::Model::DefaultSettings =
+wobbly::ModelBase::Detail
+wobbly::ModelBase::DetailForSize (double visibleWidth, double visibleHeight)
 {
-    wobbly::Model::DefaultSpringConstant,
-    wobbly::Model::Friction,
-    wobbly::Model::DefaultObjectRange
+    if (visibleWidth <= 0.0 || visibleHeight <= 0.0)
+        return Detail::Rigid;
+
+    if (visibleWidth < ReducedDetailSize || visibleHeight < ReducedDetailSize)
+        return Detail::Reduced;
+
+    return Detail::Full;
+}
+
+wobbly::ModelBase::Settings wobbly::ModelBase::DefaultSettings =
+{
+    wobbly::ModelBase::DefaultSpringConstant,
+    wobbly::ModelBase::Friction,
+    wobbly::ModelBase::DefaultObjectRange
 };
 
-wobbly::Model::Model (Point const &initialPosition,
-                      double      width,
-                      double      height,
-                      Settings    const &settings) :
-    priv (new Private (initialPosition, width, height, settings))
+template <size_t Width, size_t Height>
+wobbly::BasicModel <Width, Height>::BasicModel (Point const &initialPosition,
+                                                double      width,
+                                                double      height,
+                                                Settings    const &settings) :
+    BasicModel (initialPosition, width, height, settings, Allocator::Heap ())
+{
+}
+
+template <size_t Width, size_t Height>
+wobbly::BasicModel <Width, Height>::BasicModel (Point const &initialPosition,
+                                                double      width,
+                                                double      height) :
+    BasicModel (initialPosition, width, height, DefaultSettings, Allocator::Heap ())
 {
 }
 
-wobbly::Model::Model (Point const &initialPosition,
-                      double      width,
-                      double      height) :
-    priv (new Private (initialPosition, width, height, DefaultSettings))
+template <size_t Width, size_t Height>
+wobbly::BasicModel <Width, Height>::BasicModel (Point     const &initialPosition,
+                                                double          width,
+                                                double          height,
+                                                Settings  const &settings,
+                                                Allocator       &allocator) :
+    priv (nullptr, PrivateDeleter { false, &allocator })
+{
+    void *block = allocator.Allocate (sizeof (Private));
+
+    try
+    {
+        priv.reset (new (block) Private (initialPosition,
+                                         width,
+                                         height,
+                                         settings,
+                                         allocator));
+    }
+    catch (...)
+    {
+        allocator.Deallocate (block, sizeof (Private));
+        throw;
+    }
+}
+
+template <size_t Width, size_t Height>
+wobbly::BasicModel <Width, Height>::BasicModel (Private *pooled) :
+    priv (pooled, PrivateDeleter { true, nullptr })
 {
 }
 
+template <size_t Width, size_t Height>
+void
+wobbly::BasicModel <Width, Height>::PrivateDeleter::operator() (Private *p) const
+{
+    p->~Private ();
+
+    if (!pooled)
+        allocator->Deallocate (p, sizeof (Private));
+}
 
-wobbly::Model::~Model ()
+
+template <size_t Width, size_t Height>
+wobbly::BasicModel <Width, Height>::~BasicModel ()
 {
 }
 
 namespace
 {
-    template <typename Integrator>
-    bool PerformIntegration (wobbly::MeshArray         &positions,
-                             wobbly::AnchorArray const &anchors,
-                             Integrator                &&integrator)
+    /* One integration is performed per 16 ms, rounding up */
+    unsigned int StepsForTime (unsigned int time)
+    {
+        double const FPStepResolution = wobbly::ModelBase::StepInterval.count ();
+        return static_cast <unsigned int> (std::ceil (time / FPStepResolution));
+    }
+
+    template <typename MeshArray, typename AnchorArray, typename Integrator>
+    bool PerformIntegration (MeshArray         &positions,
+                             AnchorArray const &anchors,
+                             Integrator        &&integrator)
     {
         return integrator (positions, anchors);
     }
 
-    template <typename Integrator, typename... Remaining>
-    bool PerformIntegration (wobbly::MeshArray         &positions,
-                             wobbly::AnchorArray const &anchors,
-                             Integrator                &&integrator,
-                             Remaining&&...            remaining)
+    template <typename MeshArray,
+              typename AnchorArray,
+              typename Integrator,
+              typename... Remaining>
+    bool PerformIntegration (MeshArray         &positions,
+                             AnchorArray const &anchors,
+                             Integrator        &&integrator,
+                             Remaining&&...    remaining)
     {
         bool more = integrator (positions, anchors);
         more |= PerformIntegration (positions,
@@ -565,11 +1181,11 @@ namespace
         return more;
     }
 
-    template <typename... Args>
-    bool Integrate (wobbly::MeshArray         &positions,
-                    wobbly::AnchorArray const &anchors,
-                    unsigned int              steps,
-                    Args&&                    ...integrators)
+    template <typename MeshArray, typename AnchorArray, typename... Args>
+    bool Integrate (MeshArray         &positions,
+                    AnchorArray const &anchors,
+                    unsigned int      steps,
+                    Args&&            ...integrators)
     {
         bool more = false;
 
@@ -592,7 +1208,8 @@ namespace
          * you end up with model instability.
          *
          * Having one step every frame is a good approximation although that
-         * might need to change in the future */
+         * might need to change in the future. Long gaps between frames are
+         * caught up on implicitly, see Private::CatchUp. */
         do
         {
             more |= PerformIntegration (positions,
@@ -622,39 +1239,34 @@ namespace
     }
 }
 
-template <typename... Args>
+template <size_t Width, size_t Height>
 animation::Point
-wobbly::Model::Private::TargetPositionByFullIntegration (Args&& ...additionalSteps) const
+wobbly::BasicModel <Width, Height>::Private::TargetPositionBySolving () const
 {
-    animation::Vector const tileSize (TileSize ());
-
-    auto points (mPositions.PointArray ());
-    auto &anchors (mAnchors);
-
-    /* Make our own copies of the integrators and run the integration on them */
-    EulerIntegration              integrator (mVelocityIntegrator);
-    SpringStep <EulerIntegration> spring (integrator,
-                                          points,
-                                          mSettings.springConstant,
-                                          mSettings.friction,
-                                          tileSize);
-
-    /* Keep on integrating this copy until we know the final position */
-    while (Integrate (points,
-                      anchors,
-                      1,
-                      spring,
-                      std::forward <Args> (additionalSteps)...));
-
-    /* Model will be settled, return the top left point */
+    /* This gives the position the mesh would settle at if it were
+     * integrated until nothing moved, but in bounded time. Only base
+     * springs are considered, as with integration inserted anchors
+     * do not lock any point and their springs would never settle */
+    MeshArray settled;
+    mSolver.Solve (mPositions.PointArray (),
+                   mVelocityIntegrator.Velocities (),
+                   mAnchors,
+                   TileSize (),
+                   mSettings.friction,
+                   Mass,
+                   1.0,
+                   settled);
+
+    /* Return the top left point */
     animation::Point result;
-    agd::assign (result, animation::PointView <double const> (points, 0));
+    agd::assign (result, animation::PointView <double const> (settled, 0));
 
     return result;
 }
 
+template <size_t Width, size_t Height>
 animation::Point
-wobbly::Model::Private::TargetPosition () const
+wobbly::BasicModel <Width, Height>::Private::TargetPosition () const
 {
     /* If we have at least one anchor, we can take a short-cut and determine
      * the target position by reference to it */
@@ -667,42 +1279,474 @@ wobbly::Model::Private::TargetPosition () const
     if (std::get <0> (early))
         return std::get <1> (early);
 
+    /* Constrainment never applies here, since it only takes place
+     * while the targets are active */
+    if (mTargets.Held ())
+        return TargetPositionBySolving ();
+
+    if (!CachedTargetValid ())
+    {
+        mCachedTarget = TargetPositionBySolving ();
+        mCachedFriction = mSettings.friction;
+    }
 
-    ConstrainmentStep constrainment (mConstrainment);
-    return TargetPositionByFullIntegration (constrainment);
+    return *mCachedTarget;
 }
 
-animation::Vector
-wobbly::Model::Private::TileSize () const
+template <size_t Width, size_t Height>
+bool
+wobbly::BasicModel <Width, Height>::Private::CachedTargetValid () const
 {
-    return animation::Vector (mWidth / (config::Width - 1),
-                              mHeight / (config::Height - 1));
+    return mCachedTarget && mCachedFriction == mSettings.friction;
 }
 
-namespace
+template <size_t Width, size_t Height>
+void
+wobbly::BasicModel <Width, Height>::Private::InvalidateCachedTarget ()
 {
-    class InsertedSprings
-    {
-        public:
-
-            typedef wobbly::SpringMesh::AnchorDataVector ADV;
+    mCachedTarget = std::experimental::nullopt;
+}
 
-            typedef wobbly::TemporaryOwner <wobbly::Spring> Stolen;
-            typedef wobbly::TemporaryOwner <wobbly::Spring::ID> Temporary;
-            typedef wobbly::TemporaryOwner <ADV::ID> Anchor;
+template <size_t Width, size_t Height>
+bool
+wobbly::BasicModel <Width, Height>::Private::SteppableInLanes () const
+{
+    return mDetail == Detail::Full &&
+           !mInterpolating &&
+           !mAdaptive &&
+           !mConstrainment.ActiveTargets () &&
+           mSpring.Mesh ().IsGrid ();
+}
 
-            InsertedSprings (Stolen                     &&stolen,
-                             Temporary                  &&first,
-                             Temporary                  &&second,
-                             std::unique_ptr <double[]> &&data,
-                             Anchor                     &&anchor) :
-                stolen (std::move (stolen)),
-                first (std::move (first)),
-                second (std::move (second)),
-                data (std::move (data)),
-                anchor (std::move (anchor))
-            {
-            }
+template <size_t Width, size_t Height>
+size_t
+wobbly::BasicModel <Width, Height>::Private::LoadLane (Lanes &lanes) const
+{
+    return lanes.Load (mPositions.PointArray (),
+                       mVelocityIntegrator.Velocities (),
+                       mSpring.Mesh ().BaseSprings ().desired,
+                       mAnchors.AnchorMask (),
+                       mSettings.springConstant,
+                       mSettings.friction);
+}
+
+template <size_t Width, size_t Height>
+void
+wobbly::BasicModel <Width, Height>::Private::StoreLane (Lanes const &lanes,
+                                                        size_t      lane,
+                                                        bool        more)
+{
+    lanes.Store (lane,
+                 mPositions.PointArray (),
+                 mVelocityIntegrator.Velocities ());
+
+    /* The mesh may still be held by more than one anchor, which then
+     * move it as it is integrated, as in Step */
+    if (mTargets.Held ())
+        InvalidateCachedTarget ();
+
+    /* Lanes never step a mesh held by a single anchor, so unlike Step
+     * there is no target to snap to */
+    mCurrentlyUnequal = more;
+
+    Publish ();
+}
+
+template <size_t Width, size_t Height>
+void
+wobbly::BasicModel <Width, Height>::Private::Activated () const
+{
+    if (mActivated)
+        mActivated ();
+}
+
+template <size_t Width, size_t Height>
+void
+wobbly::BasicModel <Width, Height>::Private::ApplyQueuedMotion ()
+{
+    for (QueuedAnchor *anchor : mQueuedAnchors)
+        anchor->Apply ();
+}
+
+template <size_t Width, size_t Height>
+unsigned int
+wobbly::BasicModel <Width, Height>::Private::StepsAtDetail (unsigned int steps)
+{
+    if (mDetail != Detail::Reduced)
+        return steps;
+
+    mDeferredSteps += steps;
+    steps = mDeferredSteps / ReducedStepRatio;
+    mDeferredSteps %= ReducedStepRatio;
+
+    return steps;
+}
+
+template <size_t Width, size_t Height>
+bool
+wobbly::BasicModel <Width, Height>::Private::CatchUp (unsigned int steps)
+{
+    auto &positions (mPositions.PointArray ());
+    bool more = false;
+
+    /* Each integrator picks up from where the other left off */
+    mCatchUpIntegrator.Velocities () = mVelocityIntegrator.Velocities ();
+
+    /* Steps of equal length need only one factorization */
+    unsigned int const count = (steps + CatchUpStepLength - 1) / CatchUpStepLength;
+    double const length = static_cast <double> (steps) / count;
+
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        more |= mConstrainment (positions, mAnchors);
+        more |= mSpring.StepWith (mCatchUpIntegrator,
+                                  positions,
+                                  mAnchors,
+                                  length);
+    }
+
+    mSubSteps += count;
+
+    mVelocityIntegrator.Velocities () = mCatchUpIntegrator.Velocities ();
+
+    /* Implicit steps take momentum out of the mesh faster, so it
+     * may no longer settle where it was going to */
+    InvalidateCachedTarget ();
+
+    return more;
+}
+
+template <size_t Width, size_t Height>
+bool
+wobbly::BasicModel <Width, Height>::Private::StepAdaptively (unsigned int steps)
+{
+    if (!steps)
+        return false;
+
+    auto &positions (mPositions.PointArray ());
+    auto &velocities (mVelocityIntegrator.Velocities ());
+    bool more = false;
+
+    double const shortest = 1.0 / MaximumSubdivision;
+    double const stable = 0.8 * StableEulerStep (mSettings.springConstant,
+                                                 mSettings.friction,
+                                                 Mass);
+
+    /* Splitting steps any further would take longer than it is worth,
+     * so settle the mesh instead of letting it blow up */
+    if (stable < shortest)
+    {
+        SettleRigidly ();
+        mDiverged = true;
+        return false;
+    }
+
+    MeshArray const startPositions (positions);
+    MeshArray const startVelocities (velocities);
+    double const startEnergy = Energy ();
+
+    double remaining = steps;
+
+    while (remaining > 0.0)
+    {
+        more |= mConstrainment (positions, mAnchors);
+
+        auto const result (mSpring.CalculateForces ());
+        more |= result.forcesExist;
+
+        /* Only free points change velocity */
+        double fastest = 0.0, hardestPushed = 0.0;
+        mAnchors.PerformActions ([](size_t) {}, [&](size_t i) {
+            fastest = std::max (fastest,
+                                std::hypot (velocities[i * 2],
+                                            velocities[i * 2 + 1]));
+            hardestPushed = std::max (hardestPushed,
+                                      std::hypot (result.forces[i * 2],
+                                                  result.forces[i * 2 + 1]));
+        });
+
+        double const acceleration = hardestPushed / Mass;
+
+        /* Nearly at rest, where the implicit integrator can take long
+         * steps without noticeably damping anything */
+        if (mSpring.Mesh ().IsGrid () &&
+            remaining >= 2.0 &&
+            fastest < RestVelocity &&
+            acceleration < RestVelocity)
+        {
+            double const length = std::min (remaining,
+                                            static_cast <double> (CatchUpStepLength));
+
+            mCatchUpIntegrator.Velocities () = velocities;
+            more |= mSpring.IntegrateWith (mCatchUpIntegrator,
+                                           positions,
+                                           result.forces,
+                                           mAnchors,
+                                           length);
+            velocities = mCatchUpIntegrator.Velocities ();
+
+            remaining -= length;
+            ++mSubSteps;
+            continue;
+        }
+
+        /* Steps of differing lengths can pump energy into the mesh
+         * even where each would be stable on its own, so they are kept
+         * to powers of two, which stay in step with each other */
+        double length = 1.0;
+
+        while ((length > stable ||
+                acceleration * length > SubStepVelocityTolerance) &&
+               length > shortest)
+            length /= 2.0;
+
+        length = std::min (length, remaining);
+
+        more |= mSpring.IntegrateWith (mVelocityIntegrator,
+                                       positions,
+                                       result.forces,
+                                       mAnchors,
+                                       length);
+
+        remaining -= length;
+        ++mSubSteps;
+    }
+
+    /* Springs only take energy out of the mesh, and anchors moving it
+     * put in nowhere near this much, so anything more means that even
+     * the shortest steps were unstable. Also catches NaN. */
+    if (!(Energy () <= 1000.0 * (startEnergy + 1.0)))
+    {
+        positions = startPositions;
+        velocities = startVelocities;
+
+        SettleRigidly ();
+        mDiverged = true;
+        return false;
+    }
+
+    return more;
+}
+
+template <size_t Width, size_t Height>
+double
+wobbly::BasicModel <Width, Height>::Private::Energy () const
+{
+    auto const &velocities (mVelocityIntegrator.Velocities ());
+    double squaredSpeed = 0.0;
+
+    for (double component : velocities)
+        squaredSpeed += component * component;
+
+    /* Points move at half of their velocity, see EulerIntegrate */
+    return Mass * squaredSpeed / 4.0 +
+           mSpring.Mesh ().PotentialEnergy (mSettings.springConstant);
+}
+
+template <size_t Width, size_t Height>
+void
+wobbly::BasicModel <Width, Height>::Private::SettleRigidly ()
+{
+    auto &positions (mPositions.PointArray ());
+
+    MeshArray settled;
+    RestPositions (settled);
+    positions = settled;
+
+    mVelocityIntegrator.Velocities ().fill (0.0);
+    mCurrentlyUnequal = false;
+
+    mPrevious = positions;
+    Interpolate ();
+}
+
+template <size_t Width, size_t Height>
+void
+wobbly::BasicModel <Width, Height>::Private::RestPositions (MeshArray &rest) const
+{
+    /* With one anchor, the targets already follow it around */
+    bool const snapped =
+        mTargets.PerformIfActive ([&rest](MeshArray const &targets) {
+            rest = targets;
+            return true;
+        });
+
+    if (!snapped)
+        mSolver.Solve (mPositions.PointArray (),
+                       mVelocityIntegrator.Velocities (),
+                       mAnchors,
+                       TileSize (),
+                       mSettings.friction,
+                       Mass,
+                       1.0,
+                       rest);
+}
+
+template <size_t Width, size_t Height>
+double
+wobbly::BasicModel <Width, Height>::Private::EnergyAboveRest (MeshArray         const &rest,
+                                                              animation::Vector const &drift) const
+{
+    auto const &positions (mPositions.PointArray ());
+    auto const &velocities (mVelocityIntegrator.Velocities ());
+    auto const &springs (mSpring.Mesh ().BaseSprings ());
+
+    double const driftVelocity[2] = {
+        agd::get <0> (drift),
+        agd::get <1> (drift)
+    };
+
+    double squaredSpeed = 0.0;
+
+    for (size_t i = 0; i < Width * Height; ++i)
+        for (size_t d = 0; d < 2; ++d)
+            squaredSpeed += std::pow (velocities[i * 2 + d] - driftVelocity[d], 2);
+
+    /* Springs are linear and held points are already at rest, so the
+     * energy over rest is what the springs would store if stretched
+     * only by how far each point is from rest */
+    double squaredStretch = 0.0;
+
+    for (size_t s = 0; s < springs.Count (); ++s)
+    {
+        size_t const a = springs.first[s];
+        size_t const b = springs.second[s];
+
+        for (size_t d = 0; d < 2; ++d)
+            squaredStretch += std::pow ((positions[b * 2 + d] - rest[b * 2 + d]) -
+                                        (positions[a * 2 + d] - rest[a * 2 + d]),
+                                        2);
+    }
+
+    /* See Energy */
+    return Mass * squaredSpeed / 4.0 +
+           mSettings.springConstant * squaredStretch / 4.0;
+}
+
+template <size_t Width, size_t Height>
+double
+wobbly::BasicModel <Width, Height>::Private::StepsToSettle (double threshold) const
+{
+    MeshArray rest;
+    RestPositions (rest);
+
+    auto const &mask (mAnchors.AnchorMask ());
+    bool const free = std::all_of (mask.begin (), mask.end (),
+                                   [](uint64_t word) { return word == 0; });
+
+    /* Without anchors, the mesh as a whole drifts at its mean velocity */
+    animation::Vector drift (0, 0);
+
+    if (free)
+    {
+        auto const &velocities (mVelocityIntegrator.Velocities ());
+
+        for (size_t i = 0; i < Width * Height; ++i)
+            agd::pointwise_add (drift,
+                                PointView <double const> (velocities, i));
+
+        agd::scale (drift, 1.0 / (Width * Height));
+    }
+
+    double const deforming = SettleSteps (EnergyAboveRest (rest, drift),
+                                          mSettings.springConstant,
+                                          mSettings.friction,
+                                          Mass,
+                                          mSolver.SoftestMode (mAnchors),
+                                          threshold);
+
+    /* Friction slows the drift by friction / mass, and points only
+     * move by half of their velocity, so it has this far left to go */
+    double const speed = std::hypot (agd::get <0> (drift),
+                                     agd::get <1> (drift));
+    double const travel = speed * Mass / (2.0 * mSettings.friction);
+
+    if (!(travel > threshold))
+        return deforming;
+
+    return std::max (deforming,
+                     std::log (travel / threshold) * Mass / mSettings.friction);
+}
+
+template <size_t Width, size_t Height>
+void
+wobbly::BasicModel <Width, Height>::Private::Publish ()
+{
+    if (!mSnapshots)
+        return;
+
+    Frame &frame (mSnapshots->Back ());
+
+    frame.mesh.PointArray () = RenderedMesh ().PointArray ();
+    frame.surface = mSurface;
+    frame.sequence = ++mPublished;
+
+    mSnapshots->Publish ();
+}
+
+template <size_t Width, size_t Height>
+typename wobbly::BasicModel <Width, Height>::Private::BezierMesh const &
+wobbly::BasicModel <Width, Height>::Private::RenderedMesh () const
+{
+    return mInterpolating ? mRendered : mPositions;
+}
+
+template <size_t Width, size_t Height>
+double
+wobbly::BasicModel <Width, Height>::Private::InterpolationFactor () const
+{
+    return static_cast <double> (mAccumulated.count ()) /
+           std::chrono::nanoseconds (StepInterval).count ();
+}
+
+template <size_t Width, size_t Height>
+void
+wobbly::BasicModel <Width, Height>::Private::Interpolate ()
+{
+    if (!mInterpolating)
+        return;
+
+    double const factor = InterpolationFactor ();
+    auto const &current (mPositions.PointArray ());
+    auto &rendered (mRendered.PointArray ());
+
+    for (size_t i = 0; i < rendered.size (); ++i)
+        rendered[i] = mPrevious[i] + (current[i] - mPrevious[i]) * factor;
+}
+
+template <size_t Width, size_t Height>
+animation::Vector
+wobbly::BasicModel <Width, Height>::Private::TileSize () const
+{
+    return animation::Vector (mWidth / (Width - 1),
+                              mHeight / (Height - 1));
+}
+
+namespace
+{
+    template <typename SpringMesh>
+    class InsertedSprings
+    {
+        public:
+
+            typedef typename SpringMesh::AnchorDataVector ADV;
+
+            typedef wobbly::TemporaryOwner <wobbly::Spring> Stolen;
+            typedef wobbly::TemporaryOwner <wobbly::Spring::ID> Temporary;
+            typedef wobbly::TemporaryOwner <typename ADV::ID> Anchor;
+
+            InsertedSprings (Stolen                          &&stolen,
+                             Temporary                       &&first,
+                             Temporary                       &&second,
+                             wobbly::AllocatedArray <double> &&data,
+                             Anchor                          &&anchor) :
+                stolen (std::move (stolen)),
+                first (std::move (first)),
+                second (std::move (second)),
+                data (std::move (data)),
+                anchor (std::move (anchor))
+            {
+            }
 
             InsertedSprings (InsertedSprings &&package) noexcept (true):
                 stolen (std::move (package.stolen)),
@@ -742,16 +1786,18 @@ namespace
             Stolen stolen;
             Temporary first;
             Temporary second;
-            std::unique_ptr <double[]> data;
+            wobbly::AllocatedArray <double> data;
             Anchor anchor;
     };
 
+    template <typename MeshArray, typename TargetMesh, typename Spring>
     wobbly::Anchor
-    InsertPointStrategy (wobbly::TargetMesh::Hnd                       &&handle,
-                         animation::Point                        const &install,
-                         wobbly::MeshArray                       const &points,
-                         wobbly::TargetMesh                      const &targets,
-                         wobbly::SpringStep <wobbly::EulerIntegration> &spring)
+    InsertPointStrategy (wobbly::TargetMesh::Hnd       &&handle,
+                         animation::Point        const &install,
+                         MeshArray               const &points,
+                         TargetMesh              const &targets,
+                         Spring                        &spring,
+                         wobbly::Allocator             &allocator)
     {
         /* For the first activation, we prefer to use the target positions so
          * that the mesh can eventually settle even while grabbed. For
@@ -760,18 +1806,19 @@ namespace
          * such a case, just grab on the real positions */
         using namespace wobbly;
 
-        typedef PointView <double const> const & (Spring::*PosFetch) () const;
+        typedef typename Spring::SpringMesh SpringMesh;
+        typedef PointView <double const> const & (wobbly::Spring::*PosFetch) () const;
 
-        auto const getTarget = [&points, &targets](Spring const &spring,
-                                                   PosFetch fetch) {
-            return targets.PerformIfActive ([](MeshArray const &targets,
-                                               MeshArray const &points,
-                                               Spring    const &spring,
-                                               PosFetch        fetch) {
+        auto const getTarget = [&points, &targets](wobbly::Spring const &spring,
+                                                   PosFetch             fetch) {
+            return targets.PerformIfActive ([](MeshArray      const &targets,
+                                               MeshArray      const &points,
+                                               wobbly::Spring const &spring,
+                                               PosFetch             fetch) {
                 /* Lookup the index of each of the positions referenced in the
                  * spring and then fetch from the target array */
                 // cppcheck-suppress unreachableCode
-                for (size_t i = 0; i < config::TotalIndices; ++i)
+                for (size_t i = 0; i < points.size () / 2; ++i)
                 {
                     PointView <double const> position (points, i);
 
@@ -788,13 +1835,18 @@ namespace
         };
 
         using namespace std::placeholders;
+
+        /* The preferences only live until the springs are installed,
+         * so they refer to fetch rather than copying it. Along with
+         * getTarget that is small enough for std::function to store
+         * without an allocation */
         auto const wrap =
-            [&targets, &getTarget](PosFetch fetch) {
+            [&targets, &getTarget](PosFetch const &fetch) {
                 bool active = targets.PerformIfActive ([](MeshArray const &) {
                     return true;
                 });
 
-                typedef SpringMesh::PosPreference PP;
+                typedef typename SpringMesh::PosPreference PP;
 
                 /* If the target mesh is "active" (eg, there is one and only
                  * one grab on it, then we insert the anchor as having a
@@ -808,7 +1860,7 @@ namespace
                  * points on the mesh. The mesh will never settle while
                  * the grab is held, but that's fine because it wasn't going
                  * to settle anyways */
-                return active ? PP ([fetch, &getTarget](Spring const &spring) {
+                return active ? PP ([&fetch, &getTarget](wobbly::Spring const &spring) {
                                         // cppcheck-suppress unreachableCode
                                         auto args = getTarget (spring, fetch);
                                         typedef animation::PointView <double const>
@@ -816,40 +1868,46 @@ namespace
                                         return CDPV (std::get <0> (args),
                                                      std::get <1> (args));
                                     }) :
-                                PP ([fetch](Spring const &spring) {
+                                PP ([fetch](wobbly::Spring const &spring) {
                                         return (spring.*fetch) ();
                                     });
             };
 
-        SpringMesh::PosPreference firstPref (wrap (&Spring::FirstPosition));
-        SpringMesh::PosPreference secondPref (wrap (&Spring::SecondPosition));
+        PosFetch const firstFetch (&wobbly::Spring::FirstPosition);
+        PosFetch const secondFetch (&wobbly::Spring::SecondPosition);
+
+        typename SpringMesh::PosPreference firstPref (wrap (firstFetch));
+        typename SpringMesh::PosPreference secondPref (wrap (secondFetch));
 
         auto result (spring.InstallAnchorSprings (install,
                                                   firstPref,
                                                   secondPref));
 
-        typedef InsertedSprings IS;
+        typedef InsertedSprings <SpringMesh> IS;
 
         /* XXX: There does not appear to be any freely-available
          * header-only libraries which permit functional
          * type apply () of the arguments of an std::tuple to
          * a function or constructor */
-        using Impl = wobbly::Anchor::Impl;
-        Impl impl (new ConstrainingAnchor <IS> (std::move (handle),
-                                                std::move (result.stolen),
-                                                std::move (result.first),
-                                                std::move (result.second),
-                                                std::move (result.data),
-                                                std::move (result.anchor)));
+        typedef ConstrainingAnchor <IS> CA;
+
+        auto impl (AllocateAnchor <CA> (allocator,
+                                        std::move (handle),
+                                        std::move (result.stolen),
+                                        std::move (result.first),
+                                        std::move (result.second),
+                                        std::move (result.data),
+                                        std::move (result.anchor)));
         return wobbly::Anchor::Create (std::move (impl));
     }
 
+    template <typename AnchorArray>
     class GrabAnchor
     {
         public:
 
             GrabAnchor (animation::PointView <double> &&position,
-                        wobbly::AnchorArray           &array,
+                        AnchorArray                   &array,
                         size_t                        index) :
                 position (std::move (position)),
                 array (array),
@@ -874,30 +1932,33 @@ namespace
             GrabAnchor & operator= (GrabAnchor const &) = delete;
 
             animation::PointView <double> position;
-            wobbly::AnchorArray           &array;
+            AnchorArray                   &array;
             size_t                        index;
     };
 
+    template <typename AnchorArray>
     wobbly::Anchor
     GrabAnchorStrategy (wobbly::TargetMesh::Hnd       &&handle,
                         animation::PointView <double> &&point,
-                        wobbly::AnchorArray           &anchors,
-                        size_t                        index)
+                        AnchorArray                   &anchors,
+                        size_t                        index,
+                        wobbly::Allocator             &allocator)
     {
-        typedef GrabAnchor GA;
+        typedef wobbly::ConstrainingAnchor <GrabAnchor <AnchorArray>> CA;
 
-        using Impl = wobbly::Anchor::Impl;
-        Impl impl (new wobbly::ConstrainingAnchor <GA> (std::move (handle),
-                                                        std::move (point),
-                                                        anchors,
-                                                        index));
+        auto impl (wobbly::AllocateAnchor <CA> (allocator,
+                                                std::move (handle),
+                                                std::move (point),
+                                                anchors,
+                                                index));
 
         return wobbly::Anchor::Create (std::move (impl));
     }
 }
 
+template <size_t Width, size_t Height>
 wobbly::Anchor
-wobbly::Model::GrabAnchor (Point const &position) noexcept (false)
+wobbly::BasicModel <Width, Height>::GrabAnchor (Point const &position) noexcept (false)
 {
     auto &points = priv->mPositions.PointArray ();
     size_t index = mesh::ClosestIndexToPosition (points, position);
@@ -905,41 +1966,73 @@ wobbly::Model::GrabAnchor (Point const &position) noexcept (false)
     /* Bets are off once we've grabbed an anchor, the model is now unequal */
     priv->mCurrentlyUnequal = true;
 
-    /* Activate the TargetMesh member for this anchor */
+    /* Activate the TargetMesh member for this anchor. The anchor can
+     * move the mesh, so the cached target will no longer apply */
     auto activation (priv->mTargets.Activate ());
+    priv->InvalidateCachedTarget ();
+    priv->Activated ();
 
     return Anchor (GrabAnchorStrategy (std::move (activation),
                                        animation::PointView <double> (points,
                                                                       index),
                                        priv->mAnchors,
-                                       index));
+                                       index,
+                                       priv->mAllocator));
 }
 
+template <size_t Width, size_t Height>
 wobbly::Anchor
-wobbly::Model::InsertAnchor (Point const &position) noexcept (false)
+wobbly::BasicModel <Width, Height>::InsertAnchor (Point const &position) noexcept (false)
 {
     auto &points = priv->mPositions.PointArray ();
 
     /* Bets are off once we've inserted an anchor, the model is now unequal */
     priv->mCurrentlyUnequal = true;
 
-    /* Activate the TargetMesh member for this anchor */
+    /* Activate the TargetMesh member for this anchor. The anchor can
+     * move the mesh, so the cached target will no longer apply */
     auto activation (priv->mTargets.Activate ());
+    priv->InvalidateCachedTarget ();
+    priv->Activated ();
 
     return Anchor (InsertPointStrategy (std::move (activation),
                                         position,
                                         points,
                                         priv->mTargets,
-                                        priv->mSpring));
+                                        priv->mSpring,
+                                        priv->mAllocator));
+}
+
+template <size_t Width, size_t Height>
+wobbly::Anchor
+wobbly::BasicModel <Width, Height>::GrabQueuedAnchor (Point const &position) noexcept (false)
+{
+    auto impl (AllocateAnchor <QueuedAnchor> (priv->mAllocator,
+                                              GrabAnchor (position),
+                                              priv->mQueuedAnchors));
+
+    return Anchor::Create (std::move (impl));
+}
+
+template <size_t Width, size_t Height>
+wobbly::Anchor
+wobbly::BasicModel <Width, Height>::InsertQueuedAnchor (Point const &position) noexcept (false)
+{
+    auto impl (AllocateAnchor <QueuedAnchor> (priv->mAllocator,
+                                              InsertAnchor (position),
+                                              priv->mQueuedAnchors));
+
+    return Anchor::Create (std::move (impl));
 }
 
+template <size_t Width, size_t Height>
 void
-wobbly::Model::MoveModelBy (Point const &delta)
+wobbly::BasicModel <Width, Height>::MoveModelBy (Point const &delta)
 {
     auto &points (priv->mPositions.PointArray ());
     auto &estimated (priv->mTargets.PointArray ());
 
-    for (size_t i = 0; i < config::TotalIndices; ++i)
+    for (size_t i = 0; i < Width * Height; ++i)
     {
         PointView <double> pointView (points, i);
         PointView <double> targetView (estimated, i);
@@ -949,10 +2042,28 @@ wobbly::Model::MoveModelBy (Point const &delta)
 
     /* Also move any inserted springs */
     priv->mSpring.MoveInsertedAnchorsBy (delta);
+
+    /* The whole mesh moved, so it will settle by the same amount
+     * further on */
+    if (priv->mCachedTarget)
+        agd::pointwise_add (*priv->mCachedTarget, delta);
+
+    /* As did the mesh before the last step, so that the blend moves
+     * with it */
+    for (size_t i = 0; i < Width * Height; ++i)
+    {
+        PointView <double> previousView (priv->mPrevious, i);
+        agd::pointwise_add (previousView, delta);
+    }
+
+    priv->Interpolate ();
+
+    priv->Activated ();
 }
 
+template <size_t Width, size_t Height>
 void
-wobbly::Model::MoveModelTo (Point const &point)
+wobbly::BasicModel <Width, Height>::MoveModelTo (Point const &point)
 {
     /* We need to calculate the target position for the
      * top left corner. If we do that, then moving the model
@@ -967,8 +2078,9 @@ wobbly::Model::MoveModelTo (Point const &point)
     MoveModelBy (delta);
 }
 
+template <size_t Width, size_t Height>
 void
-wobbly::Model::ResizeModel (double width, double height)
+wobbly::BasicModel <Width, Height>::ResizeModel (double width, double height)
 {
     /* First, zero or negative widths are invalid */
     assert (width > 0.0f);
@@ -1001,11 +2113,13 @@ wobbly::Model::ResizeModel (double width, double height)
             agd::pointwise_add (p, origin);
         };
 
-    /* Rescale all points and targets */
-    for (size_t i = 0; i < config::TotalIndices; ++i)
+    /* Rescale all points and targets, along with the mesh before the
+     * last step for interpolation */
+    for (size_t i = 0; i < Width * Height; ++i)
     {
         rescale (positionsOrigin, PointView <double> (points, i));
         rescale (targetsOrigin, PointView <double> (targets, i));
+        rescale (positionsOrigin, PointView <double> (priv->mPrevious, i));
     }
 
     /* On each spring, apply the scale factor */
@@ -1014,18 +2128,24 @@ wobbly::Model::ResizeModel (double width, double height)
     /* Apply width and height changes */
     priv->mWidth = width;
     priv->mHeight = height;
+
+    priv->Interpolate ();
+    priv->InvalidateCachedTarget ();
+    priv->Activated ();
 }
 
-wobbly::ConstrainmentStep::ConstrainmentStep (double     const &threshold,
-                                              TargetMesh const &targets) :
+template <size_t Width, size_t Height>
+wobbly::BasicConstrainmentStep <Width, Height>::BasicConstrainmentStep (double     const &threshold,
+                                                                        TargetMesh const &targets) :
     threshold (threshold),
     targets (targets)
 {
 }
 
+template <size_t Width, size_t Height>
 bool
-wobbly::ConstrainmentStep::operator () (MeshArray         &points,
-                                        AnchorArray const &anchors)
+wobbly::BasicConstrainmentStep <Width, Height>::operator () (MeshArray         &points,
+                                                             AnchorArray const &anchors)
 {
     /* If an anchor is grabbed, then the model will be considered constrained.
      * The first anchor taking priority - we work out the allowable range for
@@ -1033,68 +2153,158 @@ wobbly::ConstrainmentStep::operator () (MeshArray         &points,
      * starting to integrate the model
      */
     return targets.PerformIfActive ([this, &points](MeshArray const &targets) {
-        // cppcheck-suppress unreachableCode
-        bool ret = false;
+        return ConstrainRange (points, targets, 0, Width * Height);
+    });
+}
 
-        for (size_t i = 0; i < config::TotalIndices; ++i)
-        {
-            animation::PointView <double const> target (targets, i);
-            /* In each position in the main position array we'll work out the
-             * pythagorean delta between the ideal positon and current one.
-             * If it is outside the maximum range, then we'll shrink the delta
-             * and reapply it */
-            double const maximumRange = threshold;
+template <size_t Width, size_t Height>
+typename wobbly::BasicConstrainmentStep <Width, Height>::MeshArray const *
+wobbly::BasicConstrainmentStep <Width, Height>::ActiveTargets () const
+{
+    return targets.PerformIfActive ([](MeshArray const &targets) {
+        return &targets;
+    });
+}
 
-            animation::PointView <double> point (points, i);
-            double range = agd::distance (target, point);
+template <size_t Width, size_t Height>
+bool
+wobbly::BasicConstrainmentStep <Width, Height>::ConstrainRange (MeshArray       &points,
+                                                                MeshArray const &targets,
+                                                                size_t          begin,
+                                                                size_t          end) const
+{
+    bool ret = false;
 
-            if (range < maximumRange)
-                continue;
+    for (size_t i = begin; i < end; ++i)
+    {
+        animation::PointView <double const> target (targets, i);
+        /* In each position in the main position array we'll work out the
+         * pythagorean delta between the ideal positon and current one.
+         * If it is outside the maximum range, then we'll shrink the delta
+         * and reapply it */
+        double const maximumRange = threshold;
 
-            ret |= true;
+        animation::PointView <double> point (points, i);
+        double range = agd::distance (target, point);
 
-            auto sin = (agd::get <1> (target) - agd::get <1> (point)) / range;
-            auto cos = (agd::get <0> (target) - agd::get <0> (point)) / range;
+        if (range < maximumRange)
+            continue;
 
-            /* Now we want to vectorize range and
-             * find our new x and y offsets */
-            double const newRange = std::min (maximumRange, range);
-            animation::Point newDelta (newRange * cos,
-                                       newRange * sin);
+        ret |= true;
 
-            /* Offset from the "target" position */
-            agd::assign (point, target);
-            agd::pointwise_subtract (point, newDelta);
-        }
+        auto sin = (agd::get <1> (target) - agd::get <1> (point)) / range;
+        auto cos = (agd::get <0> (target) - agd::get <0> (point)) / range;
 
-        return ret;
-    });
-}
+        /* Now we want to vectorize range and
+         * find our new x and y offsets */
+        double const newRange = std::min (maximumRange, range);
+        animation::Point newDelta (newRange * cos,
+                                   newRange * sin);
 
-wobbly::EulerIntegration::EulerIntegration ()
-{
-    velocities.fill (0.0);
+        /* Offset from the "target" position */
+        agd::assign (point, target);
+        agd::pointwise_subtract (point, newDelta);
+    }
+
+    return ret;
 }
 
+template <size_t Width, size_t Height>
 bool
-wobbly::Model::Step (unsigned int time)
+wobbly::BasicModel <Width, Height>::Step (unsigned int time)
 {
-    bool moreStepsRequired = priv->mCurrentlyUnequal;
+    priv->ApplyQueuedMotion ();
+
+    priv->mSubSteps = 0;
+    priv->mDiverged = false;
+    priv->mSleptPoints = 0;
+    priv->mSleptSprings = 0;
+
+    if (priv->mDetail == Detail::Rigid)
+    {
+        /* Only anchors can have moved the mesh since the last step */
+        if (priv->mTargets.Held ())
+        {
+            priv->SettleRigidly ();
+            priv->InvalidateCachedTarget ();
+        }
 
-    double const FPStepResolution = 16.0f;
-    unsigned int steps =
-        static_cast <unsigned int> (std::ceil (time / FPStepResolution));
+        priv->Publish ();
+        return false;
+    }
+
+    bool moreStepsRequired = priv->mCurrentlyUnequal;
+    unsigned int steps = priv->StepsAtDetail (StepsForTime (time));
 
     /* We might not need more steps - set to false initially and then
      * integrate the model to see if we do */
-    if (time)
+    if (steps)
         moreStepsRequired = false;
 
-    moreStepsRequired |= Integrate (priv->mPositions.PointArray (),
-                                    priv->mAnchors,
-                                    steps,
-                                    priv->mConstrainment,
-                                    priv->mSpring);
+    /* Constrainment, forces and integration are all done in one sweep
+     * over the mesh per step, see SpringStep */
+    typedef typename Private::MeshArray MeshArray;
+    typedef typename Private::AnchorArray AnchorArray;
+
+    auto const fusedStep = [this](MeshArray         &positions,
+                                  AnchorArray const &anchors) {
+        bool const more = priv->mSpring (positions,
+                                         anchors,
+                                         priv->mConstrainment);
+
+        priv->mSleptPoints += priv->mSpring.SleptPoints ();
+        priv->mSleptSprings += priv->mSpring.SleptSprings ();
+
+        return more;
+    };
+
+    /* When interpolating, the mesh is kept as it was before the last
+     * step, to blend from */
+    unsigned int const last = priv->mInterpolating && steps ? 1 : 0;
+    auto &positions (priv->mPositions.PointArray ());
+
+    /* Long gaps are caught up on implicitly, unless anchors are
+     * inserted, since their springs would still be stepped explicitly */
+    unsigned int explicitSteps = steps - last;
+
+    if (explicitSteps > CatchUpSteps && priv->mSpring.Mesh ().IsGrid ())
+    {
+        moreStepsRequired |= priv->CatchUp (explicitSteps);
+        explicitSteps = 0;
+    }
+
+    if (priv->mAdaptive)
+    {
+        moreStepsRequired |= priv->StepAdaptively (explicitSteps);
+
+        if (last && !priv->mDiverged)
+        {
+            priv->mPrevious = positions;
+            moreStepsRequired |= priv->StepAdaptively (last);
+        }
+    }
+    else
+    {
+        moreStepsRequired |= Integrate (positions,
+                                        priv->mAnchors,
+                                        explicitSteps,
+                                        fusedStep);
+        priv->mSubSteps += explicitSteps;
+
+        if (last)
+        {
+            priv->mPrevious = positions;
+            moreStepsRequired |= Integrate (positions,
+                                            priv->mAnchors,
+                                            last,
+                                            fusedStep);
+            priv->mSubSteps += last;
+        }
+    }
+
+    /* Anchors move the mesh as it is integrated */
+    if (priv->mTargets.Held ())
+        priv->InvalidateCachedTarget ();
 
     priv->mCurrentlyUnequal = moreStepsRequired;
 
@@ -1102,53 +2312,305 @@ wobbly::Model::Step (unsigned int time)
      * point where the cursor is, this ensures exact positioning */
     if (!priv->mCurrentlyUnequal)
     {
-        auto       &positions (priv->mPositions.PointArray ());
-
         priv->mTargets.PerformIfActive ([&positions](MeshArray const &targets) {
             std::copy (targets.begin (), targets.end (), positions.begin ());
         });
+
+        /* Nothing is moving any more, so nothing is left to blend */
+        priv->mPrevious = positions;
     }
 
+    priv->Interpolate ();
+    priv->Publish ();
+
     return priv->mCurrentlyUnequal;
 }
 
-animation::Point
-wobbly::Model::DeformTexcoords (Point const &normalized) const
+template <size_t Width, size_t Height>
+bool
+wobbly::BasicModel <Width, Height>::Advance (std::chrono::nanoseconds delta)
 {
-    return priv->mPositions.DeformUnitCoordsToMeshSpace (normalized);
+    /* Going back in time would leave mAccumulated negative, and the
+     * steps below would wrap around to billions of milliseconds */
+    priv->mAccumulated += std::max (delta, std::chrono::nanoseconds (0));
+
+    auto const steps = priv->mAccumulated / StepInterval;
+    priv->mAccumulated -= steps * StepInterval;
+
+    if (!steps)
+    {
+        priv->Interpolate ();
+        priv->Publish ();
+
+        return priv->mCurrentlyUnequal;
+    }
+
+    auto const time = std::chrono::milliseconds (StepInterval * steps);
+    return Step (static_cast <unsigned int> (time.count ()));
 }
 
-std::array <animation::Point, 4> const
-wobbly::Model::Extremes () const
+template <size_t Width, size_t Height>
+bool
+wobbly::BasicModel <Width, Height>::AdvanceTo (std::chrono::nanoseconds timestamp)
 {
-    return priv->mPositions.Extremes ();
+    /* Time never goes backwards on a steady clock, but a new one
+     * may have been swapped in */
+    auto delta = std::chrono::nanoseconds (0);
+
+    if (priv->mLastTimestamp && timestamp > *priv->mLastTimestamp)
+        delta = timestamp - *priv->mLastTimestamp;
+
+    priv->mLastTimestamp = timestamp;
+
+    return Advance (delta);
 }
 
-wobbly::TargetMesh::TargetMesh (OriginRecalcStrategy const &origin) :
-    activationCount (0),
-    origin (origin)
+template <size_t Width, size_t Height>
+void
+wobbly::BasicModel <Width, Height>::SetInterpolation (bool interpolate)
 {
-    mPoints.fill (0);
+    if (interpolate == priv->mInterpolating)
+        return;
+
+    priv->mInterpolating = interpolate;
+    priv->mPrevious = priv->mPositions.PointArray ();
+    priv->Interpolate ();
 }
 
-wobbly::TargetMesh::Hnd
-wobbly::TargetMesh::Activate () noexcept (true)
+template <size_t Width, size_t Height>
+double
+wobbly::BasicModel <Width, Height>::InterpolationFactor () const
 {
-    /* Recompute where all the targets would be if we have
-     * a single anchor. */
-    if (++activationCount == 1)
-        origin (mPoints);
+    return priv->InterpolationFactor ();
+}
 
-    Move moveBy = [this](Vector const &delta) {
-        if (Active ())
-        {
-            for (size_t i = 0; i < config::TotalIndices; ++i)
-            {
-                PointView <double> pv (mPoints, i);
-                agd::pointwise_add (pv, delta);
-            }
-        }
-    };
+template <size_t Width, size_t Height>
+void
+wobbly::BasicModel <Width, Height>::SetAdaptiveStepping (bool adaptive)
+{
+    priv->mAdaptive = adaptive;
+}
+
+template <size_t Width, size_t Height>
+unsigned int
+wobbly::BasicModel <Width, Height>::SubSteps () const
+{
+    return priv->mSubSteps;
+}
+
+template <size_t Width, size_t Height>
+bool
+wobbly::BasicModel <Width, Height>::Diverged () const
+{
+    return priv->mDiverged;
+}
+
+template <size_t Width, size_t Height>
+size_t
+wobbly::BasicModel <Width, Height>::SleepingPoints () const
+{
+    return priv->mSleptPoints;
+}
+
+template <size_t Width, size_t Height>
+size_t
+wobbly::BasicModel <Width, Height>::SleepingSprings () const
+{
+    return priv->mSleptSprings;
+}
+
+template <size_t Width, size_t Height>
+std::chrono::milliseconds
+wobbly::BasicModel <Width, Height>::SettleTime (double threshold) const
+{
+    typedef std::chrono::milliseconds Milliseconds;
+
+    if (!priv->mCurrentlyUnequal || priv->mDetail == Detail::Rigid)
+        return Milliseconds (0);
+
+    if (!(priv->mSettings.friction > 0.0))
+        return Milliseconds::max ();
+
+    double steps = priv->StepsToSettle (threshold);
+
+    /* Reduced detail only integrates once every few steps */
+    if (priv->mDetail == Detail::Reduced)
+        steps *= ReducedStepRatio;
+
+    double const time = std::ceil (steps) * StepInterval.count ();
+
+    if (!(time < static_cast <double> (Milliseconds::max ().count ())))
+        return Milliseconds::max ();
+
+    return Milliseconds (static_cast <Milliseconds::rep> (time));
+}
+
+namespace
+{
+    /* Deformation shared by models and their snapshots */
+    template <size_t Width, size_t Height>
+    animation::Point
+    DeformTexcoordsOn (wobbly::BasicBezierMesh <Width, Height> const &mesh,
+                       wobbly::ModelBase::Surface                   surface,
+                       animation::Point                       const &normalized)
+    {
+        if (surface == wobbly::ModelBase::Surface::PiecewiseBicubic)
+            return mesh.DeformUnitCoordsPiecewise (normalized);
+
+        return mesh.DeformUnitCoordsToMeshSpace (normalized);
+    }
+
+    template <size_t Width, size_t Height>
+    void
+    DeformGridOn (wobbly::BasicBezierMesh <Width, Height> const &mesh,
+                  wobbly::ModelBase::Surface                   surface,
+                  size_t                                       uSteps,
+                  size_t                                       vSteps,
+                  double                                       *vertices)
+    {
+        if (surface == wobbly::ModelBase::Surface::PiecewiseBicubic)
+            mesh.DeformGridPiecewise (uSteps, vSteps, vertices);
+        else
+            mesh.DeformGrid (uSteps, vSteps, vertices);
+    }
+}
+
+template <size_t Width, size_t Height>
+animation::Point
+wobbly::BasicModel <Width, Height>::DeformTexcoords (Point const &normalized) const
+{
+    return DeformTexcoordsOn (priv->RenderedMesh (), priv->mSurface, normalized);
+}
+
+template <size_t Width, size_t Height>
+void
+wobbly::BasicModel <Width, Height>::DeformGrid (size_t uSteps,
+                                                size_t vSteps,
+                                                double *vertices) const
+{
+    DeformGridOn (priv->RenderedMesh (),
+                  priv->mSurface,
+                  uSteps,
+                  vSteps,
+                  vertices);
+}
+
+template <size_t Width, size_t Height>
+void
+wobbly::BasicModel <Width, Height>::SetSurface (Surface surface)
+{
+    priv->mSurface = surface;
+}
+
+template <size_t Width, size_t Height>
+void
+wobbly::BasicModel <Width, Height>::SetDetail (Detail detail)
+{
+    if (detail == priv->mDetail)
+        return;
+
+    priv->mDetail = detail;
+    priv->mDeferredSteps = 0;
+
+    if (detail == Detail::Rigid)
+    {
+        priv->SettleRigidly ();
+        priv->Publish ();
+    }
+}
+
+template <size_t Width, size_t Height>
+std::array <animation::Point, 4> const
+wobbly::BasicModel <Width, Height>::Extremes () const
+{
+    return priv->RenderedMesh ().Extremes ();
+}
+
+template <size_t Width, size_t Height>
+void
+wobbly::BasicModel <Width, Height>::PublishSnapshots ()
+{
+    typedef typename Private::Frame Frame;
+
+    if (priv->mSnapshots)
+        return;
+
+    Frame const initial { priv->RenderedMesh (), priv->mSurface, 0 };
+    priv->mSnapshots.reset (new TripleBuffer <Frame> (initial));
+}
+
+template <size_t Width, size_t Height>
+typename wobbly::BasicModel <Width, Height>::Snapshot
+wobbly::BasicModel <Width, Height>::LatestSnapshot ()
+{
+    assert (priv->mSnapshots);
+
+    return Snapshot (priv->mSnapshots->Front ());
+}
+
+template <size_t Width, size_t Height>
+wobbly::BasicModel <Width, Height>::Snapshot::Snapshot (Frame const &frame) :
+    frame (&frame)
+{
+}
+
+template <size_t Width, size_t Height>
+animation::Point
+wobbly::BasicModel <Width, Height>::Snapshot::DeformTexcoords (Point const &normalized) const
+{
+    return DeformTexcoordsOn (frame->mesh, frame->surface, normalized);
+}
+
+template <size_t Width, size_t Height>
+void
+wobbly::BasicModel <Width, Height>::Snapshot::DeformGrid (size_t uSteps,
+                                                          size_t vSteps,
+                                                          double *vertices) const
+{
+    DeformGridOn (frame->mesh, frame->surface, uSteps, vSteps, vertices);
+}
+
+template <size_t Width, size_t Height>
+std::array <animation::Point, 4> const
+wobbly::BasicModel <Width, Height>::Snapshot::Extremes () const
+{
+    return frame->mesh.Extremes ();
+}
+
+template <size_t Width, size_t Height>
+unsigned long long
+wobbly::BasicModel <Width, Height>::Snapshot::Sequence () const
+{
+    return frame->sequence;
+}
+
+template <size_t Width, size_t Height>
+wobbly::BasicTargetMesh <Width, Height>::BasicTargetMesh (OriginRecalcStrategy const &origin) :
+    activationCount (0),
+    origin (origin)
+{
+    mPoints.fill (0);
+}
+
+template <size_t Width, size_t Height>
+typename wobbly::BasicTargetMesh <Width, Height>::Hnd
+wobbly::BasicTargetMesh <Width, Height>::Activate () noexcept (true)
+{
+    /* Recompute where all the targets would be if we have
+     * a single anchor. */
+    if (++activationCount == 1)
+        origin (mPoints);
+
+    Move moveBy = [this](Vector const &delta) {
+        if (Active ())
+        {
+            for (size_t i = 0; i < Width * Height; ++i)
+            {
+                PointView <double> pv (mPoints, i);
+                agd::pointwise_add (pv, delta);
+            }
+        }
+    };
 
     return Hnd (MakeMoveOnly (std::move (moveBy)),
                 [this](MoveOnly <Move> &&handle) {
@@ -1160,12 +2622,546 @@ wobbly::TargetMesh::Activate () noexcept (true)
                 });
 }
 
-wobbly::BezierMesh::BezierMesh ()
+namespace wobbly
+{
+    template <size_t Width, size_t Height>
+    class BasicModelPool <Width, Height>::Private
+    {
+        public:
+
+            typedef typename Model::Private ModelPrivate;
+
+            /* Models are allocated a slab at a time. Nothing in a slab is
+             * ever moved, since anchors and springs refer directly into
+             * the arrays of each model. */
+            static constexpr size_t SlabSize = 32;
+
+            template <typename T>
+            using Storage = typename std::aligned_storage <sizeof (T),
+                                                           alignof (T)>::type;
+
+            struct Slab
+            {
+                /* Kept apart from the handles. Only the state a
+                 * step touches is inline in each ModelPrivate, so
+                 * the meshes of neighbouring models are a few
+                 * kilobytes apart rather than separated by their
+                 * solver factors and interpolation buffers */
+                Storage <ModelPrivate> state[SlabSize];
+                Storage <Model>        models[SlabSize];
+                bool                   live[SlabSize];
+            };
+
+            Model & ModelAt (size_t slot)
+            {
+                Slab &slab (*mSlabs[slot / SlabSize]);
+                return *reinterpret_cast <Model *> (&slab.models[slot % SlabSize]);
+            }
+
+            bool Live (size_t slot) const
+            {
+                return mSlabs[slot / SlabSize]->live[slot % SlabSize];
+            }
+
+            size_t SlotOf (Model const &model) const
+            {
+                for (size_t i = 0; i < mSlabs.size (); ++i)
+                {
+                    auto const *models = mSlabs[i]->models;
+                    auto const *address =
+                        reinterpret_cast <Storage <Model> const *> (&model);
+
+                    if (address >= models && address < models + SlabSize)
+                        return i * SlabSize + (address - models);
+                }
+
+                throw std::logic_error ("Model does not belong to this pool");
+            }
+
+            /* Active models are handed to threads this many at a time */
+            static constexpr size_t ChunkSize = 8;
+
+            size_t Slots () const
+            {
+                return mSlabs.size () * SlabSize;
+            }
+
+            typedef typename ModelPrivate::Lanes Lanes;
+
+            explicit Private (Allocator &allocator) :
+                mAllocator (allocator),
+                mTopology (GridSprings ())
+            {
+            }
+
+            Private () :
+                Private (mRecycler)
+            {
+            }
+
+            /* The springs of any mesh of this size that nothing has been
+             * inserted into */
+            static typename LaneTopology <Width, Height>::IndexedSprings
+            GridSprings ()
+            {
+                BasicMeshArray <Width, Height> positions;
+                BasicSpringMesh <Width, Height> mesh (positions,
+                                                      animation::Vector (1, 1));
+                return mesh.BaseSprings ();
+            }
+
+            /* Starts stepping the model in slot again, if it is not
+             * being stepped already */
+            void Activate (size_t slot)
+            {
+                if (mIsActive[slot])
+                    return;
+
+                mIsActive[slot] = true;
+                mActive.push_back (slot);
+            }
+
+            void Deactivate (size_t slot)
+            {
+                if (!mIsActive[slot])
+                    return;
+
+                mIsActive[slot] = false;
+                mActive.erase (std::find (mActive.begin (), mActive.end (), slot));
+            }
+
+            /* Puts the active models back in storage order, which they
+             * are stepped in. Models are mostly already in order from
+             * the last StepAll, so this is cheap. */
+            void SortActive ()
+            {
+                std::sort (mActive.begin (), mActive.end ());
+                mStepped.resize (mActive.size ());
+            }
+
+            /* Steps the active models from mActive[begin] up to
+             * mActive[end], noting which of them still need more steps
+             * in mStepped */
+            void StepActive (size_t begin, size_t end, unsigned int time)
+            {
+                StepEach (end - begin,
+                          [begin](size_t n) { return begin + n; },
+                          time);
+            }
+
+            /* Steps count active models, the nth being mActive[index (n)].
+             *
+             * Models which can be are gathered into batches of lanes and
+             * stepped together, the rest are stepped on their own. */
+            template <typename Index>
+            void StepEach (size_t count, Index const &index, unsigned int time)
+            {
+                Lanes lanes (mTopology);
+                size_t laneIndices[Lanes::Lanes];
+                unsigned int const steps = StepsForTime (time);
+
+                auto const flush = [&]() {
+                    unsigned int const more = lanes.Step (steps, Mass);
+
+                    for (size_t lane = 0; lane < lanes.Size (); ++lane)
+                    {
+                        size_t const i = laneIndices[lane];
+                        bool const laneMore = (more >> lane) & 1;
+
+                        ModelPrivate &priv (*ModelAt (mActive[i]).priv);
+
+                        priv.StoreLane (lanes, lane, laneMore);
+                        priv.mSubSteps = steps;
+                        priv.mDiverged = false;
+                        priv.mSleptPoints = 0;
+                        priv.mSleptSprings = 0;
+                        mStepped[i] = laneMore;
+                    }
+
+                    lanes.Clear ();
+                };
+
+                for (size_t n = 0; n < count; ++n)
+                {
+                    size_t const i = index (n);
+                    Model &model (ModelAt (mActive[i]));
+
+                    /* Held models may still be stepped in lanes, so
+                     * anchors need to be moved before loading them */
+                    model.priv->ApplyQueuedMotion ();
+
+                    /* Step does nothing without time to step, and
+                     * catches up on long gaps itself */
+                    if (!steps ||
+                        steps > CatchUpSteps ||
+                        !model.priv->SteppableInLanes ())
+                    {
+                        mStepped[i] = model.Step (time);
+                        continue;
+                    }
+
+                    laneIndices[model.priv->LoadLane (lanes)] = i;
+
+                    if (lanes.Full ())
+                        flush ();
+                }
+
+                if (lanes.Size ())
+                    flush ();
+            }
+
+            /* Models which StepAllWithin always steps */
+            bool Urgent (size_t slot)
+            {
+                return mPriorities[slot].focused ||
+                       ModelAt (slot).priv->mTargets.Held ();
+            }
+
+            /* Order of the rest in StepAllWithin, which grows each time
+             * a model misses out, even those with nothing on screen */
+            double Weight (size_t slot) const
+            {
+                return (mPriorities[slot].visibleArea + 1.0) *
+                       (mMissed[slot] + 1.0);
+            }
+
+            /* Gathers the models still animating after StepActive, in
+             * storage order no matter which thread stepped them.
+             *
+             * Models which have settled leave the active set, unless
+             * something still holds them, since moving an anchor does
+             * not go through the model. */
+            std::vector <Model *> const & CollectAnimating ()
+            {
+                size_t kept = 0;
+
+                mAnimating.clear ();
+
+                for (size_t i = 0; i < mActive.size (); ++i)
+                {
+                    size_t const slot = mActive[i];
+                    Model &model (ModelAt (slot));
+
+                    if (mStepped[i])
+                        mAnimating.push_back (&model);
+                    else if (!model.priv->mTargets.Held ())
+                    {
+                        mIsActive[slot] = false;
+                        continue;
+                    }
+
+                    mActive[kept++] = slot;
+                }
+
+                mActive.resize (kept);
+
+                return mAnimating;
+            }
+
+            std::vector <std::unique_ptr <Slab>> mSlabs;
+
+            /* Unused slots, lowest last so that models fill the earliest
+             * slabs first */
+            std::vector <size_t> mFree;
+
+            size_t mSize = 0;
+
+            /* Where the springs and anchors of each model come from,
+             * which is mRecycler unless the pool was given an allocator */
+            RecyclingAllocator mRecycler;
+            Allocator          &mAllocator;
+
+            /* Slots of the models which are stepped by StepAll, which
+             * models join when they are grabbed, moved or resized and
+             * leave once they have settled. mIsActive is indexed by
+             * slot. */
+            std::vector <size_t>        mActive;
+            std::vector <unsigned char> mIsActive;
+
+            /* Whether each model in mActive still needs steps after the
+             * last StepAll. Not a vector <bool>, since each thread writes
+             * to its own models */
+            std::vector <unsigned char> mStepped;
+
+            LaneTopology <Width, Height> const mTopology;
+
+            /* By slot, see StepAllWithin */
+            std::vector <Priority>     mPriorities;
+            std::vector <unsigned int> mMissed;
+
+            /* Indices into mActive in order of priority */
+            std::vector <size_t> mOrder;
+
+            BudgetUsage mUsage = BudgetUsage ();
+
+            std::vector <Model *> mAnimating;
+    };
+}
+
+template <size_t Width, size_t Height>
+wobbly::BasicModelPool <Width, Height>::BasicModelPool () :
+    priv (new Private)
+{
+}
+
+template <size_t Width, size_t Height>
+wobbly::BasicModelPool <Width, Height>::BasicModelPool (Allocator &allocator) :
+    priv (new Private (allocator))
+{
+}
+
+template <size_t Width, size_t Height>
+wobbly::BasicModelPool <Width, Height>::~BasicModelPool ()
+{
+    for (size_t slot = 0; slot < priv->Slots (); ++slot)
+        if (priv->Live (slot))
+            priv->ModelAt (slot).~Model ();
+}
+
+template <size_t Width, size_t Height>
+typename wobbly::BasicModelPool <Width, Height>::Model &
+wobbly::BasicModelPool <Width, Height>::Create (Point    const &initialPosition,
+                                                double         width,
+                                                double         height,
+                                                Settings const &settings)
+{
+    typedef typename Private::Slab Slab;
+    typedef typename Private::ModelPrivate ModelPrivate;
+
+    if (priv->mFree.empty ())
+    {
+        size_t const first = priv->mSlabs.size () * Private::SlabSize;
+
+        priv->mSlabs.emplace_back (new Slab ());
+        std::fill_n (priv->mSlabs.back ()->live, Private::SlabSize, false);
+
+        for (size_t i = Private::SlabSize; i-- > 0;)
+            priv->mFree.push_back (first + i);
+
+        priv->mIsActive.resize (priv->Slots (), false);
+        priv->mPriorities.resize (priv->Slots ());
+        priv->mMissed.resize (priv->Slots ());
+    }
+
+    size_t const slot = priv->mFree.back ();
+    Slab &slab (*priv->mSlabs[slot / Private::SlabSize]);
+    size_t const index = slot % Private::SlabSize;
+
+    auto *state = new (&slab.state[index]) ModelPrivate (initialPosition,
+                                                         width,
+                                                         height,
+                                                         settings,
+                                                         priv->mAllocator);
+    auto *model = new (&slab.models[index]) Model (state);
+
+    /* Models start out at rest, so are only stepped once something
+     * sets them moving */
+    Private *pool = priv.get ();
+    state->mActivated = [pool, slot]() {
+        pool->Activate (slot);
+    };
+
+    priv->mPriorities[slot] = Priority { false, 0.0 };
+    priv->mMissed[slot] = 0;
+
+    priv->mFree.pop_back ();
+    slab.live[index] = true;
+    ++priv->mSize;
+
+    return *model;
+}
+
+template <size_t Width, size_t Height>
+typename wobbly::BasicModelPool <Width, Height>::Model &
+wobbly::BasicModelPool <Width, Height>::Create (Point const &initialPosition,
+                                                double      width,
+                                                double      height)
+{
+    return Create (initialPosition, width, height, DefaultSettings);
+}
+
+template <size_t Width, size_t Height>
+void
+wobbly::BasicModelPool <Width, Height>::Destroy (Model &model)
+{
+    size_t const slot = priv->SlotOf (model);
+
+    assert (priv->Live (slot));
+
+    priv->Deactivate (slot);
+
+    model.~Model ();
+    priv->mSlabs[slot / Private::SlabSize]->live[slot % Private::SlabSize] = false;
+    priv->mFree.push_back (slot);
+    --priv->mSize;
+
+    auto &animating (priv->mAnimating);
+    animating.erase (std::remove (animating.begin (), animating.end (), &model),
+                     animating.end ());
+}
+
+template <size_t Width, size_t Height>
+size_t
+wobbly::BasicModelPool <Width, Height>::Size () const
+{
+    return priv->mSize;
+}
+
+template <size_t Width, size_t Height>
+void
+wobbly::BasicModelPool <Width, Height>::Activate (Model &model)
+{
+    size_t const slot = priv->SlotOf (model);
+
+    assert (priv->Live (slot));
+
+    priv->Activate (slot);
+}
+
+template <size_t Width, size_t Height>
+size_t
+wobbly::BasicModelPool <Width, Height>::ActiveSize () const
+{
+    return priv->mActive.size ();
+}
+
+template <size_t Width, size_t Height>
+void
+wobbly::BasicModelPool <Width, Height>::ForEachActive (std::function <void (Model &)> const &visit)
+{
+    for (size_t slot : priv->mActive)
+        visit (priv->ModelAt (slot));
+}
+
+template <size_t Width, size_t Height>
+std::vector <wobbly::BasicModel <Width, Height> *> const &
+wobbly::BasicModelPool <Width, Height>::StepAll (unsigned int millisecondsDelta)
+{
+    priv->SortActive ();
+    priv->StepActive (0, priv->mActive.size (), millisecondsDelta);
+
+    return priv->CollectAnimating ();
+}
+
+template <size_t Width, size_t Height>
+std::vector <wobbly::BasicModel <Width, Height> *> const &
+wobbly::BasicModelPool <Width, Height>::StepAll (unsigned int millisecondsDelta,
+                                                 ThreadPool   &threads)
+{
+    priv->SortActive ();
+
+    size_t const active = priv->mActive.size ();
+    size_t const chunkSize = Private::ChunkSize;
+    size_t const chunks = (active + chunkSize - 1) / chunkSize;
+
+    threads.Run (chunks, [this, active, chunkSize, millisecondsDelta](size_t chunk) {
+        priv->StepActive (chunk * chunkSize,
+                          std::min (active, (chunk + 1) * chunkSize),
+                          millisecondsDelta);
+    });
+
+    return priv->CollectAnimating ();
+}
+
+template <size_t Width, size_t Height>
+void
+wobbly::BasicModelPool <Width, Height>::SetPriority (Model          &model,
+                                                     Priority const &priority)
+{
+    size_t const slot = priv->SlotOf (model);
+
+    assert (priv->Live (slot));
+
+    priv->mPriorities[slot] = priority;
+}
+
+template <size_t Width, size_t Height>
+std::vector <wobbly::BasicModel <Width, Height> *> const &
+wobbly::BasicModelPool <Width, Height>::StepAllWithin (unsigned int             millisecondsDelta,
+                                                       std::chrono::nanoseconds budget)
+{
+    typedef std::chrono::steady_clock Clock;
+
+    auto const start = Clock::now ();
+
+    priv->SortActive ();
+
+    auto &order (priv->mOrder);
+    auto const &active (priv->mActive);
+
+    order.resize (active.size ());
+    for (size_t i = 0; i < order.size (); ++i)
+        order[i] = i;
+
+    /* Stable, so that models which matter as much as each other are
+     * still stepped in storage order */
+    std::stable_sort (order.begin (), order.end (),
+                      [this, &active](size_t lhs, size_t rhs) {
+                          size_t const l = active[lhs];
+                          size_t const r = active[rhs];
+                          bool const lUrgent = priv->Urgent (l);
+                          bool const rUrgent = priv->Urgent (r);
+
+                          if (lUrgent != rUrgent)
+                              return lUrgent;
+
+                          return priv->Weight (l) > priv->Weight (r);
+                      });
+
+    /* Models are stepped a chunk at a time, so that there is enough
+     * to fill lanes between checks of the clock */
+    size_t const chunkSize = Private::ChunkSize;
+    size_t stepped = 0;
+
+    while (stepped < order.size ())
+    {
+        bool const urgent = priv->Urgent (active[order[stepped]]);
+
+        if (stepped && !urgent && Clock::now () - start >= budget)
+            break;
+
+        size_t const count = std::min (chunkSize, order.size () - stepped);
+
+        priv->StepEach (count,
+                        [&order, stepped](size_t n) { return order[stepped + n]; },
+                        millisecondsDelta);
+
+        for (size_t n = stepped; n < stepped + count; ++n)
+            priv->mMissed[active[order[n]]] = 0;
+
+        stepped += count;
+    }
+
+    /* Models which missed out still have their animation ahead of them */
+    for (size_t n = stepped; n < order.size (); ++n)
+    {
+        priv->mStepped[order[n]] = true;
+        ++priv->mMissed[active[order[n]]];
+    }
+
+    priv->mUsage.used =
+        std::chrono::duration_cast <std::chrono::nanoseconds> (Clock::now () - start);
+    priv->mUsage.stepped = stepped;
+    priv->mUsage.deferred = order.size () - stepped;
+
+    return priv->CollectAnimating ();
+}
+
+template <size_t Width, size_t Height>
+typename wobbly::BasicModelPool <Width, Height>::BudgetUsage const &
+wobbly::BasicModelPool <Width, Height>::LastBudgetUsage () const
+{
+    return priv->mUsage;
+}
+
+template <size_t Width, size_t Height>
+wobbly::BasicBezierMesh <Width, Height>::BasicBezierMesh ()
 {
     mPoints.fill (0.0);
 }
 
-wobbly::BezierMesh::~BezierMesh ()
+template <size_t Width, size_t Height>
+wobbly::BasicBezierMesh <Width, Height>::~BasicBezierMesh ()
 {
 }
 
@@ -1207,8 +3203,9 @@ namespace
     }
 }
 
+template <size_t Width, size_t Height>
 std::array <animation::Point, 4> const
-wobbly::BezierMesh::Extremes () const
+wobbly::BasicBezierMesh <Width, Height>::Extremes () const
 {
     double const maximum = std::numeric_limits <double>::max ();
     double const minimum = std::numeric_limits <double>::lowest ();
@@ -1238,7 +3235,7 @@ wobbly::BezierMesh::Extremes () const
         return result;
     };
 
-    for (size_t i = 0; i < config::Width * config::Height * 2; i += 2)
+    for (size_t i = 0; i < Width * Height * 2; i += 2)
     {
         double const x = mPoints[i];
         double const y = mPoints[i + 1];
@@ -1252,9 +3249,40 @@ wobbly::BezierMesh::Extremes () const
     return extremes;
 }
 
+template <size_t Width, size_t Height>
 animation::PointView <double>
-wobbly::BezierMesh::PointForIndex (size_t x, size_t y)
+wobbly::BasicBezierMesh <Width, Height>::PointForIndex (size_t x, size_t y)
 {
     return animation::PointView <double> (mPoints,
-                                          CoordIndex (x, y, config::Width));
+                                          CoordIndex (x, y, Width));
+}
+
+namespace wobbly
+{
+    /* Resolutions available to users of the library. The internal
+     * classes are instantiated for the same resolutions, so that tests
+     * can use them directly */
+    template class BasicModel <3, 3>;
+    template class BasicModel <4, 4>;
+    template class BasicModel <8, 8>;
+
+    template class BasicModelPool <3, 3>;
+    template class BasicModelPool <4, 4>;
+    template class BasicModelPool <8, 8>;
+
+    template class BasicSpringMesh <3, 3>;
+    template class BasicSpringMesh <4, 4>;
+    template class BasicSpringMesh <8, 8>;
+
+    template class BasicTargetMesh <3, 3>;
+    template class BasicTargetMesh <4, 4>;
+    template class BasicTargetMesh <8, 8>;
+
+    template class BasicBezierMesh <3, 3>;
+    template class BasicBezierMesh <4, 4>;
+    template class BasicBezierMesh <8, 8>;
+
+    template class BasicConstrainmentStep <3, 3>;
+    template class BasicConstrainmentStep <4, 4>;
+    template class BasicConstrainmentStep <8, 8>;
 }
@@ -27,6 +27,8 @@
 #include <cstddef>
 
 #include <array>                        // for array, swap
+#include <chrono>                       // for nanoseconds
+#include <functional>                   // for function
 #include <memory>
 #include <stdexcept>                    // for runtime_error
 #include <type_traits>
@@ -52,7 +54,7 @@
 // IWYU pragma: no_include <tuple>
 // IWYU pragma: no_include <utility>
 // IWYU pragma: no_forward_declare wobbly::Anchor::MovableAnchor
-// IWYU pragma: no_forward_declare wobbly::Model::Private
+// IWYU pragma: no_forward_declare wobbly::BasicModel::Private
 
 namespace wobbly
 {
@@ -70,6 +72,64 @@ namespace wobbly
     template <typename PointType>
     using Box = animation::geometry::Box <PointType>;
 
+    /* Where models get the memory for their state, springs and anchors.
+     *
+     * Blocks are aligned for any type, like those from operator new, and
+     * are given back with the same size that they were allocated with. */
+    class Allocator
+    {
+        public:
+
+            virtual ~Allocator ();
+
+            virtual void * Allocate (size_t size) = 0;
+            virtual void Deallocate (void *block, size_t size) noexcept = 0;
+
+            /* Allocates straight from the heap, which is what models use
+             * unless given another allocator */
+            static Allocator & Heap ();
+    };
+
+    /* Keeps blocks once they are given back and hands them out again,
+     * so that creating and destroying the same kinds of objects over and
+     * over only goes to upstream the first time around.
+     *
+     * Blocks are kept in power of two size classes up to LargestRecycled,
+     * anything larger always goes to upstream. Nothing is given back to
+     * upstream until the allocator is destroyed, so it must outlive
+     * anything allocated from it. It is not thread safe. */
+    class RecyclingAllocator :
+        public Allocator
+    {
+        public:
+
+            static constexpr size_t SmallestRecycled = 16;
+            static constexpr size_t LargestRecycled = 4096;
+
+            explicit RecyclingAllocator (Allocator &upstream = Allocator::Heap ());
+            ~RecyclingAllocator ();
+
+            RecyclingAllocator (RecyclingAllocator const &) = delete;
+            RecyclingAllocator & operator= (RecyclingAllocator const &) = delete;
+
+            void * Allocate (size_t size) override;
+            void Deallocate (void *block, size_t size) noexcept override;
+
+        private:
+
+            struct FreeBlock
+            {
+                FreeBlock *next;
+            };
+
+            static constexpr size_t SizeClasses = 9;
+
+            static size_t SizeClass (size_t size);
+
+            Allocator                              &mUpstream;
+            std::array <FreeBlock *, SizeClasses>  mFree;
+    };
+
     class Anchor
     {
         public:
@@ -82,9 +142,27 @@ namespace wobbly
             void MoveBy (Vector const &delta) noexcept;
 
             class MovableAnchor;
+
+            /* Anchors made with new are deleted, otherwise they are given
+             * back to the allocator they came from */
             struct MovableAnchorDeleter
             {
+                MovableAnchorDeleter () :
+                    allocator (nullptr),
+                    size (0)
+                {
+                }
+
+                MovableAnchorDeleter (Allocator *allocator, size_t size) :
+                    allocator (allocator),
+                    size (size)
+                {
+                }
+
                 void operator () (MovableAnchor *);
+
+                Allocator *allocator;
+                size_t    size;
             };
 
             typedef std::unique_ptr <MovableAnchor, MovableAnchorDeleter> Impl;
@@ -99,7 +177,8 @@ namespace wobbly
             Impl priv;
     };
 
-    class Model
+    /* Settings and constants shared by models of every resolution */
+    class ModelBase
     {
         public:
 
@@ -110,15 +189,116 @@ namespace wobbly
                 double maximumRange;
             };
 
-            Model (Point const &initialPosition,
-                   double width,
-                   double height,
-                   Settings const &settings);
-            Model (Point const &initialPosition,
-                   double width,
-                   double height);
-            Model (Model const &other);
-            ~Model ();
+            /* How the mesh is turned into a surface by DeformTexcoords.
+             *
+             * SinglePatch uses every point on the mesh as a control point
+             * of one bezier patch, which is smooth, but costs more per
+             * texture co-ordinate as the mesh gets denser.
+             *
+             * PiecewiseBicubic joins a grid of bicubic patches passing
+             * through each point, each co-ordinate only depending on the
+             * 16 points around it. This is better suited to large meshes. */
+            enum class Surface
+            {
+                SinglePatch,
+                PiecewiseBicubic
+            };
+
+            /* How closely a model is simulated, which can be lowered for
+             * windows that are small or out of sight.
+             *
+             * Reduced integrates once for every ReducedStepRatio steps,
+             * so it animates at a fraction of the speed and cost.
+             *
+             * Rigid does not integrate at all. The mesh is put where it
+             * would have settled and from then on only moves as a whole
+             * with its anchors, MoveModelTo and MoveModelBy.
+             *
+             * Going back to Full detail carries on from the mesh as it
+             * is, so changing detail never makes the mesh jump, apart
+             * from when switching to Rigid while it is still moving. */
+            enum class Detail
+            {
+                Full,
+                Reduced,
+                Rigid
+            };
+
+            static constexpr unsigned int ReducedStepRatio = 2;
+
+            /* Windows smaller than this on either side are shown with
+             * Reduced detail by DetailForSize */
+            static constexpr double ReducedDetailSize = 128.0;
+
+            /* A suitable detail for a window taking up visibleWidth by
+             * visibleHeight on screen, which is zero if it cannot be seen
+             * at all */
+            static Detail DetailForSize (double visibleWidth,
+                                         double visibleHeight);
+
+            static constexpr double DefaultSpringConstant = 8.0;
+            static constexpr double DefaultObjectRange = 500.0f;
+            static constexpr double Mass = 15.0f;
+            static constexpr double Friction = 3.0f;
+
+            /* Time covered by one integration */
+            static constexpr std::chrono::milliseconds StepInterval =
+                std::chrono::milliseconds (16);
+
+            /* Step catches up on more integrations than CatchUpSteps
+             * at once, eg, after the compositor stalled, with implicit
+             * integrations covering up to CatchUpStepLength each */
+            static constexpr unsigned int CatchUpSteps = 8;
+            static constexpr unsigned int CatchUpStepLength = 16;
+
+            /* With adaptive stepping, steps are split in two until no
+             * point would change velocity by more than
+             * SubStepVelocityTolerance over one and the springs would be
+             * stable, up to MaximumSubdivision times. While no point is
+             * moving or would change velocity by more than RestVelocity
+             * over a step, up to CatchUpStepLength steps are taken as
+             * one. */
+            static constexpr unsigned int MaximumSubdivision = 64;
+            static constexpr double SubStepVelocityTolerance = 100.0;
+            static constexpr double RestVelocity = 1.0;
+
+            static Settings DefaultSettings;
+    };
+
+    template <size_t Width, size_t Height>
+    class BasicModelPool;
+
+    /* A model whose spring mesh has Width x Height control points. The
+     * resolution is fixed at compile time so that every loop over the
+     * mesh has a constant trip count. Instantiations are provided for
+     * 3x3, 4x4 and 8x8 meshes. */
+    template <size_t Width, size_t Height>
+    class BasicModel :
+        public ModelBase
+    {
+        static_assert (Width >= 2 && Height >= 2,
+                       "Mesh needs at least two points on each side");
+
+        public:
+
+            BasicModel (Point const &initialPosition,
+                        double width,
+                        double height,
+                        Settings const &settings);
+            BasicModel (Point const &initialPosition,
+                        double width,
+                        double height);
+
+            /* Allocates the model along with its springs and anchors
+             * from allocator, which must outlive the model and any of
+             * its anchors */
+            BasicModel (Point const &initialPosition,
+                        double width,
+                        double height,
+                        Settings const &settings,
+                        Allocator &allocator);
+            BasicModel (BasicModel const &other);
+            ~BasicModel ();
 
             /* This function will cause a point on the spring mesh closest
              * to grab in absolute terms to become immobile in the mesh.
@@ -141,14 +321,110 @@ namespace wobbly
             wobbly::Anchor
             InsertAnchor (Point const &grab) noexcept (false);
 
+            /* Like GrabAnchor and InsertAnchor, except that MoveBy on the
+             * returned anchor may be called from one other thread, such
+             * as the one receiving pointer motion. Moves only reach the
+             * mesh at the start of the next step and none are ever lost,
+             * however many arrive in between.
+             *
+             * The anchor must still be created and destroyed on the
+             * thread stepping the model. */
+            wobbly::Anchor
+            GrabQueuedAnchor (Point const &grab) noexcept (false);
+
+            wobbly::Anchor
+            InsertQueuedAnchor (Point const &grab) noexcept (false);
+
             /* Performs a single integration per 16 ms in millisecondsDelta */
             bool Step (unsigned int millisecondsDelta);
 
+            /* Performs a single integration per whole StepInterval in
+             * delta, carrying whatever is left over into the next call.
+             * Unlike Step, this never rounds up, so the model moves at
+             * the same speed and costs the same to step whatever the
+             * frame rate is. A negative delta counts as no time at
+             * all. Returns the same as Step. */
+            bool Advance (std::chrono::nanoseconds delta);
+
+            /* Advances the model by the time since the timestamp that
+             * was last passed here, from any steady clock, such as a
+             * frame clock in microseconds. The first call only notes
+             * the timestamp. */
+            bool AdvanceTo (std::chrono::nanoseconds timestamp);
+
+            /* When interpolating, DeformTexcoords, DeformGrid, Extremes
+             * and snapshots show the mesh blended from how it was before
+             * the last step to how it is now, by InterpolationFactor.
+             * Motion then stays smooth when frames do not line up with
+             * steps, though the mesh is shown up to one step late.
+             *
+             * The blend is only updated when the model is stepped,
+             * advanced, moved or resized. Off by default. */
+            void SetInterpolation (bool interpolate);
+
+            /* How far Advance has got towards the next step, from 0 up
+             * to but not including 1 */
+            double InterpolationFactor () const;
+
+            /* With adaptive stepping, Step chooses how long each
+             * integration is from how fast the mesh is changing and how
+             * stiff the springs are, rather than always taking one per
+             * 16 ms, see SubStepVelocityTolerance. Off by default. */
+            void SetAdaptiveStepping (bool adaptive);
+
+            /* How many integrations the last call to Step took, for
+             * seeing what adaptive stepping and catching up save */
+            unsigned int SubSteps () const;
+
+            /* Whether the last call to Step found that the springs would
+             * not stay stable at any step length adaptive stepping can
+             * take, in which case the mesh was put at rest instead */
+            bool Diverged () const;
+
+            /* How many times the integrations of the last call to Step
+             * skipped a point, or a spring between two such points,
+             * because it had come to rest with nothing near it moving.
+             * Only a mesh without inserted anchors, stepped one
+             * integration at a time, lets points sleep like this. */
+            size_t SleepingPoints () const;
+            size_t SleepingSprings () const;
+
+            /* Estimates how long the mesh will take to come within
+             * threshold of where it settles, from how much energy it has
+             * over its rest position and how quickly friction takes that
+             * out. A frame clock can sleep until then, or stop drawing
+             * once what is left is below a pixel. Zero at rest, and
+             * max () if friction never settles it.
+             *
+             * This errs on the long side for the motion of the springs,
+             * but small forces and velocities are clipped, which can
+             * leave stiff or lightly damped meshes creeping for longer. */
+            std::chrono::milliseconds SettleTime (double threshold = 0.5) const;
+
             /* Takes a normalized texture co-ordinate from 0 to 1 and returns
              * an absolute-position on-screen for that texture co-ordinate
              * as deformed by the model */
             Point DeformTexcoords (Point const &normalized) const;
 
+            /* Deforms a uSteps x vSteps grid of texture co-ordinates evenly
+             * spaced from (0, 0) to (1, 1) in one go, writing
+             * uSteps * vSteps interleaved x, y pairs into vertices with
+             * u varying fastest. Each vertex is the same as what
+             * DeformTexcoords would return for it, but the basis is only
+             * computed once per row and column of the grid */
+            void DeformGrid (size_t uSteps,
+                             size_t vSteps,
+                             double *vertices) const;
+
+            /* Changes the surface used by DeformTexcoords, by default a
+             * single patch */
+            void SetSurface (Surface surface);
+
+            /* Changes how closely the model is simulated from the next
+             * step onwards, by default Full. Switching to Rigid settles
+             * the mesh straight away. */
+            void SetDetail (Detail detail);
+
             /* Bounding box for the model */
             std::array <Point, 4> const Extremes () const;
 
@@ -173,16 +449,224 @@ namespace wobbly
             void MoveModelBy (Point const &delta);
             void ResizeModel (double width, double height);
 
-            static constexpr double DefaultSpringConstant = 8.0;
-            static constexpr double DefaultObjectRange = 500.0f;
-            static constexpr double Mass = 15.0f;
-            static constexpr double Friction = 3.0f;
+            /* The mesh as it was after some step, which can be deformed
+             * on another thread while the model carries on stepping. */
+            class Snapshot
+            {
+                public:
 
-            static Settings DefaultSettings;
+                    Point DeformTexcoords (Point const &normalized) const;
+                    void DeformGrid (size_t uSteps,
+                                     size_t vSteps,
+                                     double *vertices) const;
+                    std::array <Point, 4> const Extremes () const;
+
+                    /* Number of snapshots published before this one */
+                    unsigned long long Sequence () const;
+
+                    /* Defined alongside the model */
+                    struct Frame;
+
+                private:
+
+                    friend class BasicModel;
+
+                    explicit Snapshot (Frame const &frame);
+
+                    Frame const *frame;
+            };
+
+            /* Starts publishing a Snapshot of the mesh after every step,
+             * the first one being the mesh as it is now. This must be
+             * called before any other thread asks for a snapshot. */
+            void PublishSnapshots ();
+
+            /* The most recently published Snapshot. This never waits on
+             * Step, so it can be called from one other thread while the
+             * model is being stepped. The snapshot stays the same until
+             * the next call to LatestSnapshot. */
+            Snapshot LatestSnapshot ();
+
+        private:
+
+            friend class BasicModelPool <Width, Height>;
+
+            class Private;
+
+            /* Models created by a BasicModelPool have their Private in
+             * storage owned by the pool, so it is only destroyed here.
+             * Otherwise it is given back to allocator. */
+            struct PrivateDeleter
+            {
+                bool      pooled;
+                Allocator *allocator;
+
+                void operator() (Private *p) const;
+            };
+
+            explicit BasicModel (Private *pooled);
+
+            std::unique_ptr <Private, PrivateDeleter> priv;
+    };
+
+    typedef BasicModel <4, 4> Model;
+
+    /* Threads which BasicModelPool::StepAll can spread models across.
+     *
+     * Work is handed out as chunks, each thread starting on an even
+     * share of them and stealing from the others once it runs out, so
+     * that a few expensive chunks do not hold up the rest. */
+    class ThreadPool
+    {
+        public:
+
+            /* nThreads counts the calling thread, which takes part in
+             * Run. Zero uses one thread per hardware thread. */
+            explicit ThreadPool (size_t nThreads = 0);
+            ~ThreadPool ();
+
+            ThreadPool (ThreadPool const &) = delete;
+            ThreadPool & operator= (ThreadPool const &) = delete;
+
+            size_t Size () const;
+
+            /* Calls task once for each chunk from 0 to nChunks - 1 across
+             * all threads, returning once every chunk is done. The task
+             * must not throw. */
+            void Run (size_t nChunks, std::function <void (size_t)> const &task);
+
+        private:
+
+            class Private;
+            std::unique_ptr <Private> priv;
+    };
+
+    /* Owns many models of the same resolution, keeping the state of each
+     * (positions, velocities, forces and targets) in slabs of contiguous
+     * storage rather than in a heap allocation per model, so that all of
+     * them can be stepped in one sweep.
+     *
+     * Models created by the pool are used exactly like any other model,
+     * but are only ever destroyed through Destroy or along with the
+     * pool. */
+    template <size_t Width, size_t Height>
+    class BasicModelPool :
+        public ModelBase
+    {
+        public:
+
+            typedef BasicModel <Width, Height> Model;
+
+            /* The springs and anchors of each model come from allocator,
+             * which must outlive the pool, or otherwise from a
+             * RecyclingAllocator owned by the pool, so that models and
+             * anchors can come and go without going to the heap each
+             * time. The pool's own slabs always come from the heap.
+             *
+             * Stepping never allocates from allocator, so it need not
+             * be thread safe for StepAll to run across threads. */
+            BasicModelPool ();
+            explicit BasicModelPool (Allocator &allocator);
+            ~BasicModelPool ();
+
+            BasicModelPool (BasicModelPool const &) = delete;
+            BasicModelPool & operator= (BasicModelPool const &) = delete;
+
+            /* Creates a model in the pool. As with BasicModel, settings
+             * must outlive the model. The returned reference stays valid
+             * until the model is destroyed. */
+            Model & Create (Point const &initialPosition,
+                            double width,
+                            double height,
+                            Settings const &settings);
+            Model & Create (Point const &initialPosition,
+                            double width,
+                            double height);
+
+            void Destroy (Model &model);
+
+            /* Number of models currently in the pool */
+            size_t Size () const;
+
+            /* Models in the pool are only stepped while they are active.
+             * A model becomes active when it is grabbed, has an anchor
+             * inserted, or is moved or resized, and stays active until
+             * it has settled and nothing holds it any more, so that
+             * models at rest cost nothing to step.
+             *
+             * Activate makes a model active for any other change which
+             * could set it moving, such as a change to its settings. */
+            void Activate (Model &model);
+
+            /* Number of models currently active, and a way to visit
+             * each of them in time proportional to that number */
+            size_t ActiveSize () const;
+            void ForEachActive (std::function <void (Model &)> const &visit);
+
+            /* Steps every active model in the pool as Model::Step would,
+             * in the order they are laid out in storage. Returns the
+             * models which still need more steps, which stays valid until
+             * the next call or until one of those models is destroyed. */
+            std::vector <Model *> const & StepAll (unsigned int millisecondsDelta);
+
+            /* As above, but stepping the models across threads. Each
+             * model is stepped by a single thread. Models only share
+             * what stepping reads, such as the pool's spring layout,
+             * and anything a step allocates comes from the heap rather
+             * than the pool's allocator. So the result is the same for
+             * any number of threads. */
+            std::vector <Model *> const & StepAll (unsigned int millisecondsDelta,
+                                                   ThreadPool   &threads);
+
+            /* How much a model matters to StepAllWithin. Focused models,
+             * along with any that are held by an anchor, are always
+             * stepped. The rest are stepped in order of how much of them
+             * is on screen. */
+            struct Priority
+            {
+                bool   focused;
+                double visibleArea;
+            };
+
+            /* Models start out with no priority at all */
+            void SetPriority (Model &model, Priority const &priority);
+
+            /* What the last call to StepAllWithin did */
+            struct BudgetUsage
+            {
+                std::chrono::nanoseconds used;
+                size_t                   stepped;
+                size_t                   deferred;
+            };
+
+            /* As StepAll, but stops stepping models once budget has been
+             * used up, in order of priority.
+             *
+             * Models which miss out are not stepped at all this time,
+             * so their animation slows down rather than trying to catch
+             * up later. They are still returned as animating, and come
+             * earlier each time they miss out so that none are left
+             * behind for good. At least a few models are always stepped,
+             * whatever the budget. */
+            std::vector <Model *> const &
+            StepAllWithin (unsigned int             millisecondsDelta,
+                           std::chrono::nanoseconds budget);
+
+            BudgetUsage const & LastBudgetUsage () const;
 
         private:
 
             class Private;
             std::unique_ptr <Private> priv;
     };
+
+    typedef BasicModelPool <4, 4> ModelPool;
+
+    extern template class BasicModel <3, 3>;
+    extern template class BasicModel <4, 4>;
+    extern template class BasicModel <8, 8>;
+
+    extern template class BasicModelPool <3, 3>;
+    extern template class BasicModelPool <4, 4>;
+    extern template class BasicModelPool <8, 8>;
 }
@@ -29,10 +29,14 @@
 
 #include <algorithm>                    // for remove_if, find_if, etc
 #include <array>                        // for array
+#include <atomic>                       // for atomic
 #include <functional>                   // for function, __base, minus
 #include <iterator>                     // for end, begin, distance
 #include <limits>                       // for numeric_limits
+#include <map>                          // for map
 #include <memory>                       // for unique_ptr
+#include <mutex>                        // for mutex, lock_guard
+#include <new>                          // for operator new
 #include <stdexcept>                    // for logic_error
 #include <type_traits>                  // for move, enable_if, etc
 #include <vector>                       // for vector
@@ -42,10 +46,12 @@
 #include <assert.h>                     // for assert
 #include <math.h>                       // for fabs
 #include <stddef.h>                     // for size_t
+#include <stdint.h>                     // for uint64_t
 
 #include <animation/geometry.h>         // for PointView, PointModel, etc
 #include <animation/geometry_traits.h>  // for assign, scale, etc
 #include <animation/wobbly/wobbly.h>    // for PointView, Vector, Point, etc
+#include <animation/wobbly/wobbly_simd.h>  // for ApplySpringForces, etc
 
 namespace wobbly
 {
@@ -57,6 +63,136 @@ namespace wobbly
             virtual void MoveBy (Vector const &delta) noexcept = 0;
     };
 
+    /* Constructs an anchor of type T in a block from allocator, which
+     * is given back to it once the anchor is destroyed */
+    template <typename T, typename... Args>
+    Anchor::Impl AllocateAnchor (Allocator &allocator, Args&&... args)
+    {
+        static_assert (std::is_base_of <Anchor::MovableAnchor, T>::value,
+                       "Only a MovableAnchor can be allocated as an anchor");
+
+        void *block = allocator.Allocate (sizeof (T));
+
+        try
+        {
+            T *anchor = new (block) T (std::forward <Args> (args)...);
+            return Anchor::Impl (anchor,
+                                 Anchor::MovableAnchorDeleter { &allocator,
+                                                                sizeof (T) });
+        }
+        catch (...)
+        {
+            allocator.Deallocate (block, sizeof (T));
+            throw;
+        }
+    }
+
+    /* Lets standard containers allocate from an Allocator */
+    template <typename T>
+    struct AllocatorAdapter
+    {
+        typedef T value_type;
+
+        AllocatorAdapter (Allocator &allocator) noexcept :
+            allocator (&allocator)
+        {
+        }
+
+        template <typename U>
+        AllocatorAdapter (AllocatorAdapter <U> const &other) noexcept :
+            allocator (other.allocator)
+        {
+        }
+
+        T * allocate (size_t n)
+        {
+            return static_cast <T *> (allocator->Allocate (n * sizeof (T)));
+        }
+
+        void deallocate (T *block, size_t n) noexcept
+        {
+            allocator->Deallocate (block, n * sizeof (T));
+        }
+
+        Allocator *allocator;
+    };
+
+    template <typename T, typename U>
+    bool operator== (AllocatorAdapter <T> const &lhs,
+                     AllocatorAdapter <U> const &rhs) noexcept
+    {
+        return lhs.allocator == rhs.allocator;
+    }
+
+    template <typename T, typename U>
+    bool operator!= (AllocatorAdapter <T> const &lhs,
+                     AllocatorAdapter <U> const &rhs) noexcept
+    {
+        return !(lhs == rhs);
+    }
+
+    /* An array of count plain values from an Allocator, which goes back
+     * to it along with the owning pointer */
+    template <typename T>
+    struct AllocatorDeleter
+    {
+        Allocator *allocator;
+        size_t    count;
+
+        void operator () (T *block) const noexcept
+        {
+            allocator->Deallocate (block, count * sizeof (T));
+        }
+    };
+
+    template <typename T>
+    using AllocatedArray = std::unique_ptr <T[], AllocatorDeleter <T>>;
+
+    template <typename T>
+    AllocatedArray <T> AllocateArray (Allocator &allocator, size_t count)
+    {
+        static_assert (std::is_trivial <T>::value,
+                       "Allocated arrays are never constructed or destroyed");
+
+        T *block = static_cast <T *> (allocator.Allocate (count * sizeof (T)));
+        return AllocatedArray <T> (block, AllocatorDeleter <T> { &allocator, count });
+    }
+
+    /* A single object constructed in a block from an Allocator, which is
+     * destroyed and goes back to it along with the owning pointer */
+    template <typename T>
+    struct AllocatedObjectDeleter
+    {
+        Allocator *allocator;
+
+        void operator () (T *object) const noexcept
+        {
+            object->~T ();
+            allocator->Deallocate (object, sizeof (T));
+        }
+    };
+
+    template <typename T>
+    using AllocatedObject = std::unique_ptr <T, AllocatedObjectDeleter <T>>;
+
+    template <typename T, typename... Args>
+    AllocatedObject <T> AllocateObject (Allocator &allocator, Args&&... args)
+    {
+        void *block = allocator.Allocate (sizeof (T));
+
+        try
+        {
+            T *object = new (block) T (std::forward <Args> (args)...);
+            return AllocatedObject <T> (object,
+                                        AllocatedObjectDeleter <T> { &allocator });
+        }
+        catch (...)
+        {
+            allocator.Deallocate (block, sizeof (T));
+            throw;
+        }
+    }
+
     template <class T, class F, class... A>
     struct HasNoExceptMemFn
     {
@@ -111,7 +247,7 @@ namespace wobbly
         }
     }
 
-    /* Precision of the model itself */
+    /* Precision of the default model, see wobbly::Model */
     namespace config
     {
         static constexpr size_t Width = 4;
@@ -120,23 +256,26 @@ namespace wobbly
         static constexpr size_t ArraySize  = TotalIndices * 2;
     }
 
-    typedef std::array <double, config::ArraySize> MeshArray;
+    template <size_t Width, size_t Height>
+    using BasicMeshArray = std::array <double, Width * Height * 2>;
+
+    typedef BasicMeshArray <config::Width, config::Height> MeshArray;
 
     namespace mesh
     {
         namespace agd = animation::geometry::dimension;
 
+        template <size_t Width = config::Width,
+                  size_t Height = config::Height>
         inline void
-        CalculatePositionArray (animation::Point  const &initialPosition,
-                                wobbly::MeshArray       &array,
-                                animation::Vector const &tileSize)
+        CalculatePositionArray (animation::Point               const &initialPosition,
+                                BasicMeshArray <Width, Height>       &array,
+                                animation::Vector              const &tileSize)
         {
-            assert (array.size () == wobbly::config::ArraySize);
-
-            for (size_t i = 0; i < wobbly::config::TotalIndices; ++i)
+            for (size_t i = 0; i < Width * Height; ++i)
             {
-                size_t const row = i / wobbly::config::Width;
-                size_t const column = i % wobbly::config::Width;
+                size_t const row = i / Width;
+                size_t const column = i % Width;
 
                 animation::PointView <double> position (array, i);
                 agd::assign (position, initialPosition);
@@ -146,16 +285,35 @@ namespace wobbly
             }
         }
 
+        /* Calls visit (neighbour, across, down) for each point joined
+         * to index by a spring of the grid, where across and down are
+         * -1, 0 or 1 tiles from index to the neighbour */
+        template <size_t Width, size_t Height, typename Visitor>
+        inline void
+        ForEachNeighbour (size_t index, Visitor const &visit)
+        {
+            size_t const x = index % Width;
+            size_t const y = index / Width;
+
+            if (x > 0)
+                visit (index - 1, -1, 0);
+            if (x < Width - 1)
+                visit (index + 1, 1, 0);
+            if (y > 0)
+                visit (index - Width, 0, -1);
+            if (y < Height - 1)
+                visit (index + Width, 0, 1);
+        }
+
+        template <size_t N>
         inline size_t
-        ClosestIndexToPosition (wobbly::MeshArray      &points,
+        ClosestIndexToPosition (std::array <double, N> &points,
                                 animation::Point const &pos)
         {
             std::experimental::optional <size_t> nearestIndex;
             double distance = std::numeric_limits <double>::max ();
 
-            assert (points.size () == wobbly::config::ArraySize);
-
-            for (size_t i = 0; i < wobbly::config::TotalIndices; ++i)
+            for (size_t i = 0; i < N / 2; ++i)
             {
                 animation::PointView <double> view (points, i);
                 double objectDistance = agd::distance (pos, view);
@@ -259,6 +417,11 @@ namespace wobbly
                 return forceB;
             }
 
+            Vector const & DesiredDistance () const
+            {
+                return desiredDistance;
+            }
+
             typedef wobbly::ObjectIdentifier ID;
 
             bool HasID (ID const &candidateId) const
@@ -282,6 +445,11 @@ namespace wobbly
 
             static constexpr double ClipThreshold = 0.5;
 
+            /* Velocities below this are clipped to zero by every
+             * integration strategy, so that points the springs have
+             * stopped pulling come to rest */
+            static constexpr double VelocityThreshold = 0.1;
+
         private:
 
             typedef std::function <size_t ()> IDFetchStrategy;
@@ -313,15 +481,23 @@ namespace wobbly
 
             typedef std::array <Anchor, N> InternalArray;
 
+            /* One bit per index, set where that index is anchored, so
+             * that bulk operations can select anchored indices without
+             * branching on the lock count of each */
+            typedef std::array <uint64_t, (N + 63) / 64> Mask;
+
             TrackedAnchors ()
             {
                 anchors.fill (0);
+                mask.fill (0);
             }
 
             void Lock (size_t index)
             {
                 /* Keep track of the first-anchor value */
                 unsigned int const previousValue = anchors[index]++;
+                if (previousValue == 0)
+                    mask[index / 64] |= uint64_t (1) << (index % 64);
                 if (previousValue == 0 && !firstAnchor)
                     firstAnchor = index;
             }
@@ -330,6 +506,9 @@ namespace wobbly
             {
                 unsigned int const currentValue = --anchors[index];
 
+                if (currentValue == 0)
+                    mask[index / 64] &= ~(uint64_t (1) << (index % 64));
+
                 bool const firstAnchorIsThisIndex =
                     firstAnchor && *firstAnchor == index;
 
@@ -366,16 +545,55 @@ namespace wobbly
                     action (*firstAnchor);
             }
 
+            Mask const & AnchorMask () const
+            {
+                return mask;
+            }
+
         private:
 
             TrackedAnchors (TrackedAnchors const &) = delete;
             TrackedAnchors & operator= (TrackedAnchors const &) = delete;
 
             std::array <unsigned int, N> anchors;
+            Mask                         mask;
             std::experimental::optional <size_t> firstAnchor;
     };
 
-    typedef TrackedAnchors <config::TotalIndices> AnchorArray;
+    template <size_t Width, size_t Height>
+    using BasicAnchorArray = TrackedAnchors <Width * Height>;
+
+    typedef BasicAnchorArray <config::Width, config::Height> AnchorArray;
+
+    /* Returns the (up to) 64 bits of mask starting at bit begin */
+    template <size_t Words>
+    inline uint64_t
+    MaskBitsFrom (std::array <uint64_t, Words> const &mask, size_t begin)
+    {
+        size_t const word = begin / 64;
+        size_t const shift = begin % 64;
+
+        uint64_t bits = mask[word] >> shift;
+        if (shift && word + 1 < Words)
+            bits |= mask[word + 1] << (64 - shift);
+
+        return bits;
+    }
+
+    /* Sets the bits of mask starting at bit begin which are set in bits */
+    template <size_t Words>
+    inline void
+    SetMaskBitsFrom (std::array <uint64_t, Words> &mask,
+                     size_t                       begin,
+                     uint64_t                     bits)
+    {
+        size_t const word = begin / 64;
+        size_t const shift = begin % 64;
+
+        mask[word] |= bits << shift;
+        if (shift && word + 1 < Words)
+            mask[word + 1] |= bits >> (64 - shift);
+    }
 
     struct Empty
     {
@@ -562,29 +780,40 @@ namespace wobbly
             Release  release;
     };
 
-    class TargetMesh
+    template <size_t Width, size_t Height>
+    class BasicTargetMesh
     {
         public:
 
+            typedef BasicMeshArray <Width, Height> MeshArray;
+
             typedef std::function <void (MeshArray &)> OriginRecalcStrategy;
             typedef std::function <void (animation::Vector const &)> Move;
 
-            TargetMesh (OriginRecalcStrategy const &recalc);
+            BasicTargetMesh (OriginRecalcStrategy const &recalc);
 
+            /* The handle type does not depend on the mesh size */
             typedef TemporaryOwner <MoveOnly <Move>> Hnd;
 
             Hnd Activate () noexcept (true);
 
-            wobbly::MeshArray const & PointArray () const noexcept (true)
+            MeshArray const & PointArray () const noexcept (true)
             {
                 return mPoints;
             }
 
-            wobbly::MeshArray & PointArray () noexcept (true)
+            MeshArray & PointArray () noexcept (true)
             {
                 return mPoints;
             }
 
+            /* Whether any handle is holding the target mesh, even if
+             * there are too many for it to be active */
+            bool Held () const noexcept
+            {
+                return activationCount > 0;
+            }
+
             /* Calls some arbitrtary function and returns its return value
              * if the mesh is active, with the first argument to that function
              * being the target mesh and the following arguments being user
@@ -626,6 +855,8 @@ namespace wobbly
             OriginRecalcStrategy origin;
     };
 
+    typedef BasicTargetMesh <config::Width, config::Height> TargetMesh;
+
     template <typename Strategy,
               typename = EnableIfHasNoExceptFn <Strategy,
                                                 decltype (&Strategy::MoveBy)>>
@@ -666,14 +897,42 @@ namespace wobbly
             Strategy        strategy;
     };
 
-    class BezierMesh
+    template <size_t Width, size_t Height>
+    class BasicBezierMesh
     {
         public:
 
-            BezierMesh ();
-            ~BezierMesh ();
+            typedef BasicMeshArray <Width, Height> MeshArray;
+
+            BasicBezierMesh ();
+            ~BasicBezierMesh ();
 
             Point DeformUnitCoordsToMeshSpace (Point const &normalized) const;
+
+            /* Like DeformUnitCoordsToMeshSpace, but treats the mesh as a
+             * grid of C1-continuous bicubic patches which pass through
+             * every point, rather than one patch using every point as a
+             * control point. Each evaluation only reads the 4x4 points
+             * around normalized, whatever the size of the mesh. */
+            Point DeformUnitCoordsPiecewise (Point const &normalized) const;
+
+            /* Deforms a uSteps x vSteps grid of evenly spaced unit
+             * co-ordinates from (0, 0) to (1, 1), writing interleaved x, y
+             * pairs to output with u varying fastest, the same as calling
+             * DeformUnitCoordsToMeshSpace (or DeformUnitCoordsPiecewise)
+             * for each of them.
+             *
+             * The basis for each u and v comes from a table shared by
+             * every mesh using the same number of steps and each u sample
+             * first collapses the mesh into a single row, so the cost per
+             * vertex only depends on the width of the mesh. */
+            void DeformGrid (size_t uSteps,
+                             size_t vSteps,
+                             double *output) const;
+            void DeformGridPiecewise (size_t uSteps,
+                                      size_t vSteps,
+                                      double *output) const;
+
             std::array <Point, 4> const Extremes () const;
 
             /* Direct access to the points in this mesh is permitted.
@@ -700,22 +959,44 @@ namespace wobbly
             MeshArray mPoints;
     };
 
-    class ConstrainmentStep
+    typedef BasicBezierMesh <config::Width, config::Height> BezierMesh;
+
+    template <size_t Width, size_t Height>
+    class BasicConstrainmentStep
     {
         public:
 
-            ConstrainmentStep (double     const &threshold,
-                               TargetMesh const &targets);
+            typedef BasicMeshArray <Width, Height> MeshArray;
+            typedef BasicAnchorArray <Width, Height> AnchorArray;
+            typedef BasicTargetMesh <Width, Height> TargetMesh;
+
+            BasicConstrainmentStep (double     const &threshold,
+                                    TargetMesh const &targets);
 
             bool operator () (MeshArray         &points,
                               AnchorArray const &anchors);
 
+            /* The target mesh if constrainment is in effect, otherwise
+             * nullptr */
+            MeshArray const * ActiveTargets () const;
+
+            /* Constrains points in [begin, end) to be within range of
+             * their counterpart in targets, returning true if any point
+             * had to be moved */
+            bool ConstrainRange (MeshArray       &points,
+                                 MeshArray const &targets,
+                                 size_t          begin,
+                                 size_t          end) const;
+
         private:
 
             double     const &threshold;
             TargetMesh const &targets;
     };
 
+    typedef BasicConstrainmentStep <config::Width, config::Height>
+        ConstrainmentStep;
+
     /* AnchoredIntegration wraps an IntegrationStrategy and performs it on
      * a point only if there is no corresponding anchor set for that point */
     template <typename IntegrationStrategy>
@@ -728,19 +1009,101 @@ namespace wobbly
             {
             }
 
+            /* Works on meshes of any size, so the mesh and anchor
+             * array types are deduced. Steps are one unit of time long
+             * unless told otherwise. */
+            template <typename MeshArray, typename AnchorArray>
+            bool operator () (MeshArray         &positions,
+                              MeshArray   const &forces,
+                              AnchorArray const &anchors,
+                              double            friction,
+                              double            time = 1.0)
+            {
+                return Integrate (strategy, positions, forces, anchors,
+                                  friction, time, 0);
+            }
+
+            /* Integrates only the points in [begin, end), which requires
+             * the strategy to provide StepRange */
+            template <typename MeshArray, typename AnchorArray>
             bool operator () (MeshArray         &positions,
                               MeshArray   const &forces,
                               AnchorArray const &anchors,
-                              double            friction)
+                              double            friction,
+                              size_t            begin,
+                              size_t            end)
+            {
+                return StepRange (positions,
+                                  forces,
+                                  anchors.AnchorMask (),
+                                  friction,
+                                  begin,
+                                  end);
+            }
+
+            /* As above, leaving alone every point set in mask as if it
+             * were anchored */
+            template <typename MeshArray, typename AnchorMask>
+            bool StepRange (MeshArray        &positions,
+                            MeshArray  const &forces,
+                            AnchorMask const &mask,
+                            double           friction,
+                            size_t           begin,
+                            size_t           end)
+            {
+                return strategy.StepRange (1.0,
+                                           friction,
+                                           Model::Mass,
+                                           positions,
+                                           forces,
+                                           mask,
+                                           begin,
+                                           end);
+            }
+
+        private:
+
+            typedef IntegrationStrategy IS;
+
+            /* Strategies which can step the entire mesh in one pass
+             * using the anchor mask are preferred */
+            template <typename S, typename MeshArray, typename AnchorArray>
+            static auto Integrate (S                 &strategy,
+                                   MeshArray         &positions,
+                                   MeshArray   const &forces,
+                                   AnchorArray const &anchors,
+                                   double            friction,
+                                   double            time,
+                                   int) ->
+                decltype (strategy.StepAll (time, friction, Model::Mass,
+                                            positions, forces,
+                                            anchors.AnchorMask ()))
+            {
+                return strategy.StepAll (time,
+                                         friction,
+                                         Model::Mass,
+                                         positions,
+                                         forces,
+                                         anchors.AnchorMask ());
+            }
+
+            template <typename S, typename MeshArray, typename AnchorArray>
+            static bool Integrate (S                 &strategy,
+                                   MeshArray         &positions,
+                                   MeshArray   const &forces,
+                                   AnchorArray const &anchors,
+                                   double            friction,
+                                   double            time,
+                                   long)
             {
                 bool more = false;
-                auto const resetAction = [this](size_t i) {
+                auto const resetAction = [&strategy](size_t i) {
                     strategy.Reset (i);
                 };
                 auto const stepAction =
-                    [this, friction, &positions, &forces, &more](size_t i) {
+                    [&strategy, friction, time, &positions, &forces, &more](size_t i) {
                         more |= strategy.Step (i,
-                                               1.0,
+                                               time,
                                                friction,
                                                Model::Mass,
                                                positions,
@@ -752,10 +1115,6 @@ namespace wobbly
                 return more;
             }
 
-        private:
-
-            typedef IntegrationStrategy IS;
-
             AnchoredIntegration (AnchoredIntegration <IS> const &) = delete;
             AnchoredIntegration <IS> &
             operator= (AnchoredIntegration <IS> const &) = delete;
@@ -771,11 +1130,242 @@ namespace wobbly
                     animation::PointView <double>       &&invelocity,
                     animation::PointView <double const> &&inforce);
 
-    class EulerIntegration
+    template <size_t Width, size_t Height>
+    class BasicEulerIntegration
+    {
+        public:
+
+            typedef BasicMeshArray <Width, Height> MeshArray;
+            typedef BasicAnchorArray <Width, Height> AnchorArray;
+            typedef typename AnchorArray::Mask AnchorMask;
+
+            BasicEulerIntegration ()
+            {
+                velocities.fill (0.0);
+            }
+
+            void Reset (size_t i);
+            bool Step (size_t          i,
+                       double          time,
+                       double          friction,
+                       double          mass,
+                       MeshArray       &positions,
+                       MeshArray const &forces);
+
+            /* Equivalent to calling Reset for every anchored index and
+             * Step for every other index, but done in a single pass */
+            bool StepAll (double           time,
+                          double           friction,
+                          double           mass,
+                          MeshArray        &positions,
+                          MeshArray  const &forces,
+                          AnchorMask const &anchorMask);
+
+            /* Like StepAll, but only for the indices in [begin, end) */
+            bool StepRange (double           time,
+                            double           friction,
+                            double           mass,
+                            MeshArray        &positions,
+                            MeshArray  const &forces,
+                            AnchorMask const &anchorMask,
+                            size_t           begin,
+                            size_t           end);
+
+            MeshArray & Velocities ()
+            {
+                return velocities;
+            }
+
+            MeshArray const & Velocities () const
+            {
+                return velocities;
+            }
+
+        private:
+
+            MeshArray velocities;
+    };
+
+    typedef BasicEulerIntegration <config::Width, config::Height> EulerIntegration;
+
+    /* The longest step that EulerIntegrate stays stable with on a grid.
+     *
+     * Springs pull each end by k / 2 of their stretch and points move
+     * at half of their velocity, so each mode of the mesh oscillates at
+     * w^2 = k l / 4m, where l is its eigenvalue of the graph Laplacian.
+     * No point has more than four springs, so l is at most 8. Explicit
+     * steps make the fastest mode grow unless w t < 2, and friction
+     * overshoots unless friction t / m < 2. */
+    inline double
+    StableEulerStep (double springConstant, double friction, double mass)
+    {
+        double step = std::numeric_limits <double>::infinity ();
+
+        if (springConstant > 0.0)
+            step = 2.0 / std::sqrt (springConstant * 8.0 / (4.0 * mass));
+
+        if (friction > 0.0)
+            step = std::min (step, 2.0 * mass / friction);
+
+        return step;
+    }
+
+    /* How many steps friction takes to bring a mesh holding energy over
+     * its rest position to within threshold of it, where softestMode is
+     * the least eigenvalue l of the graph Laplacian of the mesh.
+     *
+     * The mesh stores k l / 4 of the square of how far its softest mode
+     * is from rest, and all of the energy could end up there, so no
+     * point can be further than sqrt (4 E / k l). Each mode oscillates
+     * at w^2 = k l / 4m, see StableEulerStep, and friction shrinks it by
+     * exp (-r t), where r is friction / 2m until friction overdamps the
+     * mode, and less after. The softest mode shrinks slowest. */
+    inline double
+    SettleSteps (double energy,
+                 double springConstant,
+                 double friction,
+                 double mass,
+                 double softestMode,
+                 double threshold)
+    {
+        double const furthest =
+            std::sqrt (4.0 * energy / (springConstant * softestMode));
+
+        if (!(furthest > threshold))
+            return 0.0;
+
+        double const damping = friction / (2.0 * mass);
+        double const frequency = springConstant * softestMode / (4.0 * mass);
+        double const rate =
+            damping - std::sqrt (std::max (0.0, damping * damping - frequency));
+
+        return std::log (furthest / threshold) / rate;
+    }
+
+    /* Calls strategy.Reset for every index in [begin, end) set in
+     * anchorMask and strategy.Step for every other one, returning true
+     * if any step did. For strategies without a vectorized kernel. */
+    template <typename Strategy, typename MeshArray, typename AnchorMask>
+    bool StepUnanchored (Strategy         &strategy,
+                         double           time,
+                         double           friction,
+                         double           mass,
+                         MeshArray        &positions,
+                         MeshArray  const &forces,
+                         AnchorMask const &anchorMask,
+                         size_t           begin,
+                         size_t           end);
+
+    /* The integrators below follow the same motion as EulerIntegrate
+     * does for small steps, where a point moves at half of its
+     * velocity and friction acts against the velocity, so that they
+     * can be swapped in for one another without the mesh looking any
+     * different. They differ in how well they cope with long steps. */
+
+    /* Semi-implicit (symplectic) Euler, where the position is moved by
+     * the updated velocity and friction is solved for implicitly, so
+     * that however long the step, friction only ever slows a point
+     * down rather than reversing it. */
+    bool
+    SymplecticEulerIntegrate (double                              time,
+                              double                              friction,
+                              double                              mass,
+                              animation::PointView <double>       &&inposition,
+                              animation::PointView <double>       &&invelocity,
+                              animation::PointView <double const> &&inforce);
+
+    template <size_t Width, size_t Height>
+    class BasicSymplecticEulerIntegration
+    {
+        public:
+
+            typedef BasicMeshArray <Width, Height> MeshArray;
+            typedef BasicAnchorArray <Width, Height> AnchorArray;
+            typedef typename AnchorArray::Mask AnchorMask;
+
+            BasicSymplecticEulerIntegration ()
+            {
+                velocities.fill (0.0);
+            }
+
+            void Reset (size_t i);
+            bool Step (size_t          i,
+                       double          time,
+                       double          friction,
+                       double          mass,
+                       MeshArray       &positions,
+                       MeshArray const &forces);
+
+            bool StepAll (double           time,
+                          double           friction,
+                          double           mass,
+                          MeshArray        &positions,
+                          MeshArray  const &forces,
+                          AnchorMask const &anchorMask)
+            {
+                return StepUnanchored (*this, time, friction, mass,
+                                       positions, forces, anchorMask,
+                                       0, Width * Height);
+            }
+
+            bool StepRange (double           time,
+                            double           friction,
+                            double           mass,
+                            MeshArray        &positions,
+                            MeshArray  const &forces,
+                            AnchorMask const &anchorMask,
+                            size_t           begin,
+                            size_t           end)
+            {
+                return StepUnanchored (*this, time, friction, mass,
+                                       positions, forces, anchorMask,
+                                       begin, end);
+            }
+
+            MeshArray & Velocities ()
+            {
+                return velocities;
+            }
+
+            MeshArray const & Velocities () const
+            {
+                return velocities;
+            }
+
+        private:
+
+            MeshArray velocities;
+    };
+
+    typedef BasicSymplecticEulerIntegration <config::Width, config::Height>
+        SymplecticEulerIntegration;
+
+    /* Position (Stormer) Verlet, taking friction from the central
+     * difference of the positions either side of the current one. This
+     * is second order accurate, where both Euler integrators are first
+     * order. The velocity over the last step is kept rather than the
+     * last position, so that steps can vary in length. */
+    bool
+    VerletIntegrate (double                              time,
+                     double                              friction,
+                     double                              mass,
+                     animation::PointView <double>       &&inposition,
+                     animation::PointView <double>       &&invelocity,
+                     animation::PointView <double const> &&inforce);
+
+    template <size_t Width, size_t Height>
+    class BasicVerletIntegration
     {
         public:
 
-            EulerIntegration ();
+            typedef BasicMeshArray <Width, Height> MeshArray;
+            typedef BasicAnchorArray <Width, Height> AnchorArray;
+            typedef typename AnchorArray::Mask AnchorMask;
+
+            BasicVerletIntegration ()
+            {
+                velocities.fill (0.0);
+            }
 
             void Reset (size_t i);
             bool Step (size_t          i,
@@ -784,22 +1374,63 @@ namespace wobbly
                        double          mass,
                        MeshArray       &positions,
                        MeshArray const &forces);
+
+            bool StepAll (double           time,
+                          double           friction,
+                          double           mass,
+                          MeshArray        &positions,
+                          MeshArray  const &forces,
+                          AnchorMask const &anchorMask)
+            {
+                return StepUnanchored (*this, time, friction, mass,
+                                       positions, forces, anchorMask,
+                                       0, Width * Height);
+            }
+
+            bool StepRange (double           time,
+                            double           friction,
+                            double           mass,
+                            MeshArray        &positions,
+                            MeshArray  const &forces,
+                            AnchorMask const &anchorMask,
+                            size_t           begin,
+                            size_t           end)
+            {
+                return StepUnanchored (*this, time, friction, mass,
+                                       positions, forces, anchorMask,
+                                       begin, end);
+            }
+
             MeshArray & Velocities ()
             {
                 return velocities;
             }
 
+            MeshArray const & Velocities () const
+            {
+                return velocities;
+            }
+
         private:
 
             MeshArray velocities;
     };
 
-    class SpringMesh
+    typedef BasicVerletIntegration <config::Width, config::Height>
+        VerletIntegration;
+
+    template <size_t Width, size_t Height>
+    class BasicSpringMesh
     {
         public:
 
-            SpringMesh (MeshArray    &array,
-                        Vector const &tileSize);
+            typedef BasicMeshArray <Width, Height> MeshArray;
+
+            /* Base springs and inserted anchor points are allocated
+             * from allocator, which must outlive the mesh */
+            BasicSpringMesh (MeshArray    &array,
+                             Vector const &tileSize,
+                             Allocator    &allocator = Allocator::Heap ());
 
             struct CalculationResult
             {
@@ -810,66 +1441,118 @@ namespace wobbly
             CalculationResult CalculateForces (double springConstant) const;
             void Scale (Vector const &scaleFactor);
 
-            class SpringVector
+            /* Computes the total force on each point in [begin, end) from
+             * the current positions, writing it to the forces array. This
+             * gives the same forces as CalculateForces, but only needs the
+             * points in range and their neighbours to be up to date.
+             *
+             * Returns true if any spring owned by a point in range exerted a
+             * force. Between them, calls for every point in the mesh and a
+             * call to DetachedForcesExist cover every spring once. If
+             * exerted is given, bit i - begin is set in it for each point i
+             * which owns such a spring, so no more than 64 points may be
+             * in range. */
+            bool GatherForces (size_t   begin,
+                               size_t   end,
+                               double   springConstant,
+                               uint64_t *exerted = nullptr) const;
+
+            /* Returns true if any spring not attached to the mesh at all,
+             * eg, between two inserted anchors, exerts a force */
+            bool DetachedForcesExist (double springConstant) const;
+
+            /* The energy stored in the springs, which the forces from
+             * CalculateForces are the negative gradient of. Each end of a
+             * spring is pulled by k / 2 of how far the spring is from its
+             * desired length, so this is k / 4 of that squared, summed. */
+            double PotentialEnergy (double springConstant) const;
+
+            MeshArray const & Forces () const
             {
-                public:
+                return mForces;
+            }
 
-                    SpringVector (std::vector <Spring> &&baseSprings) :
-                        mSprings (std::move (baseSprings))
-                    {
-                    }
+            /* Returns true if the springs are exactly those of the full
+             * grid in the order they were generated in, with nothing
+             * inserted, so that the mesh only differs from any other mesh
+             * of the same size in the lengths of its springs */
+            bool IsGrid () const;
+
+            /* Springs between two points on the mesh, addressed by their
+             * index in the mesh. Each spring is a column entry in the
+             * arrays below, with desired distances being stored as
+             * x, y pairs so that they can be read with PointView. */
+            struct IndexedSprings
+            {
+                typedef std::vector <size_t, AllocatorAdapter <size_t>> Indices;
+                typedef std::vector <double, AllocatorAdapter <double>> Values;
 
-                    template <typename Function>
-                    void Each (Function const &function)
-                    {
-                        for (auto &spring : mSprings)
-                            function (spring);
-                    }
+                explicit IndexedSprings (Allocator &allocator) :
+                    first (allocator),
+                    second (allocator),
+                    desired (allocator)
+                {
+                }
+
+                Indices first;
+                Indices second;
+                Values  desired;
+
+                size_t Count () const
+                {
+                    return first.size ();
+                }
+            };
+
+            class SpringVector
+            {
+                public:
 
-                    template <typename ConstFunction>
-                    void Each (ConstFunction const &function) const
+                    SpringVector (MeshArray const  &positions,
+                                  MeshArray        &forces,
+                                  IndexedSprings   &&baseSprings) :
+                        mPositions (positions),
+                        mForces (forces),
+                        mBase (std::move (baseSprings)),
+                        mIncidenceValid (false)
                     {
-                        for (auto const &spring : mSprings)
-                            function (spring);
                     }
 
-                    typedef std::function <bool (Spring const &)> Predicate;
-                    TemporaryOwner <Spring>
-                    TakeMatching (Predicate const &comparator)
-                    {
-                        auto it = std::find_if (std::begin (mSprings),
-                                                std::end (mSprings),
-                                                comparator);
+                    /* Accumulates force for every spring in the mesh onto
+                     * the forces array, returning true if any spring
+                     * exerted a force. */
+                    bool ApplyForces (double springConstant) const;
 
-                        if (it == mSprings.end ())
-                            throw std::logic_error ("Couldn't find matching "
-                                                    "spring");
+                    /* See SpringMesh::GatherForces */
+                    bool GatherForces (size_t   begin,
+                                       size_t   end,
+                                       double   springConstant,
+                                       uint64_t *exerted) const;
+                    bool DetachedForcesExist (double springConstant) const;
 
-                        Spring steal (std::move (*it));
-                        mSprings.erase (it);
+                    /* See SpringMesh::PotentialEnergy */
+                    double PotentialEnergy (double springConstant) const;
 
-                        auto const replacer = [this](Spring &&spring) {
-                            auto const idExists =
-                                [this, &spring](Spring::ID const &id) {
-                                    return spring.HasID (id);
-                                };
+                    /* See SpringMesh::IsGrid */
+                    bool IsGrid () const;
 
-                            auto exists =
-                                std::remove_if (std::begin (mPending),
-                                                std::end (mPending),
-                                                idExists);
+                    IndexedSprings const & Base () const
+                    {
+                        return mBase;
+                    }
 
-                            if (exists != mPending.end ())
-                                mPending.erase (exists);
-                            else
-                                mSprings.emplace_back (std::move (spring));
-                        };
+                    void Scale (Vector const &scaleFactor);
 
-                       TemporaryOwner <Spring> tmp (std::move (steal),
-                                                    replacer);
-                       return tmp;
-                    }
+                    /* Removes the spring whose first position is closest to
+                     * install (and of those, whose second position is
+                     * closest) from the mesh. The spring is returned to the
+                     * mesh when the owner goes away. */
+                    TemporaryOwner <Spring>
+                    TakeClosest (Point const &install);
 
+                    /* Inserts a spring attached to at least one inserted
+                     * anchor. These are kept in a small separate table
+                     * since their endpoints are not necessarily in the mesh */
                     TemporaryOwner <Spring::ID>
                     EmplaceAndTrack (PointView <double>       &&forceA,
                                      PointView <double>       &&forceB,
@@ -884,7 +1567,8 @@ namespace wobbly
                                                           std::move (posB),
                                                           distance);
 
-                        mSprings.emplace_back (std::move (package.spring));
+                        mAnchorSprings.emplace_back (std::move (package.spring));
+                        mIncidenceValid = false;
 
                         auto const remover = [this](Spring::ID &&id) {
                             auto const predicate =
@@ -893,14 +1577,16 @@ namespace wobbly
                                 };
 
                             auto exists =
-                                std::remove_if (std::begin (mSprings),
-                                                std::end (mSprings),
+                                std::remove_if (std::begin (mAnchorSprings),
+                                                std::end (mAnchorSprings),
                                                 predicate);
 
-                            if (exists == mSprings.end ())
+                            if (exists == mAnchorSprings.end ())
                                 mPending.emplace_back (std::move (id));
                             else
-                                mSprings.erase (exists);
+                                mAnchorSprings.erase (exists);
+
+                            mIncidenceValid = false;
                         };
 
                         TemporaryOwner <Spring::ID> tmp (std::move (package.id),
@@ -913,8 +1599,39 @@ namespace wobbly
                     SpringVector (SpringVector const &) = delete;
                     SpringVector & operator= (SpringVector const &) = delete;
 
-                    std::vector <Spring>     mSprings;
+                    TemporaryOwner <Spring> TakeBase (size_t index);
+                    TemporaryOwner <Spring> TakeAnchored (size_t index);
+
+                    /* For each mesh point, the springs which have it as an
+                     * endpoint in the order that ApplyForces would visit
+                     * them, so that a point's force can be summed up in the
+                     * same order without touching any other point.
+                     *
+                     * Entries are spring indices shifted left by one, with
+                     * the low bit set if the point is the second end.
+                     * Points are delimited by offsets, like a CSR matrix. */
+                    struct Incidence
+                    {
+                        std::vector <size_t> baseOffsets;
+                        std::vector <size_t> baseEntries;
+                        std::vector <size_t> anchorOffsets;
+                        std::vector <size_t> anchorEntries;
+
+                        /* Anchor springs without a mesh endpoint */
+                        std::vector <size_t> detached;
+                    };
+
+                    void BuildIncidence () const;
+
+                    MeshArray const &mPositions;
+                    MeshArray       &mForces;
+
+                    IndexedSprings           mBase;
+                    std::vector <Spring>     mAnchorSprings;
                     std::vector <Spring::ID> mPending;
+
+                    Incidence mutable        mIncidence;
+                    bool mutable             mIncidenceValid;
             };
             
 
@@ -994,11 +1711,11 @@ namespace wobbly
 
             struct InstallResult
             {
-                TemporaryOwner <Spring>               stolen;
-                TemporaryOwner <Spring::ID>           first;
-                TemporaryOwner <Spring::ID>           second;
-                std::unique_ptr <double[]>            data;
-                TemporaryOwner <AnchorDataVector::ID> anchor;
+                TemporaryOwner <Spring>                        stolen;
+                TemporaryOwner <Spring::ID>                    first;
+                TemporaryOwner <Spring::ID>                    second;
+                AllocatedArray <double>                        data;
+                TemporaryOwner <typename AnchorDataVector::ID> anchor;
             };
 
             InstallResult
@@ -1010,6 +1727,11 @@ namespace wobbly
             {
                 mInserted.MoveBy (delta);
             }
+
+            IndexedSprings const & BaseSprings () const
+            {
+                return mSprings.Base ();
+            }
             
             void ScaleInsertedAnchors (animation::Point  const &origin,
                                        animation::Vector const &scaleFactor)
@@ -1019,29 +1741,46 @@ namespace wobbly
 
         private:
 
-            SpringMesh (SpringMesh const &mesh) = delete;
-            SpringMesh & operator= (SpringMesh other) = delete;
+            BasicSpringMesh (BasicSpringMesh const &mesh) = delete;
+            BasicSpringMesh & operator= (BasicSpringMesh other) = delete;
 
             MeshArray mutable    mForces;
+            Allocator            &mAllocator;
             SpringVector         mSprings;
             AnchorDataVector     mInserted;
     };
 
-    template <typename IntegrationStrategy>
+    typedef BasicSpringMesh <config::Width, config::Height> SpringMesh;
+
+    template <typename IntegrationStrategy,
+              size_t   Width = config::Width,
+              size_t   Height = config::Height>
     class SpringStep
     {
         public:
 
+            typedef BasicMeshArray <Width, Height> MeshArray;
+            typedef BasicAnchorArray <Width, Height> AnchorArray;
+            typedef BasicSpringMesh <Width, Height> SpringMesh;
+            typedef BasicConstrainmentStep <Width, Height> ConstrainmentStep;
+
             SpringStep (IntegrationStrategy     &strategy,
                         MeshArray               &array,
                         double            const &constant,
                         double            const &friction,
-                        animation::Vector const &tileSize) :
+                        animation::Vector const &tileSize,
+                        Allocator               &allocator = Allocator::Heap ()) :
                 constant (constant),
                 friction (friction),
+                strategy (strategy),
                 integrator (strategy),
-                mesh (array, tileSize)
+                mesh (array, tileSize, allocator),
+                sleptConstant (constant),
+                sleptPoints (0),
+                sleptSprings (0)
             {
+                asleep.fill (0);
+                gathered.fill (0.0);
             }
 
             void Scale (Point  const &origin,
@@ -1049,12 +1788,15 @@ namespace wobbly
             {
                 mesh.Scale (scaleFactor);
                 mesh.ScaleInsertedAnchors (origin, scaleFactor);
+
+                /* Every spring has a new length to settle to */
+                asleep.fill (0);
             }
 
-            SpringMesh::InstallResult
-            InstallAnchorSprings (Point                     const &install,
-                                  SpringMesh::PosPreference const &first,
-                                  SpringMesh::PosPreference const &second)
+            typename SpringMesh::InstallResult
+            InstallAnchorSprings (Point                              const &install,
+                                  typename SpringMesh::PosPreference const &first,
+                                  typename SpringMesh::PosPreference const &second)
             {
                 return mesh.InstallAnchorSprings (install, first, second);
             }
@@ -1064,265 +1806,2158 @@ namespace wobbly
                 mesh.MoveInsertedAnchorsBy (delta);
             }
 
+            SpringMesh const & Mesh () const
+            {
+                return mesh;
+            }
+
+            /* Steps are one unit of time long unless told otherwise */
             bool operator () (MeshArray         &positions,
-                              AnchorArray const &anchors)
+                              AnchorArray const &anchors,
+                              double            time = 1.0)
             {
-                auto result = mesh.CalculateForces (constant);
+                return Integrate (integrator, positions, anchors, time);
+            }
 
-                bool more = result.forcesExist;
-                more |= integrator (positions,
-                                    result.forces,
-                                    anchors,
-                                    friction);
+            /* Integrates with strategy in place of the strategy this
+             * step was made with, for the same springs */
+            template <typename Strategy>
+            bool StepWith (Strategy          &strategy,
+                           MeshArray         &positions,
+                           AnchorArray const &anchors,
+                           double            time)
+            {
+                AnchoredIntegration <Strategy> anchored (strategy);
+                return Integrate (anchored, positions, anchors, time);
+            }
+
+            /* The two halves of StepWith, for deciding how to integrate
+             * from the forces before doing so */
+            typename SpringMesh::CalculationResult CalculateForces () const
+            {
+                return mesh.CalculateForces (constant);
+            }
+
+            template <typename Strategy>
+            bool IntegrateWith (Strategy          &strategy,
+                                MeshArray         &positions,
+                                MeshArray   const &forces,
+                                AnchorArray const &anchors,
+                                double            time)
+            {
+                AnchoredIntegration <Strategy> anchored (strategy);
+                return anchored (positions, forces, anchors, friction, time);
+            }
+
+            /* Performs constrainment, force calculation and integration
+             * in a single sweep over the rows of the mesh, giving the same
+             * result as running constrainment and then this step.
+             *
+             * Springs only join neighbouring rows, so the sweep lags each
+             * stage by one row: row r is constrained, then forces are
+             * gathered for row r - 1 (whose neighbours are now
+             * constrained) and then row r - 2 is integrated (whose forces
+             * are complete and which no remaining gather reads).
+             *
+             * A point left with no velocity, no force and no spring of its
+             * own exerting one stays where it is until it or a neighbour
+             * is moved, so it sleeps until then, its forces not being
+             * gathered and it not being integrated. Only meshes for which
+             * SpringMesh::IsGrid holds sleep, since inserted anchors move
+             * without their positions being in the mesh. */
+            bool operator () (MeshArray               &positions,
+                              AnchorArray       const &anchors,
+                              ConstrainmentStep const &constrainment)
+            {
+                size_t const width = Width;
+                size_t const height = Height;
+
+                MeshArray const *targets = constrainment.ActiveTargets ();
+                MeshArray const &forces = mesh.Forces ();
+
+                bool const sleeping = PrepareSleeping (anchors);
+                bool more = mesh.DetachedForcesExist (constant);
+
+                for (size_t row = 0; row < height + 2; ++row)
+                {
+                    if (targets && row < height)
+                        more |= constrainment.ConstrainRange (positions,
+                                                              *targets,
+                                                              row * width,
+                                                              (row + 1) * width);
+
+                    if (sleeping && row < height)
+                        NoteMoved (positions, row);
+
+                    if (row >= 1 && row - 1 < height)
+                        more |= sleeping ?
+                                GatherAwake (row - 1) :
+                                mesh.GatherForces ((row - 1) * width,
+                                                   row * width,
+                                                   constant);
+
+                    if (row >= 2 && sleeping)
+                    {
+                        more |= integrator.StepRange (positions,
+                                                      forces,
+                                                      skipped,
+                                                      friction,
+                                                      (row - 2) * width,
+                                                      (row - 1) * width);
+                        NoteAsleep (row - 2);
+                    }
+                    else if (row >= 2)
+                    {
+                        more |= integrator (positions,
+                                            forces,
+                                            anchors,
+                                            friction,
+                                            (row - 2) * width,
+                                            (row - 1) * width);
+                    }
+                }
 
                 return more;
             }
 
+            /* How many points and springs between them the last sweep
+             * skipped because they were asleep. Springs with only one end
+             * asleep are still evaluated from the other. */
+            size_t SleptPoints () const
+            {
+                return sleptPoints;
+            }
+
+            size_t SleptSprings () const
+            {
+                return sleptSprings;
+            }
+
         private:
 
-            SpringStep (IntegrationStrategy const &) = delete;
-            SpringStep <IntegrationStrategy> &
-            operator= (SpringStep <IntegrationStrategy> const &) = delete;
+            template <typename Strategy>
+            bool Integrate (AnchoredIntegration <Strategy> &anchored,
+                            MeshArray                      &positions,
+                            AnchorArray              const &anchors,
+                            double                         time)
+            {
+                auto result = mesh.CalculateForces (constant);
 
-            double const &constant;
-            double const &friction;
+                bool more = result.forcesExist;
+                more |= anchored (positions,
+                                  result.forces,
+                                  anchors,
+                                  friction,
+                                  time);
 
-            AnchoredIntegration <IntegrationStrategy> integrator;
-            SpringMesh                                mesh;
-    };
+                return more;
+            }
 
-    namespace euler
-    {
-        template <typename Velocity, typename Force>
-        void ApplyAccelerativeForce (Velocity &velocity,
-                                     Force    &force,
-                                     double   mass,
-                                     double   time)
-        {
-            namespace agd = animation::geometry::dimension;
+            /* Each row of the mesh as bits, column 0 lowest */
+            typedef std::array <uint64_t, Height> RowBits;
 
-            animation::Vector acceleration;
-            agd::assign (acceleration, force);
-            agd::scale (acceleration, 1.0 / mass);
+            static constexpr uint64_t FullRow =
+                Width < 64 ? (uint64_t (1) << Width) - 1 : ~uint64_t (0);
 
-            /* v[t] = v[t - 1] + at */
-            animation::Vector additionalVelocity (acceleration);
-            agd::scale (additionalVelocity, time);
-            agd::pointwise_add (velocity, additionalVelocity);
-        }
-    }
-}
+            /* Returns whether points may sleep during this sweep, waking
+             * all of them if the springs are not the ones they fell
+             * asleep with */
+            bool PrepareSleeping (AnchorArray const &anchors)
+            {
+                sleptPoints = 0;
+                sleptSprings = 0;
 
-inline bool
-wobbly::EulerIntegrate (double                              time,
-                        double                              friction,
-                        double                              mass,
-                        animation::PointView <double>       &&inposition,
-                        animation::PointView <double>       &&invelocity,
-                        animation::PointView <double const> &&inforce)
-{
-    namespace agd = animation::geometry::dimension;
+                bool const grid = mesh.IsGrid ();
 
-    assert (mass > 0.0f);
+                if (!grid || constant != sleptConstant)
+                {
+                    asleep.fill (0);
+                    sleptConstant = constant;
+                }
 
-    animation::PointView <double> position (std::move (inposition));
-    animation::PointView <double const> force (std::move (inforce));
-    animation::PointView <double> velocity (std::move (invelocity));
+                skipped = anchors.AnchorMask ();
 
-    /* Apply friction, which is exponentially
-     * proportional to both velocity and time */
-    animation::Vector totalForce;
-    agd::assign (totalForce, force);
+                return grid;
+            }
 
-    animation::Vector frictionForce;
-    agd::pointwise_add (frictionForce, velocity);
-    agd::scale (frictionForce, friction);
+            /* Notes which points in row have moved since their forces
+             * were last gathered, by anything at all. That only matters
+             * next to points which are asleep, and none of the rows
+             * around this one have been woken yet. */
+            void NoteMoved (MeshArray const &positions, size_t row)
+            {
+                size_t const begin = row * Width * 2;
+                uint64_t bits = 0;
 
-    agd::pointwise_subtract (totalForce, frictionForce);
+                uint64_t nearby = asleep[row];
+                if (row > 0)
+                    nearby |= asleep[row - 1];
+                if (row + 1 < Height)
+                    nearby |= asleep[row + 1];
 
-    /* First apply velocity change for force
-     * exerted over time */
-    euler::ApplyAccelerativeForce (velocity, totalForce, mass, time);
+                for (size_t column = 0; nearby && column < Width; ++column)
+                {
+                    size_t const i = begin + column * 2;
+                    bool const differs = (positions[i] != gathered[i]) |
+                                         (positions[i + 1] != gathered[i + 1]);
 
-    /* Clip velocity */
-    geometry::ResetIfCloseToZero (velocity, 0.1);
+                    bits |= uint64_t (differs) << column;
+                }
 
-    /* Distance travelled will be
-     *
-     *   d[t] = ((v[t - 1] + v[t]) / 2) * t
-     */
-    animation::Vector positionDelta;
-    agd::assign (positionDelta, velocity);
-    agd::scale (positionDelta, time / 2);
+                std::copy (positions.begin () + begin,
+                           positions.begin () + begin + Width * 2,
+                           gathered.begin () + begin);
 
-    agd::pointwise_add (position, positionDelta);
+                moved[row] = bits;
+            }
 
-    /* Return true if we still have velocity remaining */
-    bool result = std::fabs (agd::get <0> (velocity)) > 0.00 ||
-                  std::fabs (agd::get <1> (velocity)) > 0.00;
+            /* Gathers forces for the points in row which are awake or
+             * have been woken by something moving nearby, or by being
+             * given a velocity from outside the sweep, in runs */
+            bool GatherAwake (size_t row)
+            {
+                MeshArray const &velocities = strategy.Velocities ();
 
-    return result;
-}
+                uint64_t woken = moved[row] |
+                                 ((moved[row] << 1) & FullRow) |
+                                 (moved[row] >> 1);
 
+                if (row > 0)
+                    woken |= moved[row - 1];
+                if (row + 1 < Height)
+                    woken |= moved[row + 1];
 
-inline bool
-wobbly::EulerIntegration::Step (size_t          index,
-                                double          time,
-                                double          friction,
-                                double          mass,
-                                MeshArray       &positions,
-                                MeshArray const &forces)
-{
-    return EulerIntegrate (time,
-                           friction,
-                           mass,
-                           PointView <double> (positions, index),
-                           PointView <double> (velocities, index),
-                           PointView <double const> (forces, index));
-}
+                for (size_t column = 0; asleep[row] && column < Width; ++column)
+                {
+                    size_t const i = (row * Width + column) * 2;
+                    bool const moving = (velocities[i] != 0.0) |
+                                        (velocities[i + 1] != 0.0);
 
-inline void
-wobbly::EulerIntegration::Reset (size_t index)
-{
-    animation::PointView <double> velocity (velocities, index);
-    animation::geometry::dimension::assign_value (velocity, 0.0);
-}
+                    woken |= uint64_t (moving) << column;
+                }
 
-namespace wobbly
-{
-    namespace springs
-    {
-        template <typename P1, typename P2>
-        inline animation::Vector
-        DeltaFromDesired (P1                const &a,
-                          P2                const &b,
-                          animation::Vector const &desired)
-        {
-            namespace agd = animation::geometry::dimension;
+                uint64_t const sleeping = asleep[row] & ~woken;
 
-            animation::Vector delta (0.5 * (agd::get <0> (b) -
-                                            agd::get <0> (a) +
-                                            agd::get <0> (desired)),
-                                     0.5 * (agd::get <1> (b) -
-                                            agd::get <1> (a) +
-                                            agd::get <1> (desired)));
-            return delta;
-        }
-    }
-}
+                asleep[row] = sleeping;
+                sleptPoints += __builtin_popcountll (sleeping);
+                SetMaskBitsFrom (skipped, row * Width, sleeping);
 
-inline bool
-wobbly::Spring::ApplyForces (double springConstant) const
-{
-    namespace agd = animation::geometry::dimension;
+                exerting[row] = 0;
 
-    Vector desiredNegative (desiredDistance);
-    agd::scale (desiredNegative, -1);
+                bool more = false;
+                uint64_t awake = ~sleeping & FullRow;
 
-    Vector deltaA (springs::DeltaFromDesired (posA,
-                                              posB,
-                                              desiredNegative));
-    Vector deltaB (springs::DeltaFromDesired (posB,
-                                              posA,
-                                              desiredDistance));
+                while (awake)
+                {
+                    size_t const begin = __builtin_ctzll (awake);
+                    uint64_t const run = ~(awake >> begin);
+                    size_t const end = run ? begin + __builtin_ctzll (run) : Width;
+                    uint64_t exerted = 0;
 
-    geometry::ResetIfCloseToZero (deltaA, ClipThreshold);
-    geometry::ResetIfCloseToZero (deltaB, ClipThreshold);
+                    more |= mesh.GatherForces (row * Width + begin,
+                                               row * Width + end,
+                                               constant,
+                                               &exerted);
+                    exerting[row] |= exerted << begin;
 
-    Vector springForceA (deltaA);
-    Vector springForceB (deltaB);
+                    if (end == Width)
+                        break;
 
-    agd::scale (springForceA, springConstant);
-    agd::scale (springForceB, springConstant);
+                    awake &= ~uint64_t (0) << end;
+                }
 
-    agd::pointwise_add (forceA, springForceA);
-    agd::pointwise_add (forceB, springForceB);
+                return more;
+            }
 
-    /* Return true if a delta was applied at any point */
-    Vector delta (geometry::Absolute (deltaA));
-    agd::pointwise_add (delta, geometry::Absolute (deltaB));
+            /* Puts the points in row which have come to rest to sleep,
+             * once they have been integrated */
+            void NoteAsleep (size_t row)
+            {
+                MeshArray const &forces = mesh.Forces ();
+                MeshArray const &velocities = strategy.Velocities ();
 
-    bool result = agd::get <0> (delta) > 0.00 ||
-                  agd::get <1> (delta) > 0.00;
+                /* Only asleep points were skipped, and the row below has
+                 * already been gathered */
+                uint64_t const slept = asleep[row];
 
-    return result;
-}
+                sleptSprings += __builtin_popcountll (slept & (slept >> 1));
+                if (row + 1 < Height)
+                    sleptSprings += __builtin_popcountll (slept & asleep[row + 1]);
 
-inline wobbly::SpringMesh::CalculationResult
-wobbly::SpringMesh::CalculateForces (double springConstant) const
-{
-    bool more = false;
-    /* Reset all forces back to zero */
-    mForces.fill (0.0);
+                /* Whether points are at rest is all but random while
+                 * the mesh chatters, so it is worked out without
+                 * branching on it */
+                uint64_t rest = 0;
 
-    /* Accumulate force on each end of each spring. Some points are endpoints
-     * of multiple springs so these functions may cause a force to be updated
-     * multiple (different) times */
-    mSprings.Each ([&more, &springConstant](Spring const &spring) {
-        more |= spring.ApplyForces (springConstant);
-    });
+                for (size_t column = 0; column < Width; ++column)
+                {
+                    size_t const i = (row * Width + column) * 2;
+                    bool const still = (forces[i] == 0.0) &
+                                       (forces[i + 1] == 0.0) &
+                                       (velocities[i] == 0.0) &
+                                       (velocities[i + 1] == 0.0);
 
-    return {
-               more,
-               mForces
-           };
-}
+                    rest |= uint64_t (still) << column;
+                }
 
-inline animation::Point
-wobbly::BezierMesh::DeformUnitCoordsToMeshSpace (Point const &normalized) const
-{
-    namespace agd = ::animation::geometry::dimension;
+                asleep[row] |= rest & ~exerting[row];
+            }
 
-    double const u = agd::get <0> (normalized);
-    double const v = agd::get <1> (normalized);
+            SpringStep (IntegrationStrategy const &) = delete;
+            SpringStep & operator= (SpringStep const &) = delete;
 
-    /* Create a vector of coefficients like
-     * | (1 - u)^3      |
-     * | 3u * (1 - u)^2 |
-     * | 3u^2 * (1 - u) |
-     * | u^3            |
-     *
-     * We store some commonly used variables here so that we don't
-     * need to recalculate them over and over again
-     */
-    double const one_u = 1 - u;
-    double const one_v = 1 - v;
+            double const &constant;
+            double const &friction;
 
-    double const three_u = 3 * u;
-    double const three_v = 3 * v;
+            IntegrationStrategy                       &strategy;
+            AnchoredIntegration <IntegrationStrategy> integrator;
+            SpringMesh                                mesh;
 
-    double const u_pow2 = u * u;
-    double const v_pow2 = v * v;
-    double const one_u_pow2 = one_u * one_u;
-    double const one_v_pow2 = one_v * one_v;
+            /* Points at rest, and the positions of every point when its
+             * forces were last gathered, see the sweep above. asleep is
+             * kept between sweeps for the springs of sleptConstant, the
+             * rest only last for one. */
+            RowBits   asleep;
+            MeshArray gathered;
+            double    sleptConstant;
 
-    long double const uCoefficients[] =
-    {
-        one_u * one_u * one_u,
-        three_u * one_u_pow2,
-        3 * u_pow2 * one_u,
-        u_pow2 * u
+            RowBits                    moved;
+            RowBits                    exerting;
+            typename AnchorArray::Mask skipped;
+
+            size_t sleptPoints;
+            size_t sleptSprings;
     };
 
-    long double const vCoefficients[] =
+    /* The springs shared by every mesh of a given size for which
+     * SpringMesh::IsGrid holds, indexed for simd::StepLanes */
+    template <size_t Width, size_t Height>
+    class LaneTopology
     {
-        one_v * one_v * one_v,
-        three_v * one_v_pow2,
-        3 * v_pow2 * one_v,
-        v_pow2 * v
+        public:
+
+            typedef typename BasicSpringMesh <Width, Height>::IndexedSprings IndexedSprings;
+
+            explicit LaneTopology (IndexedSprings const &grid) :
+                mFirst (grid.first.begin (), grid.first.end ()),
+                mSecond (grid.second.begin (), grid.second.end ()),
+                mOffsets (Width * Height + 1, 0)
+            {
+                size_t const nSprings = grid.Count ();
+
+                for (size_t i = 0; i < nSprings; ++i)
+                {
+                    ++mOffsets[mFirst[i] + 1];
+                    ++mOffsets[mSecond[i] + 1];
+                }
+
+                for (size_t i = 0; i < Width * Height; ++i)
+                    mOffsets[i + 1] += mOffsets[i];
+
+                /* Filling in spring order keeps each point's entries in
+                 * spring order, as in SpringMesh::GatherForces */
+                std::vector <size_t> cursor (mOffsets.begin (), mOffsets.end () - 1);
+                mEntries.resize (mOffsets.back ());
+
+                for (size_t i = 0; i < nSprings; ++i)
+                {
+                    mEntries[cursor[mFirst[i]]++] = i << 1;
+                    mEntries[cursor[mSecond[i]]++] = (i << 1) | 1;
+                }
+            }
+
+            simd::LaneMesh Mesh () const
+            {
+                return {
+                    mFirst.data (),
+                    mSecond.data (),
+                    mOffsets.data (),
+                    mEntries.data (),
+                    Width * Height
+                };
+            }
+
+            size_t SpringCount () const
+            {
+                return mFirst.size ();
+            }
+
+        private:
+
+            std::vector <size_t> mFirst;
+            std::vector <size_t> mSecond;
+            std::vector <size_t> mOffsets;
+            std::vector <size_t> mEntries;
     };
 
+    /* The meshes of up to simd::Lanes models with the same topology,
+     * stored so that the same component of the same point in every
+     * model sits side by side. Stepping the batch then steps every model
+     * in it with one vector instruction per operation, which a single
+     * small mesh has too little data to do well.
+     *
+     * Each lane has its own spring lengths, anchors, spring constant and
+     * friction, and gives exactly the same result as a SpringStep would
+     * for that model without constrainment. */
+    template <size_t Width, size_t Height>
+    class LaneBatch
+    {
+        public:
+
+            typedef BasicMeshArray <Width, Height> MeshArray;
+            typedef typename BasicAnchorArray <Width, Height>::Mask AnchorMask;
+            typedef typename BasicSpringMesh <Width, Height>::IndexedSprings::Values Lengths;
+
+            static constexpr size_t Lanes = simd::Lanes;
+            static constexpr size_t Points = Width * Height;
+
+            /* Horizontal and vertical springs of the full grid */
+            static constexpr size_t Springs = (Width - 1) * Height +
+                                              Width * (Height - 1);
+
+            explicit LaneBatch (LaneTopology <Width, Height> const &topology) :
+                mTopology (topology),
+                mUsed (0)
+            {
+                assert (topology.SpringCount () == Springs);
+
+                /* Lanes which are never loaded still get stepped, so
+                 * they need to hold something which is not NaN */
+                mPositions.fill (0.0);
+                mVelocities.fill (0.0);
+                mDesired.fill (0.0);
+                mForces.fill (0.0);
+                mAnchored.fill (0);
+                mSpringConstant.fill (0.0);
+                mFriction.fill (0.0);
+            }
+
+            size_t Size () const
+            {
+                return mUsed;
+            }
+
+            bool Full () const
+            {
+                return mUsed == Lanes;
+            }
+
+            /* Lanes are reused from the first one, anything left in the
+             * others from before is stepped but ignored */
+            void Clear ()
+            {
+                mUsed = 0;
+            }
+
+            /* Copies a mesh into the next free lane, returning the lane */
+            size_t Load (MeshArray  const &positions,
+                         MeshArray  const &velocities,
+                         Lengths    const &desired,
+                         AnchorMask const &anchors,
+                         double           springConstant,
+                         double           friction)
+            {
+                assert (!Full ());
+                assert (desired.size () == Springs * 2);
+
+                size_t const lane = mUsed++;
+
+                for (size_t i = 0; i < Points * 2; ++i)
+                {
+                    mPositions[i * Lanes + lane] = positions[i];
+                    mVelocities[i * Lanes + lane] = velocities[i];
+                }
+
+                for (size_t i = 0; i < desired.size (); ++i)
+                    mDesired[i * Lanes + lane] = desired[i];
+
+                for (size_t i = 0; i < Points; ++i)
+                {
+                    bool const anchored = (anchors[i / 64] >> (i % 64)) & 1;
+                    mAnchored[i * Lanes + lane] = anchored ? ~uint64_t (0) : 0;
+                }
+
+                mSpringConstant[lane] = springConstant;
+                mFriction[lane] = friction;
+
+                return lane;
+            }
+
+            /* Copies the mesh in lane back out */
+            void Store (size_t    lane,
+                        MeshArray &positions,
+                        MeshArray &velocities) const
+            {
+                assert (lane < mUsed);
+
+                for (size_t i = 0; i < Points * 2; ++i)
+                {
+                    positions[i] = mPositions[i * Lanes + lane];
+                    velocities[i] = mVelocities[i * Lanes + lane];
+                }
+            }
+
+            /* Performs steps integration steps on every lane, as
+             * SpringStep would, returning a mask of the loaded lanes for
+             * which any step exerted force or left velocity */
+            unsigned int Step (unsigned int steps, double mass)
+            {
+                simd::LaneMesh const mesh (mTopology.Mesh ());
+                simd::LaneState const state = {
+                    mPositions.data (),
+                    mVelocities.data (),
+                    mForces.data (),
+                    mDesired.data (),
+                    mAnchored.data (),
+                    mSpringConstant.data (),
+                    mFriction.data ()
+                };
+
+                unsigned int more = 0;
+
+                for (unsigned int i = 0; i < steps; ++i)
+                    more |= simd::StepLanes (mesh, state, 1.0, mass);
+
+                return more & ((1u << mUsed) - 1);
+            }
+
+        private:
+
+            LaneTopology <Width, Height> const &mTopology;
+
+            std::array <double, Points * 2 * Lanes>  mPositions;
+            std::array <double, Points * 2 * Lanes>  mVelocities;
+            std::array <double, Points * 2 * Lanes>  mForces;
+            std::array <uint64_t, Points * Lanes>    mAnchored;
+            std::array <double, Springs * 2 * Lanes> mDesired;
+            std::array <double, Lanes>               mSpringConstant;
+            std::array <double, Lanes>               mFriction;
+            size_t                                   mUsed;
+    };
+
+    namespace cholesky
+    {
+        /* Replaces the lower triangle of the symmetric positive definite
+         * n by n matrix, stored row major with rows stride apart, with
+         * its Cholesky factor L, such that L L^T is the matrix */
+        inline void
+        Factorize (double *matrix, size_t n, size_t stride)
+        {
+            for (size_t j = 0; j < n; ++j)
+            {
+                double diagonal = matrix[j * stride + j];
+                for (size_t k = 0; k < j; ++k)
+                    diagonal -= matrix[j * stride + k] * matrix[j * stride + k];
+
+                assert (diagonal > 0.0);
+                matrix[j * stride + j] = std::sqrt (diagonal);
+
+                for (size_t i = j + 1; i < n; ++i)
+                {
+                    double sum = matrix[i * stride + j];
+                    for (size_t k = 0; k < j; ++k)
+                        sum -= matrix[i * stride + k] * matrix[j * stride + k];
+
+                    matrix[i * stride + j] = sum / matrix[j * stride + j];
+                }
+            }
+        }
+
+        /* Solves L L^T x = b in place, where factor holds L as
+         * written by Factorize */
+        inline void
+        Solve (double const *factor, size_t n, size_t stride, double *b)
+        {
+            /* Forward substitution, L y = b */
+            for (size_t i = 0; i < n; ++i)
+            {
+                for (size_t k = 0; k < i; ++k)
+                    b[i] -= factor[i * stride + k] * b[k];
+
+                b[i] /= factor[i * stride + i];
+            }
+
+            /* Back substitution, L^T x = y */
+            for (size_t i = n; i-- > 0;)
+            {
+                for (size_t k = i + 1; k < n; ++k)
+                    b[i] -= factor[k * stride + i] * b[k];
+
+                b[i] /= factor[i * stride + i];
+            }
+        }
+    }
+
+    /* Computes where a mesh joined by its base springs will come to
+     * rest, without integrating it until it does.
+     *
+     * With at least one anchor, the rest state is where no unanchored
+     * point has any force on it. Springs are linear, so that is the
+     * solution of L x = r, where L is the graph Laplacian of the mesh
+     * restricted to the unanchored points and r holds the desired
+     * spring lengths and the anchored positions. L only depends on
+     * which points are anchored, so its Cholesky factorization is kept
+     * until that changes. The factor is N by N, so it is only
+     * allocated once a mesh is first solved with anchors.
+     *
+     * Without anchors, the springs cancel out and the mesh settles into
+     * its rest shape around its centroid, which keeps drifting while
+     * friction takes away its momentum. */
+    template <size_t Width, size_t Height>
+    class EquilibriumSolver
+    {
+        public:
+
+            typedef BasicMeshArray <Width, Height> MeshArray;
+            typedef BasicAnchorArray <Width, Height> AnchorArray;
+            typedef typename AnchorArray::Mask AnchorMask;
+
+            explicit EquilibriumSolver (Allocator &allocator = Allocator::Heap ()) :
+                mFactorized (false),
+                mNFree (0),
+                mFactor (allocator),
+                mSoftest (0.0)
+            {
+                mMask.fill (0);
+            }
+
+            /* Writes the rest position of each point into settled,
+             * given the positions and velocities of the mesh now, for
+             * an integration time step of time */
+            void Solve (MeshArray         const &positions,
+                        MeshArray         const &velocities,
+                        AnchorArray       const &anchors,
+                        animation::Vector const &tileSize,
+                        double                  friction,
+                        double                  mass,
+                        double                  time,
+                        MeshArray               &settled)
+            {
+                AnchorMask const &mask (anchors.AnchorMask ());
+
+                bool const anyAnchored =
+                    std::any_of (mask.begin (), mask.end (),
+                                 [](uint64_t word) { return word != 0; });
+
+                if (!anyAnchored)
+                {
+                    SolveFree (positions,
+                               velocities,
+                               tileSize,
+                               friction,
+                               mass,
+                               time,
+                               settled);
+                    return;
+                }
+
+                if (!mFactorized || mask != mMask)
+                    Factorize (mask);
+
+                SolveAnchored (positions, tileSize, settled);
+            }
+
+            /* The least eigenvalue of L with the anchored points held
+             * where they are, or without anchors, the least one that
+             * deforms the mesh rather than moving all of it. Its mode
+             * is the softest to push the mesh into, see SettleSteps. */
+            double SoftestMode (AnchorArray const &anchors)
+            {
+                AnchorMask const &mask (anchors.AnchorMask ());
+
+                bool const anyAnchored =
+                    std::any_of (mask.begin (), mask.end (),
+                                 [](uint64_t word) { return word != 0; });
+
+                /* Eigenvalues of the grid are sums of those of its rows
+                 * and columns, 2 - 2 cos (pi j / n) for a path of n */
+                if (!anyAnchored)
+                    return 2.0 - 2.0 * std::cos (M_PI / std::max (Width, Height));
+
+                if (!mFactorized || mask != mMask)
+                    Factorize (mask);
+
+                if (!mSoftest)
+                    mSoftest = InverseIteration ();
+
+                return mSoftest;
+            }
+
+        private:
+
+            static constexpr size_t N = Width * Height;
+
+            /* Repeatedly solving with L from a positive vector converges
+             * on the mode of its least eigenvalue, which is positive
+             * everywhere. Each solve scales that mode up by one over the
+             * eigenvalue and the rest by less. */
+            double InverseIteration () const
+            {
+                std::array <double, N> mode;
+                std::fill (mode.begin (), mode.begin () + mNFree, 1.0);
+
+                double growth = 1.0;
+
+                for (size_t iteration = 0; iteration < 32; ++iteration)
+                {
+                    cholesky::Solve (mFactor.data (), mNFree, N, mode.data ());
+
+                    double squared = 0.0;
+                    for (size_t r = 0; r < mNFree; ++r)
+                        squared += mode[r] * mode[r];
+
+                    growth = std::sqrt (squared);
+
+                    for (size_t r = 0; r < mNFree; ++r)
+                        mode[r] /= growth;
+                }
+
+                return 1.0 / growth;
+            }
+
+            bool Anchored (size_t index) const
+            {
+                return mMask[index / 64] & (uint64_t (1) << (index % 64));
+            }
+
+            void Factorize (AnchorMask const &mask)
+            {
+                mMask = mask;
+                mNFree = 0;
+                mRow.fill (N);
+
+                for (size_t i = 0; i < N; ++i)
+                    if (!Anchored (i))
+                    {
+                        mRow[i] = mNFree;
+                        mFree[mNFree++] = i;
+                    }
+
+                /* Build the restricted Laplacian. Each point has one
+                 * spring to each of its neighbours */
+                mFactor.assign (N * N, 0.0);
+
+                for (size_t r = 0; r < mNFree; ++r)
+                {
+                    auto const join = [this, r](size_t neighbour, int, int) {
+                        mFactor[r * N + r] += 1.0;
+
+                        if (mRow[neighbour] != N)
+                            mFactor[r * N + mRow[neighbour]] -= 1.0;
+                    };
+
+                    mesh::ForEachNeighbour <Width, Height> (mFree[r], join);
+                }
+
+                /* Every free point is connected to an anchor through
+                 * the mesh, so the matrix is positive definite */
+                cholesky::Factorize (mFactor.data (), mNFree, N);
+
+                mFactorized = true;
+                mSoftest = 0.0;
+            }
+
+            void SolveAnchored (MeshArray         const &positions,
+                                animation::Vector const &tileSize,
+                                MeshArray               &settled)
+            {
+                namespace agd = animation::geometry::dimension;
+
+                std::array <double, N> solution;
+                double const tile[2] = {
+                    agd::get <0> (tileSize),
+                    agd::get <1> (tileSize)
+                };
+
+                for (size_t d = 0; d < 2; ++d)
+                {
+                    /* The force on a free point is the sum over its
+                     * springs of neighbour - point - desired, so at rest
+                     * degree * point - sum of free neighbours is the sum
+                     * of anchored neighbours less desired lengths */
+                    for (size_t r = 0; r < mNFree; ++r)
+                    {
+                        double rhs = 0.0;
+
+                        auto const accumulate = [&](size_t neighbour,
+                                                    int    across,
+                                                    int    down) {
+                            rhs -= (d ? down : across) * tile[d];
+
+                            if (mRow[neighbour] == N)
+                                rhs += positions[neighbour * 2 + d];
+                        };
+
+                        mesh::ForEachNeighbour <Width, Height> (mFree[r], accumulate);
+
+                        solution[r] = rhs;
+                    }
+
+                    cholesky::Solve (mFactor.data (), mNFree, N,
+                                     solution.data ());
+
+                    for (size_t i = 0; i < N; ++i)
+                        settled[i * 2 + d] = mRow[i] == N ?
+                                             positions[i * 2 + d] :
+                                             solution[mRow[i]];
+                }
+            }
+
+            static void SolveFree (MeshArray         const &positions,
+                                   MeshArray         const &velocities,
+                                   animation::Vector const &tileSize,
+                                   double                  friction,
+                                   double                  mass,
+                                   double                  time,
+                                   MeshArray               &settled)
+            {
+                namespace agd = animation::geometry::dimension;
+
+                assert (friction > 0.0);
+
+                /* Spring forces are equal and opposite, so the mean
+                 * velocity only decays with friction, by q each step.
+                 * Each step moves points by half of their velocity
+                 * after the step, so the centroid travels
+                 *
+                 *   (time / 2) * v * (q + q^2 + ...)
+                 *     = (time / 2) * v * q / (1 - q)
+                 */
+                double const decay = 1.0 - friction * time / mass;
+                double const travel = (time / 2) * decay / (1.0 - decay);
+
+                double centroid[2] = { 0.0, 0.0 };
+
+                for (size_t i = 0; i < N; ++i)
+                {
+                    for (size_t d = 0; d < 2; ++d)
+                        centroid[d] += positions[i * 2 + d] +
+                                       velocities[i * 2 + d] * travel;
+                }
+
+                /* The rest shape is the evenly spaced grid, centred
+                 * on the point where the centroid stops */
+                animation::Point topLeft (centroid[0] / N -
+                                          agd::get <0> (tileSize) * (Width - 1) / 2,
+                                          centroid[1] / N -
+                                          agd::get <1> (tileSize) * (Height - 1) / 2);
+
+                mesh::CalculatePositionArray <Width, Height> (topLeft,
+                                                              settled,
+                                                              tileSize);
+            }
+
+            AnchorMask mMask;
+            bool       mFactorized;
+
+            /* Mesh index of each free point and the row of each
+             * mesh point in the system, or N if anchored */
+            std::array <size_t, N> mFree;
+            std::array <size_t, N> mRow;
+            size_t                 mNFree;
+
+            /* Lower triangular factor, row major, empty until the
+             * first factorization */
+            std::vector <double, AllocatorAdapter <double>> mFactor;
+
+            /* See SoftestMode, or 0 until it is needed */
+            double mSoftest;
+    };
+
+    /* Backward (implicit) Euler, which takes the spring forces at the
+     * end of the step rather than at the start, so that it stays stable
+     * however long the step is. Long steps take energy out of the mesh
+     * faster than short ones would, which is fine for catching up.
+     *
+     * Spring forces are linear in the positions, changing by
+     * -(k / 2) L dx for a change dx, where L is the graph Laplacian of
+     * the grid. Points move by half of their new velocity over the
+     * step, as with EulerIntegrate, so the new velocity solves
+     *
+     *   ((1 + friction t / m) I + (k t^2 / 4m) L) v[t] = v[t - 1] + f t / m
+     *
+     * restricted to the unanchored points, anchored points having no
+     * velocity. The matrix is positive definite whatever the step, and
+     * its Cholesky factorization is kept until the anchors, the step or
+     * the constants change. Catching up is rare, so the N by N factor is
+     * only allocated the first time it happens. Springs to inserted
+     * anchors only come in through f, so they are stepped explicitly.
+     *
+     * The solve couples every point, so there is no Step for a single
+     * point or StepRange for the fused sweep in SpringStep. */
+    template <size_t Width, size_t Height>
+    class BasicImplicitEulerIntegration
+    {
+        public:
+
+            typedef BasicMeshArray <Width, Height> MeshArray;
+            typedef BasicAnchorArray <Width, Height> AnchorArray;
+            typedef typename AnchorArray::Mask AnchorMask;
+
+            /* springConstant must outlive the integrator */
+            explicit BasicImplicitEulerIntegration (double const &springConstant,
+                                                    Allocator    &allocator = Allocator::Heap ()) :
+                mSpringConstant (springConstant),
+                mFactorized (false),
+                mTime (0.0),
+                mFriction (0.0),
+                mMass (0.0),
+                mFactoredConstant (0.0),
+                mNFree (0),
+                mFactor (allocator)
+            {
+                mVelocities.fill (0.0);
+                mMask.fill (0);
+            }
+
+            void Reset (size_t i)
+            {
+                mVelocities[i * 2] = 0.0;
+                mVelocities[i * 2 + 1] = 0.0;
+            }
+
+            bool StepAll (double           time,
+                          double           friction,
+                          double           mass,
+                          MeshArray        &positions,
+                          MeshArray  const &forces,
+                          AnchorMask const &anchorMask);
+
+            MeshArray & Velocities ()
+            {
+                return mVelocities;
+            }
+
+            MeshArray const & Velocities () const
+            {
+                return mVelocities;
+            }
+
+        private:
+
+            static constexpr size_t N = Width * Height;
+
+            bool Anchored (size_t index) const
+            {
+                return mMask[index / 64] & (uint64_t (1) << (index % 64));
+            }
+
+            void Factorize (double           time,
+                            double           friction,
+                            double           mass,
+                            AnchorMask const &anchorMask);
+
+            double const &mSpringConstant;
+            MeshArray    mVelocities;
+
+            /* What the factorization was made for */
+            AnchorMask mMask;
+            bool       mFactorized;
+            double     mTime;
+            double     mFriction;
+            double     mMass;
+            double     mFactoredConstant;
+
+            /* Mesh index of each free point and the row of each
+             * mesh point in the system, or N if anchored */
+            std::array <size_t, N> mFree;
+            std::array <size_t, N> mRow;
+            size_t                 mNFree;
+
+            /* Lower triangular factor, row major, empty until the
+             * first factorization */
+            std::vector <double, AllocatorAdapter <double>> mFactor;
+    };
+
+    typedef BasicImplicitEulerIntegration <config::Width, config::Height>
+        ImplicitEulerIntegration;
+
+    /* Hands values from one writer thread to one reader thread without
+     * either ever waiting on the other.
+     *
+     * The writer fills in Back and then publishes it, swapping it with
+     * the middle slot. The reader swaps the middle slot into Front
+     * whenever something newer was published, so Front stays the same
+     * until it next asks for it, and the writer always has a slot of its
+     * own to fill. */
+    template <typename T>
+    class TripleBuffer
+    {
+        public:
+
+            explicit TripleBuffer (T const &initial) :
+                mSlots {{ initial, initial, initial }},
+                mBack (0),
+                mMiddle (1),
+                mFront (2)
+            {
+            }
+
+            T & Back ()
+            {
+                return mSlots[mBack];
+            }
+
+            void Publish ()
+            {
+                mBack = mMiddle.exchange (mBack | Fresh,
+                                          std::memory_order_acq_rel) & Slot;
+            }
+
+            /* The most recently published value */
+            T const & Front ()
+            {
+                if (mMiddle.load (std::memory_order_relaxed) & Fresh)
+                    mFront = mMiddle.exchange (mFront,
+                                               std::memory_order_acq_rel) & Slot;
+
+                return mSlots[mFront];
+            }
+
+        private:
+
+            /* The middle slot index, with Fresh set while the reader has
+             * not yet taken it */
+            static constexpr unsigned int Slot = 3;
+            static constexpr unsigned int Fresh = 4;
+
+            std::array <T, 3> mSlots;
+
+            /* Only touched by the writer */
+            unsigned int mBack;
+
+            std::atomic <unsigned int> mMiddle;
+
+            /* Only touched by the reader */
+            unsigned int mFront;
+    };
+
+    /* An anchor whose MoveBy can be called from one other thread, the
+     * movement only being applied to the mesh when the thread stepping
+     * the model calls Apply.
+     *
+     * Rather than queueing each move, which would mean either waiting
+     * or dropping moves once the queue is full, MoveBy publishes the sum
+     * of every move so far. Apply then moves the anchor by however much
+     * that sum changed since it was last applied, so no move is ever
+     * lost however many arrive between steps. Pointer motion comes in
+     * whole or fixed point pixels, which sum exactly. */
+    class QueuedAnchor :
+        public Anchor::MovableAnchor
+    {
+        public:
+
+            /* The anchors of one model, all of which are applied at the
+             * start of each step */
+            typedef std::vector <QueuedAnchor *> Registry;
+
+            QueuedAnchor (Anchor &&anchor, Registry &registry);
+            ~QueuedAnchor () override;
+
+            void MoveBy (Vector const &delta) noexcept override;
+            void Apply ();
+
+        private:
+
+            QueuedAnchor (QueuedAnchor const &) = delete;
+            QueuedAnchor & operator= (QueuedAnchor const &) = delete;
+
+            Anchor   anchor;
+            Registry &registry;
+
+            TripleBuffer <Vector> sent;
+
+            /* Only touched by the thread calling MoveBy */
+            Vector sentTotal;
+
+            /* Only touched by the thread stepping the model */
+            Vector appliedTotal;
+    };
+
+    namespace euler
+    {
+        template <typename Velocity, typename Force>
+        void ApplyAccelerativeForce (Velocity &velocity,
+                                     Force    &force,
+                                     double   mass,
+                                     double   time)
+        {
+            namespace agd = animation::geometry::dimension;
+
+            animation::Vector acceleration;
+            agd::assign (acceleration, force);
+            agd::scale (acceleration, 1.0 / mass);
+
+            /* v[t] = v[t - 1] + at */
+            animation::Vector additionalVelocity (acceleration);
+            agd::scale (additionalVelocity, time);
+            agd::pointwise_add (velocity, additionalVelocity);
+        }
+    }
+}
+
+inline bool
+wobbly::EulerIntegrate (double                              time,
+                        double                              friction,
+                        double                              mass,
+                        animation::PointView <double>       &&inposition,
+                        animation::PointView <double>       &&invelocity,
+                        animation::PointView <double const> &&inforce)
+{
+    namespace agd = animation::geometry::dimension;
+
+    assert (mass > 0.0f);
+
+    animation::PointView <double> position (std::move (inposition));
+    animation::PointView <double const> force (std::move (inforce));
+    animation::PointView <double> velocity (std::move (invelocity));
+
+    /* Apply friction, which is exponentially
+     * proportional to both velocity and time */
+    animation::Vector totalForce;
+    agd::assign (totalForce, force);
+
+    animation::Vector frictionForce;
+    agd::pointwise_add (frictionForce, velocity);
+    agd::scale (frictionForce, friction);
+
+    agd::pointwise_subtract (totalForce, frictionForce);
+
+    /* First apply velocity change for force
+     * exerted over time */
+    euler::ApplyAccelerativeForce (velocity, totalForce, mass, time);
+
+    /* Clip velocity */
+    geometry::ResetIfCloseToZero (velocity, Spring::VelocityThreshold);
+
+    /* Distance travelled will be
+     *
+     *   d[t] = ((v[t - 1] + v[t]) / 2) * t
+     */
+    animation::Vector positionDelta;
+    agd::assign (positionDelta, velocity);
+    agd::scale (positionDelta, time / 2);
+
+    agd::pointwise_add (position, positionDelta);
+
+    /* Return true if we still have velocity remaining */
+    bool result = std::fabs (agd::get <0> (velocity)) > 0.00 ||
+                  std::fabs (agd::get <1> (velocity)) > 0.00;
+
+    return result;
+}
+
+
+template <size_t Width, size_t Height>
+inline bool
+wobbly::BasicEulerIntegration <Width, Height>::Step (size_t          index,
+                                                     double          time,
+                                                     double          friction,
+                                                     double          mass,
+                                                     MeshArray       &positions,
+                                                     MeshArray const &forces)
+{
+    return EulerIntegrate (time,
+                           friction,
+                           mass,
+                           PointView <double> (positions, index),
+                           PointView <double> (velocities, index),
+                           PointView <double const> (forces, index));
+}
+
+template <size_t Width, size_t Height>
+inline bool
+wobbly::BasicEulerIntegration <Width, Height>::StepAll (double           time,
+                                                        double           friction,
+                                                        double           mass,
+                                                        MeshArray        &positions,
+                                                        MeshArray  const &forces,
+                                                        AnchorMask const &anchorMask)
+{
+    assert (mass > 0.0f);
+
+    return simd::IntegrateEuler (time,
+                                 friction,
+                                 mass,
+                                 positions.data (),
+                                 velocities.data (),
+                                 forces.data (),
+                                 anchorMask.data (),
+                                 Width * Height);
+}
+
+template <size_t Width, size_t Height>
+inline bool
+wobbly::BasicEulerIntegration <Width, Height>::StepRange (double           time,
+                                                          double           friction,
+                                                          double           mass,
+                                                          MeshArray        &positions,
+                                                          MeshArray  const &forces,
+                                                          AnchorMask const &anchorMask,
+                                                          size_t           begin,
+                                                          size_t           end)
+{
+    assert (mass > 0.0f);
+    assert (end - begin <= 64);
+
+    uint64_t const rangeMask = MaskBitsFrom (anchorMask, begin);
+
+    return simd::IntegrateEuler (time,
+                                 friction,
+                                 mass,
+                                 positions.data () + begin * 2,
+                                 velocities.data () + begin * 2,
+                                 forces.data () + begin * 2,
+                                 &rangeMask,
+                                 end - begin);
+}
+
+template <size_t Width, size_t Height>
+inline void
+wobbly::BasicEulerIntegration <Width, Height>::Reset (size_t index)
+{
+    animation::PointView <double> velocity (velocities, index);
+    animation::geometry::dimension::assign_value (velocity, 0.0);
+}
+
+template <typename Strategy, typename MeshArray, typename AnchorMask>
+inline bool
+wobbly::StepUnanchored (Strategy         &strategy,
+                        double           time,
+                        double           friction,
+                        double           mass,
+                        MeshArray        &positions,
+                        MeshArray  const &forces,
+                        AnchorMask const &anchorMask,
+                        size_t           begin,
+                        size_t           end)
+{
+    bool more = false;
+
+    for (size_t i = begin; i < end; ++i)
+    {
+        if (anchorMask[i / 64] & (uint64_t (1) << (i % 64)))
+            strategy.Reset (i);
+        else
+            more |= strategy.Step (i, time, friction, mass, positions, forces);
+    }
+
+    return more;
+}
+
+inline bool
+wobbly::SymplecticEulerIntegrate (double                              time,
+                                  double                              friction,
+                                  double                              mass,
+                                  animation::PointView <double>       &&inposition,
+                                  animation::PointView <double>       &&invelocity,
+                                  animation::PointView <double const> &&inforce)
+{
+    namespace agd = animation::geometry::dimension;
+
+    assert (mass > 0.0f);
+
+    animation::PointView <double> position (std::move (inposition));
+    animation::PointView <double const> force (std::move (inforce));
+    animation::PointView <double> velocity (std::move (invelocity));
+
+    /* v[t] = v[t - 1] + (f - friction * v[t]) * t / m, solved
+     * for v[t] */
+    euler::ApplyAccelerativeForce (velocity, force, mass, time);
+    agd::scale (velocity, 1.0 / (1.0 + friction * time / mass));
+
+    geometry::ResetIfCloseToZero (velocity, Spring::VelocityThreshold);
+
+    animation::Vector positionDelta;
+    agd::assign (positionDelta, velocity);
+    agd::scale (positionDelta, time / 2);
+
+    agd::pointwise_add (position, positionDelta);
+
+    return std::fabs (agd::get <0> (velocity)) > 0.00 ||
+           std::fabs (agd::get <1> (velocity)) > 0.00;
+}
+
+template <size_t Width, size_t Height>
+inline bool
+wobbly::BasicSymplecticEulerIntegration <Width, Height>::Step (size_t          index,
+                                                               double          time,
+                                                               double          friction,
+                                                               double          mass,
+                                                               MeshArray       &positions,
+                                                               MeshArray const &forces)
+{
+    return SymplecticEulerIntegrate (time,
+                                     friction,
+                                     mass,
+                                     PointView <double> (positions, index),
+                                     PointView <double> (velocities, index),
+                                     PointView <double const> (forces, index));
+}
+
+template <size_t Width, size_t Height>
+inline void
+wobbly::BasicSymplecticEulerIntegration <Width, Height>::Reset (size_t index)
+{
+    animation::PointView <double> velocity (velocities, index);
+    animation::geometry::dimension::assign_value (velocity, 0.0);
+}
+
+inline bool
+wobbly::VerletIntegrate (double                              time,
+                         double                              friction,
+                         double                              mass,
+                         animation::PointView <double>       &&inposition,
+                         animation::PointView <double>       &&invelocity,
+                         animation::PointView <double const> &&inforce)
+{
+    namespace agd = animation::geometry::dimension;
+
+    assert (mass > 0.0f);
+
+    animation::PointView <double> position (std::move (inposition));
+    animation::PointView <double const> force (std::move (inforce));
+    animation::PointView <double> velocity (std::move (invelocity));
+
+    /* With points moving at half of their velocity,
+     *
+     *   x[t + 1] - 2x[t] + x[t - 1] = (f - friction * v[t]) * t^2 / 2m
+     *
+     * where v[t] = (x[t + 1] - x[t - 1]) / t is the average of the
+     * velocities over the steps either side. Solved for the velocity
+     * over the next step, v[t + 1/2] = 2 (x[t + 1] - x[t]) / t, that is
+     *
+     *   v[t + 1/2] = ((1 - h) v[t - 1/2] + ft / m) / (1 + h)
+     *
+     * where h = friction * t / 2m */
+    double const damping = friction * time / (2.0 * mass);
+
+    agd::scale (velocity, 1.0 - damping);
+    euler::ApplyAccelerativeForce (velocity, force, mass, time);
+    agd::scale (velocity, 1.0 / (1.0 + damping));
+
+    geometry::ResetIfCloseToZero (velocity, Spring::VelocityThreshold);
+
+    animation::Vector positionDelta;
+    agd::assign (positionDelta, velocity);
+    agd::scale (positionDelta, time / 2);
+
+    agd::pointwise_add (position, positionDelta);
+
+    return std::fabs (agd::get <0> (velocity)) > 0.00 ||
+           std::fabs (agd::get <1> (velocity)) > 0.00;
+}
+
+template <size_t Width, size_t Height>
+inline bool
+wobbly::BasicVerletIntegration <Width, Height>::Step (size_t          index,
+                                                      double          time,
+                                                      double          friction,
+                                                      double          mass,
+                                                      MeshArray       &positions,
+                                                      MeshArray const &forces)
+{
+    return VerletIntegrate (time,
+                            friction,
+                            mass,
+                            PointView <double> (positions, index),
+                            PointView <double> (velocities, index),
+                            PointView <double const> (forces, index));
+}
+
+template <size_t Width, size_t Height>
+inline void
+wobbly::BasicVerletIntegration <Width, Height>::Reset (size_t index)
+{
+    animation::PointView <double> velocity (velocities, index);
+    animation::geometry::dimension::assign_value (velocity, 0.0);
+}
+
+template <size_t Width, size_t Height>
+inline void
+wobbly::BasicImplicitEulerIntegration <Width, Height>::Factorize (double           time,
+                                                                  double           friction,
+                                                                  double           mass,
+                                                                  AnchorMask const &anchorMask)
+{
+    mMask = anchorMask;
+    mTime = time;
+    mFriction = friction;
+    mMass = mass;
+    mFactoredConstant = mSpringConstant;
+
+    mNFree = 0;
+    mRow.fill (N);
+
+    for (size_t i = 0; i < N; ++i)
+        if (!Anchored (i))
+        {
+            mRow[i] = mNFree;
+            mFree[mNFree++] = i;
+        }
+
+    double const diagonal = 1.0 + friction * time / mass;
+    double const coupling = mSpringConstant * time * time / (4.0 * mass);
+
+    mFactor.assign (N * N, 0.0);
+
+    for (size_t r = 0; r < mNFree; ++r)
+    {
+        mFactor[r * N + r] = diagonal;
+
+        auto const join = [this, r, coupling](size_t neighbour, int, int) {
+            mFactor[r * N + r] += coupling;
+
+            if (mRow[neighbour] != N)
+                mFactor[r * N + mRow[neighbour]] -= coupling;
+        };
+
+        mesh::ForEachNeighbour <Width, Height> (mFree[r], join);
+    }
+
+    cholesky::Factorize (mFactor.data (), mNFree, N);
+
+    mFactorized = true;
+}
+
+template <size_t Width, size_t Height>
+inline bool
+wobbly::BasicImplicitEulerIntegration <Width, Height>::StepAll (double           time,
+                                                                double           friction,
+                                                                double           mass,
+                                                                MeshArray        &positions,
+                                                                MeshArray  const &forces,
+                                                                AnchorMask const &anchorMask)
+{
+    namespace agd = animation::geometry::dimension;
+
+    assert (mass > 0.0f);
+
+    if (!mFactorized ||
+        anchorMask != mMask ||
+        time != mTime ||
+        friction != mFriction ||
+        mass != mMass ||
+        mSpringConstant != mFactoredConstant)
+        Factorize (time, friction, mass, anchorMask);
+
+    std::array <double, N> solution;
+
+    for (size_t d = 0; d < 2; ++d)
+    {
+        for (size_t r = 0; r < mNFree; ++r)
+        {
+            size_t const i = mFree[r];
+            solution[r] = mVelocities[i * 2 + d] + forces[i * 2 + d] * time / mass;
+        }
+
+        cholesky::Solve (mFactor.data (), mNFree, N, solution.data ());
+
+        for (size_t i = 0; i < N; ++i)
+            mVelocities[i * 2 + d] = mRow[i] == N ? 0.0 : solution[mRow[i]];
+    }
+
+    bool more = false;
+
+    for (size_t r = 0; r < mNFree; ++r)
+    {
+        animation::PointView <double> velocity (mVelocities, mFree[r]);
+        animation::PointView <double> position (positions, mFree[r]);
+
+        /* Clip at the same velocity as the explicit integrators do */
+        geometry::ResetIfCloseToZero (velocity, Spring::VelocityThreshold);
+
+        animation::Vector positionDelta;
+        agd::assign (positionDelta, velocity);
+        agd::scale (positionDelta, time / 2);
+
+        agd::pointwise_add (position, positionDelta);
+
+        more |= agd::get <0> (velocity) != 0.0 ||
+                agd::get <1> (velocity) != 0.0;
+    }
+
+    return more;
+}
+
+namespace wobbly
+{
+    namespace springs
+    {
+        template <typename P1, typename P2>
+        inline animation::Vector
+        DeltaFromDesired (P1                const &a,
+                          P2                const &b,
+                          animation::Vector const &desired)
+        {
+            namespace agd = animation::geometry::dimension;
+
+            animation::Vector delta (0.5 * (agd::get <0> (b) -
+                                            agd::get <0> (a) +
+                                            agd::get <0> (desired)),
+                                     0.5 * (agd::get <1> (b) -
+                                            agd::get <1> (a) +
+                                            agd::get <1> (desired)));
+            return delta;
+        }
+
+        /* Applies the force of a spring between posA and posB with
+         * the given desired distance onto forceA and forceB, returning
+         * true if any force was exerted. This is shared between Spring
+         * and the index-based springs in SpringMesh so that both
+         * yield exactly the same result. */
+        template <typename PA, typename PB, typename FA, typename FB>
+        inline bool
+        ApplyForces (PA                const &posA,
+                     PB                const &posB,
+                     animation::Vector const &desiredDistance,
+                     FA                      &forceA,
+                     FB                      &forceB,
+                     double                  springConstant)
+        {
+            namespace agd = animation::geometry::dimension;
+
+            animation::Vector desiredNegative (desiredDistance);
+            agd::scale (desiredNegative, -1);
+
+            animation::Vector deltaA (DeltaFromDesired (posA,
+                                                        posB,
+                                                        desiredNegative));
+            animation::Vector deltaB (DeltaFromDesired (posB,
+                                                        posA,
+                                                        desiredDistance));
+
+            geometry::ResetIfCloseToZero (deltaA, Spring::ClipThreshold);
+            geometry::ResetIfCloseToZero (deltaB, Spring::ClipThreshold);
+
+            animation::Vector springForceA (deltaA);
+            animation::Vector springForceB (deltaB);
+
+            agd::scale (springForceA, springConstant);
+            agd::scale (springForceB, springConstant);
+
+            agd::pointwise_add (forceA, springForceA);
+            agd::pointwise_add (forceB, springForceB);
+
+            /* Return true if a delta was applied at any point */
+            animation::Vector delta (geometry::Absolute (deltaA));
+            agd::pointwise_add (delta, geometry::Absolute (deltaB));
+
+            bool result = agd::get <0> (delta) > 0.00 ||
+                          agd::get <1> (delta) > 0.00;
+
+            return result;
+        }
+
+        /* Adds the force that a spring exerts on only one of its ends
+         * onto force, computed in exactly the same way as ApplyForces.
+         * Returns true if the spring exerts a force on either end. */
+        template <typename PA, typename PB, typename F>
+        inline bool
+        ApplyForceToEnd (PA                const &posA,
+                         PB                const &posB,
+                         animation::Vector const &desiredDistance,
+                         bool                    secondEnd,
+                         F                       &force,
+                         double                  springConstant)
+        {
+            namespace agd = animation::geometry::dimension;
+
+            animation::Vector desiredNegative (desiredDistance);
+            agd::scale (desiredNegative, -1);
+
+            animation::Vector deltaA (DeltaFromDesired (posA,
+                                                        posB,
+                                                        desiredNegative));
+            animation::Vector deltaB (DeltaFromDesired (posB,
+                                                        posA,
+                                                        desiredDistance));
+
+            geometry::ResetIfCloseToZero (deltaA, Spring::ClipThreshold);
+            geometry::ResetIfCloseToZero (deltaB, Spring::ClipThreshold);
+
+            animation::Vector springForce (secondEnd ? deltaB : deltaA);
+            agd::scale (springForce, springConstant);
+            agd::pointwise_add (force, springForce);
+
+            animation::Vector delta (geometry::Absolute (deltaA));
+            agd::pointwise_add (delta, geometry::Absolute (deltaB));
+
+            return agd::get <0> (delta) > 0.00 ||
+                   agd::get <1> (delta) > 0.00;
+        }
+    }
+}
+
+inline bool
+wobbly::Spring::ApplyForces (double springConstant) const
+{
+    return springs::ApplyForces (posA,
+                                 posB,
+                                 desiredDistance,
+                                 forceA,
+                                 forceB,
+                                 springConstant);
+}
+
+template <size_t Width, size_t Height>
+inline bool
+wobbly::BasicSpringMesh <Width, Height>::SpringVector::ApplyForces (double springConstant) const
+{
+    /* Springs between mesh points are a linear sweep over the index
+     * arrays, with no indirection other than the mesh arrays themselves,
+     * so they go through the vectorized kernel */
+    simd::SpringBatch const batch = {
+        mBase.first.data (),
+        mBase.second.data (),
+        mBase.desired.data (),
+        mBase.Count ()
+    };
+
+    bool more = simd::ApplySpringForces (mPositions.data (),
+                                         mForces.data (),
+                                         batch,
+                                         springConstant);
+
+    for (auto const &spring : mAnchorSprings)
+        more |= spring.ApplyForces (springConstant);
+
+    return more;
+}
+
+template <size_t Width, size_t Height>
+inline typename wobbly::BasicSpringMesh <Width, Height>::CalculationResult
+wobbly::BasicSpringMesh <Width, Height>::CalculateForces (double springConstant) const
+{
+    /* Reset all forces back to zero */
+    mForces.fill (0.0);
+
+    /* Accumulate force on each end of each spring. Some points are endpoints
+     * of multiple springs so these functions may cause a force to be updated
+     * multiple (different) times */
+    bool more = mSprings.ApplyForces (springConstant);
+
+    return {
+               more,
+               mForces
+           };
+}
+
+template <size_t Width, size_t Height>
+inline bool
+wobbly::BasicSpringMesh <Width, Height>::SpringVector::GatherForces (size_t   begin,
+                                                                     size_t   end,
+                                                                     double   springConstant,
+                                                                     uint64_t *exerted) const
+{
+    namespace agd = animation::geometry::dimension;
+
+    if (!mIncidenceValid)
+        BuildIncidence ();
+
+    assert (!exerted || end - begin <= 64);
+
+    bool more = false;
+
+    for (size_t i = begin; i < end; ++i)
+    {
+        /* Starting from zero and adding each spring in the same order
+         * as ApplyForces yields exactly the same sum */
+        animation::Vector force (0.0, 0.0);
+        bool owned = false;
+
+        for (size_t e = mIncidence.baseOffsets[i];
+             e < mIncidence.baseOffsets[i + 1];
+             ++e)
+        {
+            size_t const spring = mIncidence.baseEntries[e] >> 1;
+            bool const secondEnd = mIncidence.baseEntries[e] & 1;
+            PointView <double const> desired (mBase.desired.data (), spring);
+
+            bool const applied =
+                springs::ApplyForceToEnd (PointView <double const> (mPositions,
+                                                                    mBase.first[spring]),
+                                          PointView <double const> (mPositions,
+                                                                    mBase.second[spring]),
+                                          Vector (agd::get <0> (desired),
+                                                  agd::get <1> (desired)),
+                                          secondEnd,
+                                          force,
+                                          springConstant);
+
+            /* Springs between mesh points belong to their first end */
+            owned |= applied && !secondEnd;
+        }
+
+        for (size_t e = mIncidence.anchorOffsets[i];
+             e < mIncidence.anchorOffsets[i + 1];
+             ++e)
+        {
+            Spring const &spring (mAnchorSprings[mIncidence.anchorEntries[e] >> 1]);
+            bool const secondEnd = mIncidence.anchorEntries[e] & 1;
+
+            owned |= springs::ApplyForceToEnd (spring.FirstPosition (),
+                                               spring.SecondPosition (),
+                                               spring.DesiredDistance (),
+                                               secondEnd,
+                                               force,
+                                               springConstant);
+        }
+
+        PointView <double> out (mForces, i);
+        agd::assign (out, force);
+
+        if (owned && exerted)
+            *exerted |= uint64_t (1) << (i - begin);
+
+        more |= owned;
+    }
+
+    return more;
+}
+
+template <size_t Width, size_t Height>
+inline bool
+wobbly::BasicSpringMesh <Width, Height>::SpringVector::DetachedForcesExist (double springConstant) const
+{
+    if (!mIncidenceValid)
+        BuildIncidence ();
+
+    bool more = false;
+
+    /* Nothing integrates the ends of these springs, so there is no
+     * need to store the force, only whether there is one */
+    for (size_t index : mIncidence.detached)
+    {
+        Spring const &spring (mAnchorSprings[index]);
+        Vector unused (0.0, 0.0);
+
+        more |= springs::ApplyForceToEnd (spring.FirstPosition (),
+                                          spring.SecondPosition (),
+                                          spring.DesiredDistance (),
+                                          false,
+                                          unused,
+                                          springConstant);
+    }
+
+    return more;
+}
+
+template <size_t Width, size_t Height>
+inline bool
+wobbly::BasicSpringMesh <Width, Height>::GatherForces (size_t   begin,
+                                                       size_t   end,
+                                                       double   springConstant,
+                                                       uint64_t *exerted) const
+{
+    return mSprings.GatherForces (begin, end, springConstant, exerted);
+}
+
+template <size_t Width, size_t Height>
+inline bool
+wobbly::BasicSpringMesh <Width, Height>::DetachedForcesExist (double springConstant) const
+{
+    return mSprings.DetachedForcesExist (springConstant);
+}
+
+template <size_t Width, size_t Height>
+inline double
+wobbly::BasicSpringMesh <Width, Height>::SpringVector::PotentialEnergy (double springConstant) const
+{
+    namespace agd = animation::geometry::dimension;
+
+    auto const stretch = [](double a, double b, double desired) {
+        double const delta = b - a - desired;
+        return delta * delta;
+    };
+
+    double sum = 0.0;
+
+    for (size_t s = 0; s < mBase.Count (); ++s)
+    {
+        size_t const a = mBase.first[s];
+        size_t const b = mBase.second[s];
+
+        for (size_t d = 0; d < 2; ++d)
+            sum += stretch (mPositions[a * 2 + d],
+                            mPositions[b * 2 + d],
+                            mBase.desired[s * 2 + d]);
+    }
+
+    for (Spring const &spring : mAnchorSprings)
+    {
+        sum += stretch (agd::get <0> (spring.FirstPosition ()),
+                        agd::get <0> (spring.SecondPosition ()),
+                        agd::get <0> (spring.DesiredDistance ()));
+        sum += stretch (agd::get <1> (spring.FirstPosition ()),
+                        agd::get <1> (spring.SecondPosition ()),
+                        agd::get <1> (spring.DesiredDistance ()));
+    }
+
+    return sum * springConstant / 4.0;
+}
+
+template <size_t Width, size_t Height>
+inline double
+wobbly::BasicSpringMesh <Width, Height>::PotentialEnergy (double springConstant) const
+{
+    return mSprings.PotentialEnergy (springConstant);
+}
+
+namespace wobbly
+{
+    namespace bezier
+    {
+        /* Fills coefficients with the Bernstein basis polynomials of
+         * degree N - 1 evaluated at t, which weight each of N control
+         * points along one axis of the mesh */
+        template <size_t N>
+        inline void BasisCoefficients (double t, double (&coefficients)[N])
+        {
+            static_assert (N >= 2, "Need at least two control points");
+
+            size_t const degree = N - 1;
+            double const one_t = 1 - t;
+
+            /* Binomial coefficients are built up from the previous one
+             * and powers of t and (1 - t) are multiplied in from
+             * opposite ends so that nothing needs to be recalculated */
+            double binomial = 1.0;
+            double tPower = 1.0;
+
+            for (size_t k = 0; k < N; ++k)
+            {
+                coefficients[k] = binomial * tPower;
+                binomial = binomial * (degree - k) / (k + 1);
+                tPower *= t;
+            }
+
+            double one_tPower = 1.0;
+
+            for (size_t k = N; k-- > 0;)
+            {
+                coefficients[k] *= one_tPower;
+                one_tPower *= one_t;
+            }
+        }
+
+        /* Create a vector of coefficients like
+         * | (1 - u)^3      |
+         * | 3u * (1 - u)^2 |
+         * | 3u^2 * (1 - u) |
+         * | u^3            |
+         *
+         * We store some commonly used variables here so that we don't
+         * need to recalculate them over and over again
+         */
+        template <>
+        inline void BasisCoefficients <4> (double u, double (&coefficients)[4])
+        {
+            double const one_u = 1 - u;
+            double const three_u = 3 * u;
+            double const u_pow2 = u * u;
+            double const one_u_pow2 = one_u * one_u;
+
+            coefficients[0] = one_u * one_u * one_u;
+            coefficients[1] = three_u * one_u_pow2;
+            coefficients[2] = 3 * u_pow2 * one_u;
+            coefficients[3] = u_pow2 * u;
+        }
+    }
+}
+
+namespace wobbly
+{
+    namespace bezier
+    {
+        /* The points along one axis of the mesh that a piecewise patch
+         * reads and the weight of each */
+        struct PatchSpan
+        {
+            size_t index[4];
+            double weight[4];
+        };
+
+        /* Computes the Catmull-Rom weights for unit co-ordinate t along
+         * an axis of nPoints points, for the segment containing t and the
+         * point on either side of it.
+         *
+         * The curve passes through every point and its tangent at a point
+         * only depends on the neighbours, so adjacent segments join with
+         * a continuous first derivative. Beyond the edges of the mesh,
+         * phantom points are reflected through the edge point, which
+         * folds their weight into the two points nearest the edge. */
+        inline PatchSpan CatmullRomSpan (double t, size_t nPoints)
+        {
+            assert (nPoints >= 2);
+
+            size_t const lastSegment = nPoints - 2;
+            double const scaled = t * (nPoints - 1);
+            size_t const segment =
+                scaled <= 0.0 ? 0 :
+                                std::min (static_cast <size_t> (scaled),
+                                          lastSegment);
+
+            double const s = scaled - segment;
+            double const s2 = s * s;
+            double const s3 = s2 * s;
+
+            PatchSpan span = {
+                {
+                    segment - 1,
+                    segment,
+                    segment + 1,
+                    segment + 2
+                },
+                {
+                    (-s3 + 2 * s2 - s) / 2,
+                    (3 * s3 - 5 * s2 + 2) / 2,
+                    (-3 * s3 + 4 * s2 + s) / 2,
+                    (s3 - s2) / 2
+                }
+            };
+
+            /* p[-1] = 2p[0] - p[1] */
+            if (segment == 0)
+            {
+                span.weight[1] += 2 * span.weight[0];
+                span.weight[2] -= span.weight[0];
+                span.weight[0] = 0.0;
+                span.index[0] = 0;
+            }
+
+            /* p[n] = 2p[n - 1] - p[n - 2] */
+            if (segment == lastSegment)
+            {
+                span.weight[2] += 2 * span.weight[3];
+                span.weight[1] -= span.weight[3];
+                span.weight[3] = 0.0;
+                span.index[3] = nPoints - 1;
+            }
+
+            return span;
+        }
+    }
+}
+
+template <size_t Width, size_t Height>
+inline animation::Point
+wobbly::BasicBezierMesh <Width, Height>::DeformUnitCoordsPiecewise (Point const &normalized) const
+{
+    namespace agd = ::animation::geometry::dimension;
+
+    /* u selects the row and v the column, as with
+     * DeformUnitCoordsToMeshSpace */
+    bezier::PatchSpan const rows (bezier::CatmullRomSpan (agd::get <0> (normalized),
+                                                          Height));
+    bezier::PatchSpan const columns (bezier::CatmullRomSpan (agd::get <1> (normalized),
+                                                             Width));
+
+    double x = 0.0;
+    double y = 0.0;
+
+    for (size_t j = 0; j < 4; ++j)
+    {
+        double rowX = 0.0;
+        double rowY = 0.0;
+
+        for (size_t i = 0; i < 4; ++i)
+        {
+            size_t const index = rows.index[j] * Width + columns.index[i];
+
+            rowX += columns.weight[i] * mPoints[index * 2];
+            rowY += columns.weight[i] * mPoints[index * 2 + 1];
+        }
+
+        x += rows.weight[j] * rowX;
+        y += rows.weight[j] * rowY;
+    }
+
+    Point absolutePosition (x, y);
+    return absolutePosition;
+}
+
+namespace wobbly
+{
+    namespace bezier
+    {
+        /* The weight of each of N control points along one axis for
+         * every one of steps samples evenly spaced from 0 to 1.
+         *
+         * Windows tend to be tessellated with the same few densities,
+         * so tables are built once per density and shared between every
+         * mesh. They are never released, the entries in the cache are
+         * only ever as many as the densities in use. */
+        template <size_t N>
+        class BasisTable
+        {
+            public:
+
+                typedef void (*Basis) (double t, double (&weights)[N]);
+
+                BasisTable (size_t steps, Basis basis) :
+                    mSteps (steps),
+                    mWeights (steps * N)
+                {
+                    assert (steps >= 2);
+
+                    for (size_t sample = 0; sample < steps; ++sample)
+                    {
+                        double weights[N];
+                        basis (sample / static_cast <double> (steps - 1),
+                               weights);
+                        std::copy (weights, weights + N, &mWeights[sample * N]);
+                    }
+                }
+
+                static BasisTable const & Bernstein (size_t steps)
+                {
+                    return Shared <BasisCoefficients <N>> (steps);
+                }
+
+                static BasisTable const & CatmullRom (size_t steps)
+                {
+                    return Shared <CatmullRomWeights> (steps);
+                }
+
+                size_t Steps () const
+                {
+                    return mSteps;
+                }
+
+                double const * operator[] (size_t sample) const
+                {
+                    return &mWeights[sample * N];
+                }
+
+            private:
+
+                /* Spreads the four weights of a Catmull-Rom span out over
+                 * the whole axis, so that both surfaces can share the same
+                 * inner loop */
+                static void CatmullRomWeights (double t, double (&weights)[N])
+                {
+                    PatchSpan const span (CatmullRomSpan (t, N));
+
+                    std::fill (weights, weights + N, 0.0);
+
+                    for (size_t i = 0; i < 4; ++i)
+                        weights[span.index[i]] += span.weight[i];
+                }
+
+                template <Basis basis>
+                static BasisTable const & Shared (size_t steps)
+                {
+                    static std::mutex mutex;
+                    static std::map <size_t, BasisTable> tables;
+
+                    std::lock_guard <std::mutex> lock (mutex);
+
+                    auto it = tables.find (steps);
+                    if (it == tables.end ())
+                        it = tables.emplace (steps, BasisTable (steps, basis)).first;
+
+                    return it->second;
+                }
+
+                size_t mSteps;
+                std::vector <double> mWeights;
+        };
+
+        /* Deforms the grid of samples in rows x columns, writing
+         * interleaved x, y pairs to output with the row sample varying
+         * fastest. Each row sample first blends the control points into
+         * a single row of Width points, leaving one dot product over
+         * that row per vertex */
+        template <size_t Width, size_t Height>
+        inline void DeformGrid (BasisTable <Height> const &rows,
+                                BasisTable <Width>  const &columns,
+                                double              const *points,
+                                double                    *output)
+        {
+            size_t const uSteps = rows.Steps ();
+            size_t const vSteps = columns.Steps ();
+
+            for (size_t u = 0; u < uSteps; ++u)
+            {
+                double const *rowWeights = rows[u];
+                double row[Width * 2] = { 0.0 };
+
+                for (size_t j = 0; j < Height; ++j)
+                    for (size_t i = 0; i < Width * 2; ++i)
+                        row[i] += rowWeights[j] * points[j * Width * 2 + i];
+
+                for (size_t v = 0; v < vSteps; ++v)
+                {
+                    double const *w = columns[v];
+                    double x = 0.0;
+                    double y = 0.0;
+
+                    for (size_t i = 0; i < Width; ++i)
+                    {
+                        x += w[i] * row[i * 2];
+                        y += w[i] * row[i * 2 + 1];
+                    }
+
+                    output[(v * uSteps + u) * 2] = x;
+                    output[(v * uSteps + u) * 2 + 1] = y;
+                }
+            }
+        }
+    }
+}
+
+template <size_t Width, size_t Height>
+inline void
+wobbly::BasicBezierMesh <Width, Height>::DeformGrid (size_t uSteps,
+                                                     size_t vSteps,
+                                                     double *output) const
+{
+    bezier::DeformGrid <Width, Height> (bezier::BasisTable <Height>::Bernstein (uSteps),
+                                        bezier::BasisTable <Width>::Bernstein (vSteps),
+                                        mPoints.data (),
+                                        output);
+}
+
+template <size_t Width, size_t Height>
+inline void
+wobbly::BasicBezierMesh <Width, Height>::DeformGridPiecewise (size_t uSteps,
+                                                              size_t vSteps,
+                                                              double *output) const
+{
+    bezier::DeformGrid <Width, Height> (bezier::BasisTable <Height>::CatmullRom (uSteps),
+                                        bezier::BasisTable <Width>::CatmullRom (vSteps),
+                                        mPoints.data (),
+                                        output);
+}
+
+template <size_t Width, size_t Height>
+inline animation::Point
+wobbly::BasicBezierMesh <Width, Height>::DeformUnitCoordsToMeshSpace (Point const &normalized) const
+{
+    namespace agd = ::animation::geometry::dimension;
+
+    double const u = agd::get <0> (normalized);
+    double const v = agd::get <1> (normalized);
+
+    /* u weights the rows and v the columns */
+    double uCoefficients[Height];
+    double vCoefficients[Width];
+
+    bezier::BasisCoefficients (u, uCoefficients);
+    bezier::BasisCoefficients (v, vCoefficients);
+
     double x = 0.0;
     double y = 0.0;
 
     /* This will access the point matrix in a linear fashion for
      * cache-efficiency */
-    for (size_t j = 0; j < config::Height; ++j)
+    for (size_t j = 0; j < Height; ++j)
     {
-        for (size_t i = 0; i < config::Width; ++i)
+        for (size_t i = 0; i < Width; ++i)
         {
-            size_t const xIdx = j * 2 * config::Width + i * 2;
-            size_t const yIdx = j * 2 * config::Width + i * 2 + 1;
+            size_t const xIdx = j * 2 * Width + i * 2;
+            size_t const yIdx = j * 2 * Width + i * 2 + 1;
 
             x += uCoefficients[j] * vCoefficients[i] * mPoints[xIdx];
             y += uCoefficients[j] * vCoefficients[i] * mPoints[yIdx];
@@ -0,0 +1,844 @@
+/*
+ * animation/wobbly/wobbly_simd.cpp
+ *
+ * Copyright 2018 Endless Mobile, Inc.
+ *
+ * libanimation is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 2.1 of the
+ * License, or (at your option) any later version.
+ *
+ * libanimation is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with eos-companion-app-service.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Scalar, SSE2 and AVX2 variants of the wobbly mesh kernels and the
+ * load-time dispatch between them.
+ *
+ * All variants perform the same floating point operations in the same
+ * order as the generic code in wobbly_internal.h (and never use fused
+ * multiply-add), so they produce bit-identical results.
+ */
+#include <cstddef>                      // for size_t
+#include <cstdint>                      // for uint64_t, int64_t
+#include <cmath>                        // for fabs
+
+#include "wobbly_simd.h"
+#include "wobbly_internal.h"            // for Spring
+
+#if defined (__SSE2__)
+#define WOBBLY_SIMD_HAVE_SSE2 1
+#include <emmintrin.h>                  // for __m128d, _mm_*
+#endif
+
+#if defined (WOBBLY_SIMD_HAVE_SSE2) && defined (__GNUC__) && \
+    (defined (__x86_64__) || defined (__i386__))
+#define WOBBLY_SIMD_HAVE_AVX2 1
+#include <immintrin.h>                  // for __m256d, _mm256_*
+#endif
+
+namespace ws = wobbly::simd;
+
+namespace
+{
+    bool
+    ApplySpringForcesScalar (double          const *positions,
+                             double                *forces,
+                             ws::SpringBatch const &springs,
+                             double                springConstant)
+    {
+        bool more = false;
+
+        for (size_t i = 0; i < springs.count; ++i)
+        {
+            double const *posA = positions + springs.first[i] * 2;
+            double const *posB = positions + springs.second[i] * 2;
+            double *forceA = forces + springs.first[i] * 2;
+            double *forceB = forces + springs.second[i] * 2;
+            double const *desired = springs.desired + i * 2;
+
+            double sum[2];
+
+            for (size_t c = 0; c < 2; ++c)
+            {
+                double deltaA = 0.5 * (posB[c] - posA[c] + desired[c] * -1);
+                double deltaB = 0.5 * (posA[c] - posB[c] + desired[c]);
+
+                deltaA = std::fabs (deltaA) < wobbly::Spring::ClipThreshold ? 0.0 : deltaA;
+                deltaB = std::fabs (deltaB) < wobbly::Spring::ClipThreshold ? 0.0 : deltaB;
+
+                forceA[c] += deltaA * springConstant;
+                forceB[c] += deltaB * springConstant;
+
+                sum[c] = std::fabs (deltaA) + std::fabs (deltaB);
+            }
+
+            more |= sum[0] > 0.00 || sum[1] > 0.00;
+        }
+
+        return more;
+    }
+
+    inline bool
+    IsAnchored (uint64_t const *anchorMask, size_t index)
+    {
+        return (anchorMask[index / 64] >> (index % 64)) & 1;
+    }
+
+    bool
+    IntegrateEulerScalar (double         time,
+                          double         friction,
+                          double         mass,
+                          double         *positions,
+                          double         *velocities,
+                          double   const *forces,
+                          uint64_t const *anchorMask,
+                          size_t         count)
+    {
+        bool more = false;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            double *position = positions + i * 2;
+            double *velocity = velocities + i * 2;
+            double const *force = forces + i * 2;
+
+            if (IsAnchored (anchorMask, i))
+            {
+                velocity[0] = 0.0;
+                velocity[1] = 0.0;
+                continue;
+            }
+
+            for (size_t c = 0; c < 2; ++c)
+            {
+                double const frictionForce = (0.0 + velocity[c]) * friction;
+                double const totalForce = force[c] - frictionForce;
+                double const acceleration = totalForce * (1.0 / mass);
+
+                double v = velocity[c] + acceleration * time;
+                v = std::fabs (v) < wobbly::Spring::VelocityThreshold ? 0.0 : v;
+
+                velocity[c] = v;
+                position[c] += v * (time / 2);
+            }
+
+            more |= std::fabs (velocity[0]) > 0.00 ||
+                    std::fabs (velocity[1]) > 0.00;
+        }
+
+        return more;
+    }
+
+    unsigned int
+    StepLanesScalar (ws::LaneMesh  const &mesh,
+                     ws::LaneState const &state,
+                     double              time,
+                     double              mass)
+    {
+        size_t const L = ws::Lanes;
+        unsigned int more = 0;
+
+        for (size_t i = 0; i < mesh.nPoints; ++i)
+        {
+            for (size_t l = 0; l < L; ++l)
+            {
+                double force[2] = { 0.0, 0.0 };
+
+                for (size_t e = mesh.incidenceOffsets[i];
+                     e < mesh.incidenceOffsets[i + 1];
+                     ++e)
+                {
+                    size_t const spring = mesh.incidenceEntries[e] >> 1;
+                    bool const secondEnd = mesh.incidenceEntries[e] & 1;
+                    size_t const a = mesh.first[spring];
+                    size_t const b = mesh.second[spring];
+                    double sum[2];
+
+                    for (size_t c = 0; c < 2; ++c)
+                    {
+                        double const posA = state.positions[(a * 2 + c) * L + l];
+                        double const posB = state.positions[(b * 2 + c) * L + l];
+                        double const desired = state.desired[(spring * 2 + c) * L + l];
+
+                        double deltaA = 0.5 * (posB - posA + desired * -1);
+                        double deltaB = 0.5 * (posA - posB + desired);
+
+                        deltaA = std::fabs (deltaA) < wobbly::Spring::ClipThreshold ? 0.0 : deltaA;
+                        deltaB = std::fabs (deltaB) < wobbly::Spring::ClipThreshold ? 0.0 : deltaB;
+
+                        force[c] += (secondEnd ? deltaB : deltaA) * state.springConstant[l];
+                        sum[c] = std::fabs (deltaA) + std::fabs (deltaB);
+                    }
+
+                    /* Springs belong to their first end */
+                    if (!secondEnd && (sum[0] > 0.00 || sum[1] > 0.00))
+                        more |= 1u << l;
+                }
+
+                state.forces[(i * 2) * L + l] = force[0];
+                state.forces[(i * 2 + 1) * L + l] = force[1];
+            }
+        }
+
+        for (size_t i = 0; i < mesh.nPoints; ++i)
+        {
+            for (size_t l = 0; l < L; ++l)
+            {
+                if (state.anchored[i * L + l])
+                {
+                    state.velocities[(i * 2) * L + l] = 0.0;
+                    state.velocities[(i * 2 + 1) * L + l] = 0.0;
+                    continue;
+                }
+
+                bool moving = false;
+
+                for (size_t c = 0; c < 2; ++c)
+                {
+                    size_t const index = (i * 2 + c) * L + l;
+                    double const velocity = state.velocities[index];
+
+                    double const frictionForce = (0.0 + velocity) * state.friction[l];
+                    double const totalForce = state.forces[index] - frictionForce;
+                    double const acceleration = totalForce * (1.0 / mass);
+
+                    double v = velocity + acceleration * time;
+                    v = std::fabs (v) < wobbly::Spring::VelocityThreshold ? 0.0 : v;
+
+                    state.velocities[index] = v;
+                    state.positions[index] += v * (time / 2);
+
+                    moving |= std::fabs (v) > 0.00;
+                }
+
+                if (moving)
+                    more |= 1u << l;
+            }
+        }
+
+        return more;
+    }
+
+#if defined (WOBBLY_SIMD_HAVE_SSE2)
+    /* Each __m128d holds one x, y pair, so every 2-component operation
+     * is a single instruction */
+    struct SSE2Constants
+    {
+        __m128d const half = _mm_set1_pd (0.5);
+        __m128d const negate = _mm_set1_pd (-1.0);
+        __m128d const threshold = _mm_set1_pd (wobbly::Spring::ClipThreshold);
+        __m128d const zero = _mm_setzero_pd ();
+        __m128d const signMask = _mm_set1_pd (-0.0);
+    };
+
+    inline __m128d
+    ClipSSE2 (__m128d delta, SSE2Constants const &c)
+    {
+        __m128d const abs = _mm_andnot_pd (c.signMask, delta);
+        return _mm_andnot_pd (_mm_cmplt_pd (abs, c.threshold), delta);
+    }
+
+    inline bool
+    ApplyOneSpringSSE2 (double          const *positions,
+                        double                *forces,
+                        ws::SpringBatch const &springs,
+                        size_t                i,
+                        __m128d               k,
+                        SSE2Constants   const &c)
+    {
+        size_t const first = springs.first[i] * 2;
+        size_t const second = springs.second[i] * 2;
+
+        __m128d const posA = _mm_loadu_pd (positions + first);
+        __m128d const posB = _mm_loadu_pd (positions + second);
+        __m128d const desired = _mm_loadu_pd (springs.desired + i * 2);
+
+        __m128d deltaA =
+            _mm_mul_pd (c.half,
+                        _mm_add_pd (_mm_sub_pd (posB, posA),
+                                    _mm_mul_pd (desired, c.negate)));
+        __m128d deltaB =
+            _mm_mul_pd (c.half,
+                        _mm_add_pd (_mm_sub_pd (posA, posB), desired));
+
+        deltaA = ClipSSE2 (deltaA, c);
+        deltaB = ClipSSE2 (deltaB, c);
+
+        _mm_storeu_pd (forces + first,
+                       _mm_add_pd (_mm_loadu_pd (forces + first),
+                                   _mm_mul_pd (deltaA, k)));
+        _mm_storeu_pd (forces + second,
+                       _mm_add_pd (_mm_loadu_pd (forces + second),
+                                   _mm_mul_pd (deltaB, k)));
+
+        __m128d const sum = _mm_add_pd (_mm_andnot_pd (c.signMask, deltaA),
+                                        _mm_andnot_pd (c.signMask, deltaB));
+        return _mm_movemask_pd (_mm_cmpgt_pd (sum, c.zero)) != 0;
+    }
+
+    bool
+    ApplySpringForcesSSE2 (double          const *positions,
+                           double                *forces,
+                           ws::SpringBatch const &springs,
+                           double                springConstant)
+    {
+        SSE2Constants const c;
+        __m128d const k = _mm_set1_pd (springConstant);
+        bool more = false;
+
+        for (size_t i = 0; i < springs.count; ++i)
+            more |= ApplyOneSpringSSE2 (positions, forces, springs, i, k, c);
+
+        return more;
+    }
+    /* Computes the new position and velocity of one unanchored point,
+     * returning a mask of the components with velocity remaining */
+    inline __m128d
+    EulerStepSSE2 (__m128d       &position,
+                   __m128d       &velocity,
+                   __m128d const force,
+                   __m128d const friction,
+                   __m128d const inverseMass,
+                   __m128d const time,
+                   __m128d const halfTime,
+                   __m128d const threshold,
+                   SSE2Constants const &c)
+    {
+        __m128d const frictionForce =
+            _mm_mul_pd (_mm_add_pd (c.zero, velocity), friction);
+        __m128d const totalForce = _mm_sub_pd (force, frictionForce);
+        __m128d const acceleration = _mm_mul_pd (totalForce, inverseMass);
+
+        velocity = _mm_add_pd (velocity, _mm_mul_pd (acceleration, time));
+
+        __m128d const abs = _mm_andnot_pd (c.signMask, velocity);
+        velocity = _mm_andnot_pd (_mm_cmplt_pd (abs, threshold), velocity);
+
+        position = _mm_add_pd (position, _mm_mul_pd (velocity, halfTime));
+
+        return _mm_cmpgt_pd (_mm_andnot_pd (c.signMask, velocity), c.zero);
+    }
+
+    bool
+    IntegrateEulerSSE2 (double         time,
+                        double         friction,
+                        double         mass,
+                        double         *positions,
+                        double         *velocities,
+                        double   const *forces,
+                        uint64_t const *anchorMask,
+                        size_t         count)
+    {
+        SSE2Constants const c;
+        __m128d const vFriction = _mm_set1_pd (friction);
+        __m128d const vInverseMass = _mm_set1_pd (1.0 / mass);
+        __m128d const vTime = _mm_set1_pd (time);
+        __m128d const vHalfTime = _mm_set1_pd (time / 2);
+        __m128d const vThreshold = _mm_set1_pd (wobbly::Spring::VelocityThreshold);
+
+        __m128d remaining = c.zero;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            /* All ones where this point is anchored */
+            int64_t const bit = IsAnchored (anchorMask, i);
+            __m128d const anchored = _mm_castsi128_pd (_mm_set1_epi64x (-bit));
+
+            __m128d const oldPosition = _mm_loadu_pd (positions + i * 2);
+            __m128d position = oldPosition;
+            __m128d velocity = _mm_loadu_pd (velocities + i * 2);
+
+            __m128d const moving = EulerStepSSE2 (position,
+                                                  velocity,
+                                                  _mm_loadu_pd (forces + i * 2),
+                                                  vFriction,
+                                                  vInverseMass,
+                                                  vTime,
+                                                  vHalfTime,
+                                                  vThreshold,
+                                                  c);
+
+            _mm_storeu_pd (velocities + i * 2,
+                           _mm_andnot_pd (anchored, velocity));
+            _mm_storeu_pd (positions + i * 2,
+                           _mm_or_pd (_mm_and_pd (anchored, oldPosition),
+                                      _mm_andnot_pd (anchored, position)));
+
+            remaining = _mm_or_pd (remaining, _mm_andnot_pd (anchored, moving));
+        }
+
+        return _mm_movemask_pd (remaining) != 0;
+    }
+#endif
+
+#if defined (WOBBLY_SIMD_HAVE_AVX2)
+    /* Each __m256d holds the x, y pairs of two springs. The deltas for
+     * both springs are computed together, then the forces are accumulated
+     * one spring at a time since springs in the same batch may share
+     * endpoints. */
+    __attribute__((target ("avx2"))) inline __m256d
+    LoadPairAVX2 (double const *lo, double const *hi)
+    {
+        return _mm256_insertf128_pd (_mm256_castpd128_pd256 (_mm_loadu_pd (lo)),
+                                     _mm_loadu_pd (hi),
+                                     1);
+    }
+
+    __attribute__((target ("avx2"))) inline void
+    AccumulateAVX2 (double *force, __m128d delta)
+    {
+        _mm_storeu_pd (force, _mm_add_pd (_mm_loadu_pd (force), delta));
+    }
+
+    __attribute__((target ("avx2"))) bool
+    ApplySpringForcesAVX2 (double          const *positions,
+                           double                *forces,
+                           ws::SpringBatch const &springs,
+                           double                springConstant)
+    {
+        __m256d const half = _mm256_set1_pd (0.5);
+        __m256d const negate = _mm256_set1_pd (-1.0);
+        __m256d const threshold = _mm256_set1_pd (wobbly::Spring::ClipThreshold);
+        __m256d const signMask = _mm256_set1_pd (-0.0);
+        __m256d const k = _mm256_set1_pd (springConstant);
+
+        __m256d anyForce = _mm256_setzero_pd ();
+        size_t i = 0;
+
+        for (; i + 2 <= springs.count; i += 2)
+        {
+            size_t const firstLo = springs.first[i] * 2;
+            size_t const secondLo = springs.second[i] * 2;
+            size_t const firstHi = springs.first[i + 1] * 2;
+            size_t const secondHi = springs.second[i + 1] * 2;
+
+            __m256d const posA = LoadPairAVX2 (positions + firstLo,
+                                               positions + firstHi);
+            __m256d const posB = LoadPairAVX2 (positions + secondLo,
+                                               positions + secondHi);
+            __m256d const desired = _mm256_loadu_pd (springs.desired + i * 2);
+
+            __m256d deltaA =
+                _mm256_mul_pd (half,
+                               _mm256_add_pd (_mm256_sub_pd (posB, posA),
+                                              _mm256_mul_pd (desired, negate)));
+            __m256d deltaB =
+                _mm256_mul_pd (half,
+                               _mm256_add_pd (_mm256_sub_pd (posA, posB),
+                                              desired));
+
+            __m256d const absA = _mm256_andnot_pd (signMask, deltaA);
+            __m256d const absB = _mm256_andnot_pd (signMask, deltaB);
+
+            deltaA = _mm256_andnot_pd (_mm256_cmp_pd (absA, threshold, _CMP_LT_OQ),
+                                       deltaA);
+            deltaB = _mm256_andnot_pd (_mm256_cmp_pd (absB, threshold, _CMP_LT_OQ),
+                                       deltaB);
+
+            __m256d const forceA = _mm256_mul_pd (deltaA, k);
+            __m256d const forceB = _mm256_mul_pd (deltaB, k);
+
+            AccumulateAVX2 (forces + firstLo, _mm256_castpd256_pd128 (forceA));
+            AccumulateAVX2 (forces + secondLo, _mm256_castpd256_pd128 (forceB));
+            AccumulateAVX2 (forces + firstHi, _mm256_extractf128_pd (forceA, 1));
+            AccumulateAVX2 (forces + secondHi, _mm256_extractf128_pd (forceB, 1));
+
+            __m256d const sum =
+                _mm256_add_pd (_mm256_andnot_pd (signMask, deltaA),
+                               _mm256_andnot_pd (signMask, deltaB));
+            anyForce = _mm256_or_pd (anyForce,
+                                     _mm256_cmp_pd (sum,
+                                                    _mm256_setzero_pd (),
+                                                    _CMP_GT_OQ));
+        }
+
+        bool more = _mm256_movemask_pd (anyForce) != 0;
+
+        /* Odd spring out */
+        if (i < springs.count)
+        {
+            ws::SpringBatch const tail = {
+                springs.first + i,
+                springs.second + i,
+                springs.desired + i * 2,
+                springs.count - i
+            };
+
+            more |= ApplySpringForcesSSE2 (positions, forces, tail, springConstant);
+        }
+
+        return more;
+    }
+    __attribute__((target ("avx2"))) bool
+    IntegrateEulerAVX2 (double         time,
+                        double         friction,
+                        double         mass,
+                        double         *positions,
+                        double         *velocities,
+                        double   const *forces,
+                        uint64_t const *anchorMask,
+                        size_t         count)
+    {
+        __m256d const zero = _mm256_setzero_pd ();
+        __m256d const signMask = _mm256_set1_pd (-0.0);
+        __m256d const vFriction = _mm256_set1_pd (friction);
+        __m256d const vInverseMass = _mm256_set1_pd (1.0 / mass);
+        __m256d const vTime = _mm256_set1_pd (time);
+        __m256d const vHalfTime = _mm256_set1_pd (time / 2);
+        __m256d const vThreshold = _mm256_set1_pd (wobbly::Spring::VelocityThreshold);
+
+        __m256d remaining = zero;
+        size_t i = 0;
+
+        /* Two points per iteration, positions and velocities being
+         * contiguous x, y pairs */
+        for (; i + 2 <= count; i += 2)
+        {
+            int64_t const lo = -static_cast <int64_t> (IsAnchored (anchorMask, i));
+            int64_t const hi = -static_cast <int64_t> (IsAnchored (anchorMask, i + 1));
+            __m256d const anchored =
+                _mm256_castsi256_pd (_mm256_set_epi64x (hi, hi, lo, lo));
+
+            __m256d const oldPosition = _mm256_loadu_pd (positions + i * 2);
+            __m256d velocity = _mm256_loadu_pd (velocities + i * 2);
+            __m256d const force = _mm256_loadu_pd (forces + i * 2);
+
+            __m256d const frictionForce =
+                _mm256_mul_pd (_mm256_add_pd (zero, velocity), vFriction);
+            __m256d const totalForce = _mm256_sub_pd (force, frictionForce);
+            __m256d const acceleration = _mm256_mul_pd (totalForce,
+                                                        vInverseMass);
+
+            velocity = _mm256_add_pd (velocity,
+                                      _mm256_mul_pd (acceleration, vTime));
+
+            __m256d const abs = _mm256_andnot_pd (signMask, velocity);
+            velocity = _mm256_andnot_pd (_mm256_cmp_pd (abs,
+                                                        vThreshold,
+                                                        _CMP_LT_OQ),
+                                         velocity);
+
+            __m256d const position =
+                _mm256_add_pd (oldPosition, _mm256_mul_pd (velocity, vHalfTime));
+
+            _mm256_storeu_pd (velocities + i * 2,
+                              _mm256_andnot_pd (anchored, velocity));
+            _mm256_storeu_pd (positions + i * 2,
+                              _mm256_blendv_pd (position, oldPosition, anchored));
+
+            __m256d const moving =
+                _mm256_cmp_pd (_mm256_andnot_pd (signMask, velocity),
+                               zero,
+                               _CMP_GT_OQ);
+            remaining = _mm256_or_pd (remaining,
+                                      _mm256_andnot_pd (anchored, moving));
+        }
+
+        bool more = _mm256_movemask_pd (remaining) != 0;
+
+        /* Odd point out */
+        if (i < count)
+        {
+            uint64_t const tailMask = IsAnchored (anchorMask, i);
+            more |= IntegrateEulerSSE2 (time,
+                                        friction,
+                                        mass,
+                                        positions + i * 2,
+                                        velocities + i * 2,
+                                        forces + i * 2,
+                                        &tailMask,
+                                        1);
+        }
+
+        return more;
+    }
+
+    /* Each __m256d holds the same component of the same point for all
+     * four lanes, so every operation is the scalar one applied to four
+     * models at once */
+    __attribute__((target ("avx2"))) unsigned int
+    StepLanesAVX2 (ws::LaneMesh  const &mesh,
+                   ws::LaneState const &state,
+                   double              time,
+                   double              mass)
+    {
+        static_assert (ws::Lanes == 4, "One lane per double in a register");
+
+        size_t const L = ws::Lanes;
+
+        __m256d const zero = _mm256_setzero_pd ();
+        __m256d const half = _mm256_set1_pd (0.5);
+        __m256d const negate = _mm256_set1_pd (-1.0);
+        __m256d const signMask = _mm256_set1_pd (-0.0);
+        __m256d const clip = _mm256_set1_pd (wobbly::Spring::ClipThreshold);
+        __m256d const k = _mm256_loadu_pd (state.springConstant);
+        __m256d const friction = _mm256_loadu_pd (state.friction);
+        __m256d const inverseMass = _mm256_set1_pd (1.0 / mass);
+        __m256d const vTime = _mm256_set1_pd (time);
+        __m256d const halfTime = _mm256_set1_pd (time / 2);
+        __m256d const threshold = _mm256_set1_pd (wobbly::Spring::VelocityThreshold);
+
+        __m256d remaining = zero;
+
+        for (size_t i = 0; i < mesh.nPoints; ++i)
+        {
+            __m256d force[2] = { zero, zero };
+
+            for (size_t e = mesh.incidenceOffsets[i];
+                 e < mesh.incidenceOffsets[i + 1];
+                 ++e)
+            {
+                size_t const spring = mesh.incidenceEntries[e] >> 1;
+                bool const secondEnd = mesh.incidenceEntries[e] & 1;
+                size_t const a = mesh.first[spring];
+                size_t const b = mesh.second[spring];
+                __m256d exerted = zero;
+
+                for (size_t c = 0; c < 2; ++c)
+                {
+                    __m256d const posA = _mm256_loadu_pd (state.positions + (a * 2 + c) * L);
+                    __m256d const posB = _mm256_loadu_pd (state.positions + (b * 2 + c) * L);
+                    __m256d const desired = _mm256_loadu_pd (state.desired + (spring * 2 + c) * L);
+
+                    __m256d deltaA =
+                        _mm256_mul_pd (half,
+                                       _mm256_add_pd (_mm256_sub_pd (posB, posA),
+                                                      _mm256_mul_pd (desired, negate)));
+                    __m256d deltaB =
+                        _mm256_mul_pd (half,
+                                       _mm256_add_pd (_mm256_sub_pd (posA, posB),
+                                                      desired));
+
+                    __m256d const absA = _mm256_andnot_pd (signMask, deltaA);
+                    __m256d const absB = _mm256_andnot_pd (signMask, deltaB);
+                    deltaA = _mm256_andnot_pd (_mm256_cmp_pd (absA, clip, _CMP_LT_OQ), deltaA);
+                    deltaB = _mm256_andnot_pd (_mm256_cmp_pd (absB, clip, _CMP_LT_OQ), deltaB);
+
+                    force[c] = _mm256_add_pd (force[c],
+                                              _mm256_mul_pd (secondEnd ? deltaB : deltaA, k));
+
+                    __m256d const sum =
+                        _mm256_add_pd (_mm256_andnot_pd (signMask, deltaA),
+                                       _mm256_andnot_pd (signMask, deltaB));
+                    exerted = _mm256_or_pd (exerted,
+                                            _mm256_cmp_pd (sum, zero, _CMP_GT_OQ));
+                }
+
+                if (!secondEnd)
+                    remaining = _mm256_or_pd (remaining, exerted);
+            }
+
+            _mm256_storeu_pd (state.forces + (i * 2) * L, force[0]);
+            _mm256_storeu_pd (state.forces + (i * 2 + 1) * L, force[1]);
+        }
+
+        for (size_t i = 0; i < mesh.nPoints; ++i)
+        {
+            __m256d const anchored =
+                _mm256_castsi256_pd (_mm256_loadu_si256 (reinterpret_cast <__m256i const *> (state.anchored + i * L)));
+            __m256d moving = zero;
+
+            for (size_t c = 0; c < 2; ++c)
+            {
+                double *p = state.positions + (i * 2 + c) * L;
+                double *v = state.velocities + (i * 2 + c) * L;
+
+                __m256d const oldPosition = _mm256_loadu_pd (p);
+                __m256d velocity = _mm256_loadu_pd (v);
+                __m256d const f = _mm256_loadu_pd (state.forces + (i * 2 + c) * L);
+
+                __m256d const frictionForce =
+                    _mm256_mul_pd (_mm256_add_pd (zero, velocity), friction);
+                __m256d const totalForce = _mm256_sub_pd (f, frictionForce);
+                __m256d const acceleration = _mm256_mul_pd (totalForce,
+                                                            inverseMass);
+
+                velocity = _mm256_add_pd (velocity,
+                                          _mm256_mul_pd (acceleration, vTime));
+
+                __m256d const abs = _mm256_andnot_pd (signMask, velocity);
+                velocity = _mm256_andnot_pd (_mm256_cmp_pd (abs,
+                                                            threshold,
+                                                            _CMP_LT_OQ),
+                                             velocity);
+
+                __m256d const position =
+                    _mm256_add_pd (oldPosition, _mm256_mul_pd (velocity, halfTime));
+
+                _mm256_storeu_pd (v, _mm256_andnot_pd (anchored, velocity));
+                _mm256_storeu_pd (p, _mm256_blendv_pd (position, oldPosition, anchored));
+
+                moving = _mm256_or_pd (moving,
+                                       _mm256_cmp_pd (_mm256_andnot_pd (signMask, velocity),
+                                                      zero,
+                                                      _CMP_GT_OQ));
+            }
+
+            remaining = _mm256_or_pd (remaining, _mm256_andnot_pd (anchored, moving));
+        }
+
+        return static_cast <unsigned int> (_mm256_movemask_pd (remaining));
+    }
+#endif
+
+    ws::Isa
+    DetectIsa ()
+    {
+#if defined (WOBBLY_SIMD_HAVE_AVX2)
+        /* Required before __builtin_cpu_supports when called from
+         * a static initializer */
+        __builtin_cpu_init ();
+        if (__builtin_cpu_supports ("avx2"))
+            return ws::Isa::AVX2;
+#endif
+#if defined (WOBBLY_SIMD_HAVE_SSE2)
+        return ws::Isa::SSE2;
+#else
+        return ws::Isa::Scalar;
+#endif
+    }
+
+    ws::Isa const selectedIsa = DetectIsa ();
+    ws::SpringForceKernel const selectedSpringForceKernel =
+        ws::SpringForceKernelFor (selectedIsa);
+    ws::EulerIntegrationKernel const selectedEulerIntegrationKernel =
+        ws::EulerIntegrationKernelFor (selectedIsa);
+    ws::LaneStepKernel const selectedLaneStepKernel =
+        ws::LaneStepKernelFor (selectedIsa);
+}
+
+bool
+wobbly::simd::IsaSupported (Isa isa)
+{
+    switch (isa)
+    {
+        case Isa::Scalar:
+            return true;
+#if defined (WOBBLY_SIMD_HAVE_SSE2)
+        case Isa::SSE2:
+            return true;
+#endif
+#if defined (WOBBLY_SIMD_HAVE_AVX2)
+        case Isa::AVX2:
+            __builtin_cpu_init ();
+            return __builtin_cpu_supports ("avx2");
+#endif
+        default:
+            return false;
+    }
+}
+
+wobbly::simd::SpringForceKernel
+wobbly::simd::SpringForceKernelFor (Isa isa)
+{
+    switch (isa)
+    {
+        case Isa::Scalar:
+            return ApplySpringForcesScalar;
+#if defined (WOBBLY_SIMD_HAVE_SSE2)
+        case Isa::SSE2:
+            return ApplySpringForcesSSE2;
+#endif
+#if defined (WOBBLY_SIMD_HAVE_AVX2)
+        case Isa::AVX2:
+            return ApplySpringForcesAVX2;
+#endif
+        default:
+            return nullptr;
+    }
+}
+
+wobbly::simd::EulerIntegrationKernel
+wobbly::simd::EulerIntegrationKernelFor (Isa isa)
+{
+    switch (isa)
+    {
+        case Isa::Scalar:
+            return IntegrateEulerScalar;
+#if defined (WOBBLY_SIMD_HAVE_SSE2)
+        case Isa::SSE2:
+            return IntegrateEulerSSE2;
+#endif
+#if defined (WOBBLY_SIMD_HAVE_AVX2)
+        case Isa::AVX2:
+            return IntegrateEulerAVX2;
+#endif
+        default:
+            return nullptr;
+    }
+}
+
+wobbly::simd::LaneStepKernel
+wobbly::simd::LaneStepKernelFor (Isa isa)
+{
+    /* Lanes are already as wide as an AVX2 register, the SSE2 variant
+     * would only be the scalar one split in two */
+    switch (isa)
+    {
+        case Isa::Scalar:
+            return StepLanesScalar;
+#if defined (WOBBLY_SIMD_HAVE_SSE2)
+        case Isa::SSE2:
+            return StepLanesScalar;
+#endif
+#if defined (WOBBLY_SIMD_HAVE_AVX2)
+        case Isa::AVX2:
+            return StepLanesAVX2;
+#endif
+        default:
+            return nullptr;
+    }
+}
+
+wobbly::simd::Isa
+wobbly::simd::SelectedIsa ()
+{
+    return selectedIsa;
+}
+
+bool
+wobbly::simd::ApplySpringForces (double      const *positions,
+                                 double            *forces,
+                                 SpringBatch const &springs,
+                                 double            springConstant)
+{
+    return selectedSpringForceKernel (positions,
+                                      forces,
+                                      springs,
+                                      springConstant);
+}
+
+bool
+wobbly::simd::IntegrateEuler (double         time,
+                              double         friction,
+                              double         mass,
+                              double         *positions,
+                              double         *velocities,
+                              double   const *forces,
+                              uint64_t const *anchorMask,
+                              size_t         count)
+{
+    return selectedEulerIntegrationKernel (time,
+                                           friction,
+                                           mass,
+                                           positions,
+                                           velocities,
+                                           forces,
+                                           anchorMask,
+                                           count);
+}
+
+unsigned int
+wobbly::simd::StepLanes (LaneMesh  const &mesh,
+                         LaneState const &state,
+                         double          time,
+                         double          mass)
+{
+    return selectedLaneStepKernel (mesh, state, time, mass);
+}
@@ -0,0 +1,157 @@
+/*
+ * animation/wobbly/wobbly_simd.h
+ *
+ * Copyright 2018 Endless Mobile, Inc.
+ *
+ * libanimation is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 2.1 of the
+ * License, or (at your option) any later version.
+ *
+ * libanimation is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with eos-companion-app-service.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Vectorized kernels for the hot loops of the wobbly mesh. Each kernel
+ * has a scalar, SSE2 and AVX2 variant, one of which is selected when the
+ * library is loaded depending on what the CPU supports.
+ *
+ * The kernels operate on raw interleaved x, y arrays like MeshArray, so
+ * they do not depend on the rest of the internal headers.
+ */
+#pragma once
+
+#include <cstddef>                      // for size_t
+#include <cstdint>                      // for uint64_t
+
+namespace wobbly
+{
+    namespace simd
+    {
+        enum class Isa
+        {
+            Scalar,
+            SSE2,
+            AVX2
+        };
+
+        /* A batch of springs in structure-of-arrays form. first and
+         * second are point indices into the position and force arrays,
+         * desired holds an interleaved x, y desired distance for each
+         * spring. */
+        struct SpringBatch
+        {
+            size_t const *first;
+            size_t const *second;
+            double const *desired;
+            size_t       count;
+        };
+
+        typedef bool (*SpringForceKernel) (double      const *positions,
+                                           double            *forces,
+                                           SpringBatch const &springs,
+                                           double            springConstant);
+
+        /* Applies the force of every spring in the batch onto the forces
+         * array, exactly as Spring::ApplyForces would for each spring in
+         * order, returning true if any spring exerted a force.
+         *
+         * Force deltas for several springs are computed at once, but they
+         * are accumulated in spring order so that the result is identical
+         * to the scalar path. */
+        bool ApplySpringForces (double      const *positions,
+                                double            *forces,
+                                SpringBatch const &springs,
+                                double            springConstant);
+
+        typedef bool (*EulerIntegrationKernel) (double         time,
+                                                double         friction,
+                                                double         mass,
+                                                double         *positions,
+                                                double         *velocities,
+                                                double   const *forces,
+                                                uint64_t const *anchorMask,
+                                                size_t         count);
+
+        /* Performs one step of EulerIntegrate on the first count points
+         * of positions and velocities in a single pass. Points whose bit
+         * is set in anchorMask (64 points per word) have their velocity
+         * reset to zero and their position left alone instead.
+         *
+         * Returns true if any unanchored point has velocity remaining. */
+        bool IntegrateEuler (double         time,
+                             double         friction,
+                             double         mass,
+                             double         *positions,
+                             double         *velocities,
+                             double   const *forces,
+                             uint64_t const *anchorMask,
+                             size_t         count);
+
+        /* Number of models stepped together by StepLanes, one for each
+         * double in an AVX2 register */
+        constexpr size_t Lanes = 4;
+
+        /* The springs of a mesh shared by every lane. For each point,
+         * incidenceEntries from incidenceOffsets[point] up to
+         * incidenceOffsets[point + 1] hold (spring << 1) | end for every
+         * spring with that point at its first (0) or second (1) end, in
+         * spring order. */
+        struct LaneMesh
+        {
+            size_t const *first;
+            size_t const *second;
+            size_t const *incidenceOffsets;
+            size_t const *incidenceEntries;
+            size_t       nPoints;
+        };
+
+        /* The state of Lanes models of the same size, with component c
+         * of point i for lane l at [(i * 2 + c) * Lanes + l] and likewise
+         * for desired spring distances. anchored is all ones for each
+         * point and lane that is anchored, settings are per lane. */
+        struct LaneState
+        {
+            double         *positions;
+            double         *velocities;
+            double         *forces;
+            double   const *desired;
+            uint64_t const *anchored;
+            double   const *springConstant;
+            double   const *friction;
+        };
+
+        typedef unsigned int (*LaneStepKernel) (LaneMesh  const &mesh,
+                                                LaneState const &state,
+                                                double          time,
+                                                double          mass);
+
+        /* Performs one step of every lane, the same as gathering the
+         * force of every spring on each point in incidence order and then
+         * integrating each point as IntegrateEuler does.
+         *
+         * Returns a mask with a bit set for every lane which has springs
+         * exerting force or unanchored points with velocity remaining. */
+        unsigned int StepLanes (LaneMesh  const &mesh,
+                                LaneState const &state,
+                                double          time,
+                                double          mass);
+
+        /* The instruction set chosen for the kernels at load time */
+        Isa SelectedIsa ();
+
+        /* Whether the running CPU can execute kernels for isa */
+        bool IsaSupported (Isa isa);
+
+        /* The kernel for a specific instruction set, for comparison
+         * purposes. Returns nullptr if it was not compiled in. */
+        SpringForceKernel SpringForceKernelFor (Isa isa);
+        EulerIntegrationKernel EulerIntegrationKernelFor (Isa isa);
+        LaneStepKernel LaneStepKernelFor (Isa isa);
+    }
+}
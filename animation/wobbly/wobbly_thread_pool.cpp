@@ -0,0 +1,204 @@
+/*
+ * animation/wobbly/wobbly_thread_pool.cpp
+ *
+ * Copyright 2018 Endless Mobile, Inc.
+ *
+ * libanimation is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 2.1 of the
+ * License, or (at your option) any later version.
+ *
+ * libanimation is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with eos-companion-app-service.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Work-stealing thread pool used to step model pools in parallel.
+ */
+#include <cstddef>                      // for size_t
+
+#include <algorithm>                    // for max
+#include <condition_variable>           // for condition_variable
+#include <functional>                   // for function
+#include <memory>                       // for unique_ptr
+#include <mutex>                        // for mutex, lock_guard, unique_lock
+#include <thread>                       // for thread
+#include <vector>                       // for vector
+
+#include <animation/wobbly/wobbly.h>    // for ThreadPool
+
+namespace wobbly
+{
+    class ThreadPool::Private
+    {
+        public:
+
+            explicit Private (size_t nThreads);
+            ~Private ();
+
+            /* The chunks not yet taken by any thread. The owner takes
+             * them from the front and thieves from the back, so that
+             * the owner keeps working through neighbouring chunks. */
+            struct Queue
+            {
+                std::mutex mutex;
+                size_t     begin = 0;
+                size_t     end = 0;
+            };
+
+            bool Take (size_t self, size_t &chunk);
+            void Work (size_t self);
+            void WorkerMain (size_t self);
+
+            /* One per thread, the caller of Run using the first */
+            std::vector <std::unique_ptr <Queue>> mQueues;
+            std::vector <std::thread>             mWorkers;
+
+            std::mutex              mMutex;
+            std::condition_variable mWake;
+            std::condition_variable mDone;
+
+            std::function <void (size_t)> const *mTask = nullptr;
+            unsigned long long                   mGeneration = 0;
+            size_t                               mBusy = 0;
+            bool                                 mQuit = false;
+    };
+}
+
+wobbly::ThreadPool::Private::Private (size_t nThreads)
+{
+    for (size_t i = 0; i < nThreads; ++i)
+        mQueues.emplace_back (new Queue ());
+
+    for (size_t i = 1; i < nThreads; ++i)
+        mWorkers.emplace_back (&Private::WorkerMain, this, i);
+}
+
+wobbly::ThreadPool::Private::~Private ()
+{
+    {
+        std::lock_guard <std::mutex> lock (mMutex);
+        mQuit = true;
+    }
+
+    mWake.notify_all ();
+
+    for (auto &worker : mWorkers)
+        worker.join ();
+}
+
+bool
+wobbly::ThreadPool::Private::Take (size_t self, size_t &chunk)
+{
+    {
+        Queue &own (*mQueues[self]);
+        std::lock_guard <std::mutex> lock (own.mutex);
+
+        if (own.begin < own.end)
+        {
+            chunk = own.begin++;
+            return true;
+        }
+    }
+
+    for (size_t i = 1; i < mQueues.size (); ++i)
+    {
+        Queue &victim (*mQueues[(self + i) % mQueues.size ()]);
+        std::lock_guard <std::mutex> lock (victim.mutex);
+
+        if (victim.begin < victim.end)
+        {
+            chunk = --victim.end;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void
+wobbly::ThreadPool::Private::Work (size_t self)
+{
+    size_t chunk;
+
+    while (Take (self, chunk))
+        (*mTask) (chunk);
+}
+
+void
+wobbly::ThreadPool::Private::WorkerMain (size_t self)
+{
+    unsigned long long seen = 0;
+
+    for (;;)
+    {
+        {
+            std::unique_lock <std::mutex> lock (mMutex);
+            mWake.wait (lock, [this, seen] {
+                return mQuit || mGeneration != seen;
+            });
+
+            if (mQuit)
+                return;
+
+            seen = mGeneration;
+        }
+
+        Work (self);
+
+        {
+            std::lock_guard <std::mutex> lock (mMutex);
+
+            if (--mBusy == 0)
+                mDone.notify_one ();
+        }
+    }
+}
+
+wobbly::ThreadPool::ThreadPool (size_t nThreads) :
+    priv (new Private (nThreads ? nThreads :
+                                  std::max (1u, std::thread::hardware_concurrency ())))
+{
+}
+
+wobbly::ThreadPool::~ThreadPool ()
+{
+}
+
+size_t
+wobbly::ThreadPool::Size () const
+{
+    return priv->mQueues.size ();
+}
+
+void
+wobbly::ThreadPool::Run (size_t nChunks, std::function <void (size_t)> const &task)
+{
+    size_t const nThreads = priv->mQueues.size ();
+
+    /* Nobody else is running, so the queues can be filled before
+     * waking anyone up */
+    for (size_t i = 0; i < nThreads; ++i)
+    {
+        priv->mQueues[i]->begin = nChunks * i / nThreads;
+        priv->mQueues[i]->end = nChunks * (i + 1) / nThreads;
+    }
+
+    {
+        std::lock_guard <std::mutex> lock (priv->mMutex);
+        priv->mTask = &task;
+        priv->mBusy = priv->mWorkers.size ();
+        ++priv->mGeneration;
+    }
+
+    priv->mWake.notify_all ();
+    priv->Work (0);
+
+    std::unique_lock <std::mutex> lock (priv->mMutex);
+    priv->mDone.wait (lock, [this] { return priv->mBusy == 0; });
+    priv->mTask = nullptr;
+}
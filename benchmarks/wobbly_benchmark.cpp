@@ -0,0 +1,722 @@
+/*
+ * benchmarks/wobbly_benchmark.cpp
+ *
+ * Copyright 2018 Endless Mobile, Inc.
+ *
+ * libanimation is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 2.1 of the
+ * License, or (at your option) any later version.
+ *
+ * libanimation is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with eos-companion-app-service.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Measures the cost of stepping the wobbly model at each of the
+ * mesh resolutions that the library provides.
+ */
+#include <algorithm>                    // for max, min
+#include <chrono>                       // for steady_clock, duration_cast
+#include <cmath>                        // for isfinite, sin, cos
+#include <cstddef>                      // for size_t
+#include <cstdio>                       // for printf
+#include <memory>                       // for unique_ptr
+#include <thread>                       // for thread
+#include <vector>                       // for vector
+
+#include <animation/wobbly/wobbly.h>    // for BasicModel, BasicModelPool, etc
+#include <animation/wobbly/wobbly_internal.h>  // for EulerIntegration, etc
+
+namespace
+{
+    namespace agd = animation::geometry::dimension;
+
+    /* Number of times a window is grabbed, moved and let go, so that
+     * each run covers both the grabbed and the settling phases */
+    constexpr unsigned int Repetitions = 2000;
+
+    /* Each step simulates one frame */
+    constexpr unsigned int FrameTime = 16;
+
+    /* How many times some operation was performed and how long it took */
+    struct Measurement
+    {
+        unsigned long long count;
+        double             nanoseconds;
+    };
+
+    template <size_t Width, size_t Height>
+    Measurement MeasureGrabMoveAndSettle ()
+    {
+        typedef wobbly::BasicModel <Width, Height> Model;
+        typedef std::chrono::steady_clock Clock;
+
+        Model model (wobbly::Point (0, 0), 300, 300);
+        unsigned long long steps = 0;
+
+        auto const start = Clock::now ();
+
+        for (unsigned int i = 0; i < Repetitions; ++i)
+        {
+            {
+                wobbly::Anchor grab (model.GrabAnchor (wobbly::Point (150, 0)));
+                grab.MoveBy (wobbly::Point (100, 100));
+
+                for (unsigned int frame = 0; frame < 10; ++frame, ++steps)
+                    model.Step (FrameTime);
+            }
+
+            while (model.Step (FrameTime))
+                ++steps;
+
+            ++steps;
+        }
+
+        auto const elapsed = Clock::now () - start;
+        auto const ns =
+            std::chrono::duration_cast <std::chrono::nanoseconds> (elapsed);
+
+        return { steps, static_cast <double> (ns.count ()) };
+    }
+
+    /* Samples per side of the texture when measuring DeformTexcoords,
+     * about what a compositor would use for a window */
+    constexpr unsigned int DeformSamples = 64;
+
+    template <size_t Width, size_t Height>
+    Measurement MeasureDeform (wobbly::ModelBase::Surface surface)
+    {
+        typedef wobbly::BasicModel <Width, Height> Model;
+        typedef std::chrono::steady_clock Clock;
+
+        Model model (wobbly::Point (0, 0), 300, 300);
+        model.SetSurface (surface);
+
+        /* Deform the mesh so that nothing is trivially linear */
+        {
+            wobbly::Anchor grab (model.GrabAnchor (wobbly::Point (150, 0)));
+            grab.MoveBy (wobbly::Point (100, 100));
+            model.Step (FrameTime * 4);
+        }
+
+        unsigned long long samples = 0;
+        double sink = 0.0;
+
+        auto const start = Clock::now ();
+
+        for (unsigned int i = 0; i < Repetitions / 10; ++i)
+        {
+            for (unsigned int v = 0; v < DeformSamples; ++v)
+            {
+                for (unsigned int u = 0; u < DeformSamples; ++u, ++samples)
+                {
+                    wobbly::Point const unit (u / (DeformSamples - 1.0),
+                                              v / (DeformSamples - 1.0));
+                    sink += agd::get <0> (model.DeformTexcoords (unit));
+                }
+            }
+        }
+
+        auto const elapsed = Clock::now () - start;
+        auto const ns =
+            std::chrono::duration_cast <std::chrono::nanoseconds> (elapsed);
+
+        /* Keep the samples from being optimized away */
+        if (sink == 0.0)
+            std::printf (" ");
+
+        return { samples, static_cast <double> (ns.count ()) };
+    }
+
+    /* The same samples as MeasureDeform, deformed as one grid */
+    template <size_t Width, size_t Height>
+    Measurement MeasureDeformGrid (wobbly::ModelBase::Surface surface)
+    {
+        typedef wobbly::BasicModel <Width, Height> Model;
+        typedef std::chrono::steady_clock Clock;
+
+        Model model (wobbly::Point (0, 0), 300, 300);
+        model.SetSurface (surface);
+
+        {
+            wobbly::Anchor grab (model.GrabAnchor (wobbly::Point (150, 0)));
+            grab.MoveBy (wobbly::Point (100, 100));
+            model.Step (FrameTime * 4);
+        }
+
+        std::vector <double> vertices (DeformSamples * DeformSamples * 2);
+        unsigned long long samples = 0;
+        double sink = 0.0;
+
+        auto const start = Clock::now ();
+
+        for (unsigned int i = 0; i < Repetitions / 10; ++i)
+        {
+            model.DeformGrid (DeformSamples, DeformSamples, vertices.data ());
+            sink += vertices[i % vertices.size ()];
+            samples += DeformSamples * DeformSamples;
+        }
+
+        auto const elapsed = Clock::now () - start;
+        auto const ns =
+            std::chrono::duration_cast <std::chrono::nanoseconds> (elapsed);
+
+        if (sink == 0.0)
+            std::printf (" ");
+
+        return { samples, static_cast <double> (ns.count ()) };
+    }
+
+    /* A window being dragged by the window manager while it is still
+     * wobbling, which moves the model on every configure event */
+    template <size_t Width, size_t Height>
+    Measurement MeasureMoveModelTo ()
+    {
+        typedef wobbly::BasicModel <Width, Height> Model;
+        typedef std::chrono::steady_clock Clock;
+
+        Model model (wobbly::Point (0, 0), 300, 300);
+
+        {
+            wobbly::Anchor grab (model.GrabAnchor (wobbly::Point (150, 0)));
+            grab.MoveBy (wobbly::Point (100, 100));
+            model.Step (FrameTime * 4);
+        }
+
+        unsigned long long moves = 0;
+
+        auto const start = Clock::now ();
+
+        for (unsigned int i = 0; i < Repetitions * 10; ++i, ++moves)
+            model.MoveModelTo (wobbly::Point (i % 100, i % 50));
+
+        auto const elapsed = Clock::now () - start;
+        auto const ns =
+            std::chrono::duration_cast <std::chrono::nanoseconds> (elapsed);
+
+        return { moves, static_cast <double> (ns.count ()) };
+    }
+
+    /* Number of windows wobbling at once when measuring pools, about
+     * what a workspace switch with many windows open looks like */
+    constexpr unsigned int PoolModels = 200;
+
+    /* Grabs and moves every model so that they all start animating */
+    template <typename Model>
+    void Disturb (Model &model, unsigned int i)
+    {
+        wobbly::Anchor grab (model.GrabAnchor (wobbly::Point (i * 10.0, 0)));
+        grab.MoveBy (wobbly::Point (50, 50));
+    }
+
+    /* Steps PoolModels separately allocated models until they settle */
+    template <size_t Width, size_t Height>
+    Measurement MeasureStepEach ()
+    {
+        typedef wobbly::BasicModel <Width, Height> Model;
+        typedef std::chrono::steady_clock Clock;
+
+        std::vector <std::unique_ptr <Model>> models;
+        unsigned long long steps = 0;
+
+        for (unsigned int i = 0; i < PoolModels; ++i)
+        {
+            models.emplace_back (new Model (wobbly::Point (i * 10.0, 0), 300, 300));
+            Disturb (*models.back (), i);
+        }
+
+        auto const start = Clock::now ();
+
+        for (bool animating = true; animating;)
+        {
+            animating = false;
+
+            for (auto &model : models)
+            {
+                animating |= model->Step (FrameTime);
+                ++steps;
+            }
+        }
+
+        auto const elapsed = Clock::now () - start;
+        auto const ns =
+            std::chrono::duration_cast <std::chrono::nanoseconds> (elapsed);
+
+        return { steps, static_cast <double> (ns.count ()) };
+    }
+
+    /* The same as MeasureStepEach, but with the models in a pool */
+    template <size_t Width, size_t Height>
+    Measurement MeasureStepAll ()
+    {
+        typedef std::chrono::steady_clock Clock;
+
+        wobbly::BasicModelPool <Width, Height> pool;
+        unsigned long long steps = 0;
+
+        for (unsigned int i = 0; i < PoolModels; ++i)
+            Disturb (pool.Create (wobbly::Point (i * 10.0, 0), 300, 300), i);
+
+        auto const start = Clock::now ();
+
+        do
+            steps += pool.Size ();
+        while (!pool.StepAll (FrameTime).empty ());
+
+        auto const elapsed = Clock::now () - start;
+        auto const ns =
+            std::chrono::duration_cast <std::chrono::nanoseconds> (elapsed);
+
+        return { steps, static_cast <double> (ns.count ()) };
+    }
+
+    /* The same as MeasureStepAll, spread over nThreads threads */
+    template <size_t Width, size_t Height>
+    Measurement MeasureStepAllThreaded (size_t nThreads)
+    {
+        typedef std::chrono::steady_clock Clock;
+
+        wobbly::BasicModelPool <Width, Height> pool;
+        wobbly::ThreadPool threads (nThreads);
+        unsigned long long steps = 0;
+
+        for (unsigned int i = 0; i < PoolModels; ++i)
+            Disturb (pool.Create (wobbly::Point (i * 10.0, 0), 300, 300), i);
+
+        auto const start = Clock::now ();
+
+        do
+            steps += pool.Size ();
+        while (!pool.StepAll (FrameTime, threads).empty ());
+
+        auto const elapsed = Clock::now () - start;
+        auto const ns =
+            std::chrono::duration_cast <std::chrono::nanoseconds> (elapsed);
+
+        return { steps, static_cast <double> (ns.count ()) };
+    }
+
+    /* A desktop with many windows mapped, only a few of which are
+     * being moved about at any one time */
+    constexpr unsigned int MappedModels = 300;
+    constexpr unsigned int MovingModels = 5;
+
+    /* Steps a pool of MappedModels for as many frames as it takes for
+     * MovingModels of them to be let go and settle, Repetitions times
+     * over. Returns the number of frames stepped. */
+    template <size_t Width, size_t Height>
+    Measurement MeasureMostlySettled ()
+    {
+        typedef std::chrono::steady_clock Clock;
+
+        wobbly::BasicModelPool <Width, Height> pool;
+        std::vector <wobbly::BasicModel <Width, Height> *> models;
+        unsigned long long frames = 0;
+
+        for (unsigned int i = 0; i < MappedModels; ++i)
+            models.push_back (&pool.Create (wobbly::Point (i * 10.0, 0), 300, 300));
+
+        auto const start = Clock::now ();
+
+        for (unsigned int r = 0; r < Repetitions; ++r)
+        {
+            for (unsigned int i = 0; i < MovingModels; ++i)
+                Disturb (*models[(r * MovingModels + i) % MappedModels], i);
+
+            do
+                ++frames;
+            while (!pool.StepAll (FrameTime).empty ());
+        }
+
+        auto const elapsed = Clock::now () - start;
+        auto const ns =
+            std::chrono::duration_cast <std::chrono::nanoseconds> (elapsed);
+
+        return { frames, static_cast <double> (ns.count ()) };
+    }
+
+    /* Measures nudging a corner of a model back and forth and then holding
+     * it still until the mesh settles, counting how many points were
+     * asleep in each frame */
+    template <size_t Width, size_t Height>
+    Measurement MeasureHeldCorner (unsigned long long &sleeping)
+    {
+        typedef wobbly::BasicModel <Width, Height> Model;
+        typedef std::chrono::steady_clock Clock;
+
+        Model model (wobbly::Point (0, 0), 300, 300);
+        wobbly::Anchor grab (model.GrabAnchor (wobbly::Point (0, 0)));
+        unsigned long long frames = 0;
+
+        sleeping = 0;
+
+        auto const start = Clock::now ();
+
+        for (unsigned int r = 0; r < Repetitions; ++r)
+        {
+            double const direction = r % 2 ? -1.0 : 1.0;
+
+            for (unsigned int frame = 0; frame < 10; ++frame, ++frames)
+            {
+                grab.MoveBy (wobbly::Point (direction * 2.0, direction));
+                model.Step (FrameTime);
+                sleeping += model.SleepingPoints ();
+            }
+
+            for (unsigned int frame = 0; frame < 100; ++frame, ++frames)
+            {
+                model.Step (FrameTime);
+                sleeping += model.SleepingPoints ();
+            }
+        }
+
+        auto const elapsed = Clock::now () - start;
+        auto const ns =
+            std::chrono::duration_cast <std::chrono::nanoseconds> (elapsed);
+
+        return { frames, static_cast <double> (ns.count ()) };
+    }
+
+    /* Length of the gap after a stall which MeasureCatchUp steps over */
+    constexpr unsigned int StallTime = 500;
+
+    /* Measures stepping a freshly disturbed model over StallTime, either
+     * in one call to Step or in one call per frame */
+    template <size_t Width, size_t Height>
+    Measurement MeasureCatchUp (unsigned int frameTime)
+    {
+        typedef wobbly::BasicModel <Width, Height> Model;
+        typedef std::chrono::steady_clock Clock;
+
+        Model model (wobbly::Point (0, 0), 300, 300);
+        unsigned long long stalls = 0;
+        double ns = 0.0;
+
+        for (unsigned int i = 0; i < Repetitions; ++i, ++stalls)
+        {
+            wobbly::Anchor grab (model.GrabAnchor (wobbly::Point (150, 0)));
+            grab.MoveBy (wobbly::Point (i % 2 ? 100 : -100, 100));
+
+            auto const start = Clock::now ();
+
+            for (unsigned int time = 0; time < StallTime; time += frameTime)
+                model.Step (std::min (frameTime, StallTime - time));
+
+            auto const elapsed = Clock::now () - start;
+            ns += std::chrono::duration_cast <std::chrono::nanoseconds> (elapsed).count ();
+        }
+
+        return { stalls, ns };
+    }
+
+    template <size_t Width, size_t Height>
+    void ReportCatchUp ()
+    {
+        Measurement const once (MeasureCatchUp <Width, Height> (StallTime));
+        Measurement const frames (MeasureCatchUp <Width, Height> (FrameTime));
+
+        std::printf ("%zux%zu mesh, %u ms stall: %.1f ns (caught up), "
+                     "%.1f ns (every frame)\n",
+                     Width,
+                     Height,
+                     StallTime,
+                     once.nanoseconds / once.count,
+                     frames.nanoseconds / frames.count);
+    }
+
+    /* Frames after which MeasureAdaptive gives up on a mesh settling,
+     * since stiff springs can chatter about where they would rest */
+    constexpr unsigned int MaximumAdaptiveFrames = 300;
+
+    /* Measures settling a model from a drag with the given spring
+     * constant, one call to Step per frame, counting integrations
+     * as well as frames */
+    Measurement MeasureAdaptive (double       springConstant,
+                                 bool         adaptive,
+                                 unsigned int &integrations)
+    {
+        typedef std::chrono::steady_clock Clock;
+
+        wobbly::Model::Settings settings (wobbly::Model::DefaultSettings);
+        settings.springConstant = springConstant;
+
+        wobbly::Model model (wobbly::Point (0, 0), 300, 300, settings);
+        model.SetAdaptiveStepping (adaptive);
+
+        unsigned long long frames = 0;
+        integrations = 0;
+
+        auto const start = Clock::now ();
+
+        for (unsigned int i = 0; i < Repetitions / 10; ++i)
+        {
+            {
+                wobbly::Anchor grab (model.GrabAnchor (wobbly::Point (150, 0)));
+                grab.MoveBy (wobbly::Point (i % 2 ? 100 : -100, 100));
+            }
+
+            for (unsigned int n = 0; n < MaximumAdaptiveFrames; ++n, ++frames)
+            {
+                bool const more = model.Step (FrameTime);
+                integrations += model.SubSteps ();
+
+                if (!more)
+                    break;
+            }
+        }
+
+        auto const elapsed = Clock::now () - start;
+        auto const ns =
+            std::chrono::duration_cast <std::chrono::nanoseconds> (elapsed);
+
+        return { frames, static_cast <double> (ns.count ()) };
+    }
+
+    /* Fixed steps are only compared where they would not diverge */
+    void ReportAdaptive (double springConstant)
+    {
+        unsigned int fixedIntegrations, adaptiveIntegrations;
+        Measurement const adaptive (MeasureAdaptive (springConstant, true, adaptiveIntegrations));
+
+        std::printf ("k = %.0f: %.1f ns/frame, %.2f integrations/frame (adaptive)",
+                     springConstant,
+                     adaptive.nanoseconds / adaptive.count,
+                     static_cast <double> (adaptiveIntegrations) / adaptive.count);
+
+        double const stable = wobbly::StableEulerStep (springConstant,
+                                                       wobbly::Model::DefaultSettings.friction,
+                                                       wobbly::Model::Mass);
+
+        if (stable > 1.0)
+        {
+            Measurement const fixed (MeasureAdaptive (springConstant, false, fixedIntegrations));
+
+            std::printf (", %.1f ns/frame, %.2f integrations/frame (fixed)",
+                         fixed.nanoseconds / fixed.count,
+                         static_cast <double> (fixedIntegrations) / fixed.count);
+        }
+        else
+        {
+            std::printf (", diverges (fixed)");
+        }
+
+        std::printf ("\n");
+    }
+
+    /* Steps after which a disturbed mesh is taken to have diverged */
+    constexpr unsigned int MaximumSettleSteps = 10000;
+
+    /* Disturbs a mesh with one corner anchored and integrates it with
+     * steps of the given length at the default spring constant and
+     * friction, returning how many steps it took to come to rest, or
+     * MaximumSettleSteps if it never did */
+    template <typename Strategy>
+    unsigned int StepsToSettle (double time, double disturbance)
+    {
+        typedef wobbly::ModelBase MB;
+
+        animation::Vector const tileSize (100.0, 100.0);
+        wobbly::MeshArray positions;
+
+        for (size_t i = 0; i < wobbly::config::TotalIndices; ++i)
+        {
+            animation::PointView <double> point (positions, i);
+            agd::assign (point,
+                         wobbly::Point ((i % wobbly::config::Width) * 100.0 +
+                                        std::sin (i * 1.7) * disturbance,
+                                        (i / wobbly::config::Width) * 100.0 +
+                                        std::cos (i * 2.3) * disturbance));
+        }
+
+        wobbly::SpringMesh mesh (positions, tileSize);
+        wobbly::AnchorArray anchors;
+        anchors.Lock (0);
+
+        Strategy strategy;
+
+        for (unsigned int step = 1; step < MaximumSettleSteps; ++step)
+        {
+            auto const result = mesh.CalculateForces (MB::DefaultSpringConstant);
+            bool const more = strategy.StepAll (time,
+                                                MB::Friction,
+                                                MB::Mass,
+                                                positions,
+                                                result.forces,
+                                                anchors.AnchorMask ());
+
+            for (double coordinate : positions)
+                if (!std::isfinite (coordinate) || std::fabs (coordinate) > 1e6)
+                    return MaximumSettleSteps;
+
+            if (!more)
+                return step;
+        }
+
+        return MaximumSettleSteps;
+    }
+
+    /* Finds the longest step, in units of the usual step, with which a
+     * strategy still settles a range of disturbances, along with how
+     * many steps it takes to settle at the usual step and at that one */
+    template <typename Strategy>
+    void ReportStability (char const *name)
+    {
+        double const disturbances[] = { 5.0, 20.0, 100.0 };
+        double const increment = 0.05;
+
+        auto const totalSteps = [&disturbances](double time) {
+            unsigned int total = 0;
+            for (double disturbance : disturbances)
+                total += StepsToSettle <Strategy> (time, disturbance);
+            return total;
+        };
+
+        auto const settles = [&disturbances](double time) {
+            for (double disturbance : disturbances)
+                if (StepsToSettle <Strategy> (time, disturbance) == MaximumSettleSteps)
+                    return false;
+            return true;
+        };
+
+        double longest = 1.0;
+        while (settles (longest + increment))
+            longest += increment;
+
+        std::printf ("%s: settles with steps up to %.2fx as long, "
+                     "%u steps to settle (1x), %u steps to settle (%.2fx)\n",
+                     name,
+                     longest,
+                     totalSteps (1.0),
+                     totalSteps (longest),
+                     longest);
+    }
+
+    template <size_t Width, size_t Height>
+    void ReportMostlySettled ()
+    {
+        Measurement const m (MeasureMostlySettled <Width, Height> ());
+
+        std::printf ("%zux%zu mesh, %u models, %u moving: %.1f ns/frame\n",
+                     Width,
+                     Height,
+                     MappedModels,
+                     MovingModels,
+                     m.nanoseconds / m.count);
+    }
+
+    template <size_t Width, size_t Height>
+    void ReportHeldCorner ()
+    {
+        unsigned long long sleeping;
+        Measurement const m (MeasureHeldCorner <Width, Height> (sleeping));
+
+        std::printf ("%zux%zu mesh, corner held: %.1f ns/frame, "
+                     "%.0f%% of points asleep\n",
+                     Width,
+                     Height,
+                     m.nanoseconds / m.count,
+                     100.0 * sleeping / (m.count * Width * Height));
+    }
+
+    /* Doubles the number of threads up to one per hardware thread */
+    template <size_t Width, size_t Height>
+    void ReportScaling ()
+    {
+        size_t const hardware = std::max (1u, std::thread::hardware_concurrency ());
+
+        for (size_t n = 1; ; n = std::min (n * 2, hardware))
+        {
+            Measurement const m (MeasureStepAllThreaded <Width, Height> (n));
+
+            std::printf ("%zux%zu mesh, %u models, %zu threads: %.1f ns/model step\n",
+                         Width,
+                         Height,
+                         PoolModels,
+                         n,
+                         m.nanoseconds / m.count);
+
+            if (n == hardware)
+                break;
+        }
+    }
+
+    template <size_t Width, size_t Height>
+    void ReportPool ()
+    {
+        Measurement const each (MeasureStepEach <Width, Height> ());
+        Measurement const all (MeasureStepAll <Width, Height> ());
+
+        std::printf ("%zux%zu mesh, %u models: %.1f ns/model step (separate), "
+                     "%.1f ns/model step (pool)\n",
+                     Width,
+                     Height,
+                     PoolModels,
+                     each.nanoseconds / each.count,
+                     all.nanoseconds / all.count);
+    }
+
+    template <size_t Width, size_t Height>
+    void Report ()
+    {
+        typedef wobbly::ModelBase::Surface Surface;
+
+        Measurement const m (MeasureGrabMoveAndSettle <Width, Height> ());
+        Measurement const single (MeasureDeform <Width, Height> (Surface::SinglePatch));
+        Measurement const piecewise (MeasureDeform <Width, Height> (Surface::PiecewiseBicubic));
+        Measurement const singleGrid (MeasureDeformGrid <Width, Height> (Surface::SinglePatch));
+        Measurement const piecewiseGrid (MeasureDeformGrid <Width, Height> (Surface::PiecewiseBicubic));
+        Measurement const move (MeasureMoveModelTo <Width, Height> ());
+
+        std::printf ("%zux%zu mesh: %llu steps, %.1f ns/step, "
+                     "%.1f ns/sample (single patch), "
+                     "%.1f ns/sample (piecewise), "
+                     "%.1f ns/grid sample (single patch), "
+                     "%.1f ns/grid sample (piecewise), "
+                     "%.1f ns/MoveModelTo\n",
+                     Width,
+                     Height,
+                     m.count,
+                     m.nanoseconds / m.count,
+                     single.nanoseconds / single.count,
+                     piecewise.nanoseconds / piecewise.count,
+                     singleGrid.nanoseconds / singleGrid.count,
+                     piecewiseGrid.nanoseconds / piecewiseGrid.count,
+                     move.nanoseconds / move.count);
+    }
+}
+
+int main ()
+{
+    Report <3, 3> ();
+    Report <4, 4> ();
+    Report <8, 8> ();
+
+    ReportPool <4, 4> ();
+    ReportPool <8, 8> ();
+
+    ReportScaling <4, 4> ();
+    ReportScaling <8, 8> ();
+
+    ReportMostlySettled <4, 4> ();
+    ReportMostlySettled <8, 8> ();
+
+    ReportHeldCorner <4, 4> ();
+    ReportHeldCorner <8, 8> ();
+
+    ReportCatchUp <4, 4> ();
+    ReportCatchUp <8, 8> ();
+
+    ReportStability <wobbly::EulerIntegration> ("Euler");
+    ReportStability <wobbly::SymplecticEulerIntegration> ("Symplectic Euler");
+    ReportStability <wobbly::VerletIntegration> ("Verlet");
+
+    ReportAdaptive (wobbly::Model::DefaultSettings.springConstant);
+    ReportAdaptive (100.0);
+
+    return 0;
+}
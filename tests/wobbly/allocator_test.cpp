@@ -0,0 +1,338 @@
+/*
+ * tests/wobbly/allocator_test.cpp
+ *
+ * Copyright 2018 Endless Mobile, Inc.
+ *
+ * libanimation is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 2.1 of the
+ * License, or (at your option) any later version.
+ *
+ * libanimation is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with eos-companion-app-service.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Tests for allocating models and anchors without going to the heap.
+ * These replace the global operator new, so they are built into an
+ * executable of their own.
+ */
+#include <array>                        // for array
+#include <atomic>                       // for atomic
+#include <cstddef>                      // for size_t
+#include <cstdlib>                      // for malloc, free
+#include <new>                          // for bad_alloc, nothrow_t
+
+#include <gmock/gmock.h>                // IWYU pragma: keep
+#include <gtest/gtest.h>                // for AssertHelper, TEST_F, etc
+
+#include <animation/wobbly/wobbly.h>    // for Model, Allocator, etc
+
+using ::testing::Test;
+
+namespace
+{
+    /* Every allocation made through operator new by anything in the
+     * test program, see below */
+    std::atomic <size_t> heapAllocations (0);
+}
+
+/* The replacements are kept out of line. If operator new were inlined
+ * into a caller, the compiler would see malloc () there and warn that
+ * the pointer goes to operator delete rather than free () */
+__attribute__ ((noinline)) void * operator new (size_t size)
+{
+    ++heapAllocations;
+
+    if (void *block = std::malloc (size ? size : 1))
+        return block;
+
+    throw std::bad_alloc ();
+}
+
+__attribute__ ((noinline)) void * operator new (size_t size,
+                                                std::nothrow_t const &) noexcept
+{
+    ++heapAllocations;
+    return std::malloc (size ? size : 1);
+}
+
+__attribute__ ((noinline)) void operator delete (void *block) noexcept
+{
+    std::free (block);
+}
+
+void operator delete (void *block, size_t) noexcept
+{
+    ::operator delete (block);
+}
+
+namespace
+{
+    constexpr double TextureWidth = 50.0;
+    constexpr double TextureHeight = 100.0;
+
+    /* Counts whatever goes through it to the heap */
+    class CountingAllocator :
+        public wobbly::Allocator
+    {
+        public:
+
+            void * Allocate (size_t size) override
+            {
+                ++allocations;
+                return Heap ().Allocate (size);
+            }
+
+            void Deallocate (void *block, size_t size) noexcept override
+            {
+                ++deallocations;
+                Heap ().Deallocate (block, size);
+            }
+
+            size_t allocations = 0;
+            size_t deallocations = 0;
+    };
+
+    /* Counts calls to operator new while it is alive */
+    class HeapAllocations
+    {
+        public:
+
+            HeapAllocations () :
+                start (heapAllocations)
+            {
+            }
+
+            size_t Count () const
+            {
+                return heapAllocations - start;
+            }
+
+        private:
+
+            size_t start;
+    };
+
+    TEST (RecyclingAllocator, GivesBackBlocksOfTheSameSize)
+    {
+        CountingAllocator upstream;
+        wobbly::RecyclingAllocator recycler (upstream);
+
+        void *first = recycler.Allocate (100);
+        recycler.Deallocate (first, 100);
+
+        /* 100 and 120 bytes are in the same size class */
+        void *second = recycler.Allocate (120);
+        recycler.Deallocate (second, 120);
+
+        EXPECT_EQ (first, second);
+        EXPECT_EQ (1, upstream.allocations);
+    }
+
+    TEST (RecyclingAllocator, DifferentSizeClassesAreKeptApart)
+    {
+        CountingAllocator upstream;
+        wobbly::RecyclingAllocator recycler (upstream);
+
+        void *small = recycler.Allocate (16);
+        recycler.Deallocate (small, 16);
+
+        void *large = recycler.Allocate (64);
+        recycler.Deallocate (large, 64);
+
+        EXPECT_NE (small, large);
+        EXPECT_EQ (2, upstream.allocations);
+    }
+
+    TEST (RecyclingAllocator, LargeBlocksAlwaysGoUpstream)
+    {
+        constexpr size_t Size = wobbly::RecyclingAllocator::LargestRecycled + 1;
+
+        CountingAllocator upstream;
+        wobbly::RecyclingAllocator recycler (upstream);
+
+        for (size_t i = 0; i < 3; ++i)
+            recycler.Deallocate (recycler.Allocate (Size), Size);
+
+        EXPECT_EQ (3, upstream.allocations);
+        EXPECT_EQ (3, upstream.deallocations);
+    }
+
+    TEST (RecyclingAllocator, GivesEverythingBackWhenDestroyed)
+    {
+        CountingAllocator upstream;
+
+        {
+            wobbly::RecyclingAllocator recycler (upstream);
+            std::array <void *, 8> blocks;
+
+            for (size_t i = 0; i < blocks.size (); ++i)
+                blocks[i] = recycler.Allocate (8 << i);
+
+            for (size_t i = 0; i < blocks.size (); ++i)
+                recycler.Deallocate (blocks[i], 8 << i);
+
+            EXPECT_EQ (0, upstream.deallocations);
+        }
+
+        EXPECT_EQ (upstream.allocations, upstream.deallocations);
+    }
+
+    class ModelAllocation :
+        public Test
+    {
+        public:
+
+            ModelAllocation () :
+                model (animation::Point (0, 0),
+                       TextureWidth,
+                       TextureHeight,
+                       wobbly::Model::DefaultSettings,
+                       recycler)
+            {
+            }
+
+            /* Does the same as a pointer drag would, twice over, so that
+             * anything which is only allocated the first time around has
+             * been by the time the second one starts */
+            template <typename Create>
+            size_t AllocationsDuringSecondDrag (Create const &create)
+            {
+                auto const drag = [this, &create]() {
+                    wobbly::Anchor anchor (create (model));
+
+                    for (size_t i = 0; i < 5; ++i)
+                    {
+                        anchor.MoveBy (animation::Point (10, 5));
+                        model.Step (16);
+                    }
+                };
+
+                drag ();
+                model.Step (16);
+
+                HeapAllocations allocations;
+
+                drag ();
+                model.Step (16);
+
+                return allocations.Count ();
+            }
+
+            wobbly::RecyclingAllocator recycler;
+            wobbly::Model              model;
+    };
+
+    TEST_F (ModelAllocation, NoHeapTrafficGrabbing)
+    {
+        EXPECT_EQ (0, AllocationsDuringSecondDrag ([](wobbly::Model &model) {
+            return model.GrabAnchor (animation::Point (10, 10));
+        }));
+    }
+
+    TEST_F (ModelAllocation, NoHeapTrafficInserting)
+    {
+        EXPECT_EQ (0, AllocationsDuringSecondDrag ([](wobbly::Model &model) {
+            return model.InsertAnchor (animation::Point (25, 0));
+        }));
+    }
+
+    TEST_F (ModelAllocation, NoHeapTrafficWithQueuedAnchors)
+    {
+        EXPECT_EQ (0, AllocationsDuringSecondDrag ([](wobbly::Model &model) {
+            return model.GrabQueuedAnchor (animation::Point (10, 10));
+        }));
+    }
+
+    TEST_F (ModelAllocation, ModelAndAnchorsComeFromAllocator)
+    {
+        CountingAllocator counting;
+
+        {
+            wobbly::Model model (animation::Point (0, 0),
+                                 TextureWidth,
+                                 TextureHeight,
+                                 wobbly::Model::DefaultSettings,
+                                 counting);
+            size_t const forModel = counting.allocations;
+
+            wobbly::Anchor grab (model.GrabAnchor (animation::Point (10, 10)));
+
+            EXPECT_LT (0, forModel);
+            EXPECT_EQ (forModel + 1, counting.allocations);
+        }
+
+        EXPECT_EQ (counting.allocations, counting.deallocations);
+    }
+
+    /* The catch-up integrator only needs its factor after a long gap
+     * between steps, so a model should not carry it until then. It
+     * comes from the heap rather than the model's allocator, since a
+     * pool may step the model on another thread */
+    TEST_F (ModelAllocation, CatchUpFactorOnlyAllocatedWhenCatchingUp)
+    {
+        CountingAllocator counting;
+        wobbly::Model model (animation::Point (0, 0),
+                             TextureWidth,
+                             TextureHeight,
+                             wobbly::Model::DefaultSettings,
+                             counting);
+
+        {
+            wobbly::Anchor grab (model.GrabAnchor (animation::Point (10, 10)));
+            grab.MoveBy (animation::Point (20, 10));
+        }
+
+        model.Step (16);
+        size_t const stepping = counting.allocations;
+
+        {
+            HeapAllocations heap;
+            model.Step (16);
+            EXPECT_EQ (0, heap.Count ());
+        }
+
+        HeapAllocations heap;
+        model.Step (1000);
+        EXPECT_EQ (1, heap.Count ());
+        EXPECT_EQ (stepping, counting.allocations);
+    }
+
+    TEST (PooledModelAllocation, NoHeapTrafficRecreatingModels)
+    {
+        wobbly::ModelPool pool;
+
+        /* Not a vector, which would go to the heap itself */
+        auto const storm = [&pool]() {
+            std::array <wobbly::Model *, 20> models;
+
+            for (size_t i = 0; i < models.size (); ++i)
+                models[i] = &pool.Create (animation::Point (i * 100.0, 0),
+                                          TextureWidth,
+                                          TextureHeight);
+
+            for (wobbly::Model *model : models)
+            {
+                wobbly::Anchor grab (model->GrabAnchor (animation::Point (0, 0)));
+                grab.MoveBy (animation::Point (10, 10));
+            }
+
+            pool.StepAll (16);
+
+            for (wobbly::Model *model : models)
+                pool.Destroy (*model);
+        };
+
+        storm ();
+
+        HeapAllocations allocations;
+        storm ();
+
+        EXPECT_EQ (0, allocations.Count ());
+    }
+}
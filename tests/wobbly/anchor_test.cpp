@@ -19,8 +19,11 @@
  *
  * Tests for the "wobbly" spring model.
  */
+#include <array>                        // for array
+#include <atomic>                       // for atomic
 #include <cstddef>                      // for size_t
 #include <functional>                   // for bind, __bind, _1
+#include <thread>                       // for thread
 
 #include <gmock/gmock-cardinalities.h>  // for AtLeast
 #include <gmock/gmock-generated-function-mockers.h>  // for FunctionMocker, etc
@@ -28,6 +31,7 @@
 #include <gmock/gmock-spec-builders.h>  // for EXPECT_CALL, etc
 #include <gtest/gtest.h>                // for TEST_F, Test, Types, etc
 
+#include <animation/wobbly/wobbly.h>    // for Model, Anchor, etc
 #include <animation/wobbly/wobbly_internal.h>            // for TrackedAnchors
 
 using ::testing::_;
@@ -135,4 +139,176 @@ namespace
         anchors.WithFirstGrabbed (std::bind (&MockAnchorAction::Action,
                                              &action, _1));
     }
+
+    TEST_F (TrackedAnchors, MaskHasBitSetForEachLockedIndex)
+    {
+        anchors.Lock (0);
+        anchors.Lock (2);
+        anchors.Lock (2);
+
+        EXPECT_EQ (0x5u, anchors.AnchorMask ()[0]);
+    }
+
+    TEST_F (TrackedAnchors, MaskBitClearedWhenFullyUnlocked)
+    {
+        anchors.Lock (1);
+        anchors.Lock (1);
+        anchors.Unlock (1);
+
+        EXPECT_EQ (0x2u, anchors.AnchorMask ()[0]);
+
+        anchors.Unlock (1);
+
+        EXPECT_EQ (0x0u, anchors.AnchorMask ()[0]);
+    }
+
+    constexpr double TextureWidth = 100.0;
+    constexpr double TextureHeight = 100.0;
+
+    void ExpectSameExtremes (wobbly::Model const &expected,
+                             wobbly::Model const &actual)
+    {
+        namespace agd = animation::geometry::dimension;
+
+        std::array <animation::Point, 4> const e (expected.Extremes ());
+        std::array <animation::Point, 4> const a (actual.Extremes ());
+
+        for (size_t corner = 0; corner < 4; ++corner)
+        {
+            EXPECT_EQ (agd::get <0> (e[corner]), agd::get <0> (a[corner]));
+            EXPECT_EQ (agd::get <1> (e[corner]), agd::get <1> (a[corner]));
+        }
+    }
+
+    class QueuedAnchor :
+        public Test
+    {
+        public:
+
+            QueuedAnchor () :
+                immediate (animation::Point (0, 0), TextureWidth, TextureHeight),
+                queued (animation::Point (0, 0), TextureWidth, TextureHeight)
+            {
+            }
+
+            wobbly::Model immediate;
+            wobbly::Model queued;
+    };
+
+    TEST_F (QueuedAnchor, MovesNothingUntilStepped)
+    {
+        wobbly::Model still (animation::Point (0, 0), TextureWidth, TextureHeight);
+        wobbly::Anchor grab (queued.GrabQueuedAnchor (animation::Point (0, 0)));
+
+        grab.MoveBy (animation::Point (20, 10));
+
+        ExpectSameExtremes (still, queued);
+    }
+
+    TEST_F (QueuedAnchor, StepsLikeImmediateAnchor)
+    {
+        wobbly::Anchor direct (immediate.GrabAnchor (animation::Point (0, 0)));
+        wobbly::Anchor grab (queued.GrabQueuedAnchor (animation::Point (0, 0)));
+
+        direct.MoveBy (animation::Point (20, 10));
+        grab.MoveBy (animation::Point (20, 10));
+
+        for (size_t i = 0; i < 10; ++i)
+        {
+            immediate.Step (16);
+            queued.Step (16);
+
+            ExpectSameExtremes (immediate, queued);
+        }
+    }
+
+    TEST_F (QueuedAnchor, InsertedStepsLikeImmediateAnchor)
+    {
+        wobbly::Anchor direct (immediate.InsertAnchor (animation::Point (50, 50)));
+        wobbly::Anchor grab (queued.InsertQueuedAnchor (animation::Point (50, 50)));
+
+        direct.MoveBy (animation::Point (20, 10));
+        grab.MoveBy (animation::Point (20, 10));
+
+        for (size_t i = 0; i < 10; ++i)
+        {
+            immediate.Step (16);
+            queued.Step (16);
+
+            ExpectSameExtremes (immediate, queued);
+        }
+    }
+
+    TEST_F (QueuedAnchor, PendingMovesAppliedOnRelease)
+    {
+        {
+            wobbly::Anchor direct (immediate.GrabAnchor (animation::Point (0, 0)));
+            wobbly::Anchor grab (queued.GrabQueuedAnchor (animation::Point (0, 0)));
+
+            direct.MoveBy (animation::Point (20, 10));
+            grab.MoveBy (animation::Point (20, 10));
+        }
+
+        ExpectSameExtremes (immediate, queued);
+    }
+
+    TEST_F (QueuedAnchor, PooledModelStepsLikeImmediateAnchor)
+    {
+        wobbly::ModelPool pool;
+        wobbly::Model &pooled (pool.Create (animation::Point (0, 0),
+                                            TextureWidth,
+                                            TextureHeight));
+
+        /* Two grabs, so that the model is still stepped in lanes */
+        wobbly::Anchor first (immediate.GrabAnchor (animation::Point (0, 0)));
+        wobbly::Anchor second (immediate.GrabAnchor (animation::Point (100, 100)));
+        wobbly::Anchor pooledFirst (pooled.GrabQueuedAnchor (animation::Point (0, 0)));
+        wobbly::Anchor pooledSecond (pooled.GrabQueuedAnchor (animation::Point (100, 100)));
+
+        first.MoveBy (animation::Point (20, 10));
+        pooledFirst.MoveBy (animation::Point (20, 10));
+
+        for (size_t i = 0; i < 10; ++i)
+        {
+            immediate.Step (16);
+            pool.StepAll (16);
+
+            ExpectSameExtremes (immediate, pooled);
+        }
+    }
+
+    /* Moves the anchor from another thread while the model is stepped,
+     * then checks that the mesh settles exactly where it would have
+     * for the same total movement made on the stepping thread */
+    TEST_F (QueuedAnchor, NoMovesLostWhileStepping)
+    {
+        constexpr size_t Moves = 20000;
+        animation::Point const delta (0.25, -0.125);
+
+        wobbly::Anchor direct (immediate.GrabAnchor (animation::Point (0, 0)));
+        wobbly::Anchor grab (queued.GrabQueuedAnchor (animation::Point (0, 0)));
+
+        direct.MoveBy (animation::Point (Moves * 0.25, Moves * -0.125));
+
+        std::atomic <bool> sent (false);
+        std::thread input ([&grab, &delta, &sent]() {
+            for (size_t i = 0; i < Moves; ++i)
+                grab.MoveBy (delta);
+
+            sent = true;
+        });
+
+        while (!sent)
+        {
+            queued.Step (16);
+            std::this_thread::yield ();
+        }
+
+        input.join ();
+
+        while (immediate.Step (16));
+        while (queued.Step (16));
+
+        ExpectSameExtremes (immediate, queued);
+    }
 }
@@ -0,0 +1,295 @@
+/*
+ * tests/wobbly/equilibrium_test.cpp
+ *
+ * Copyright 2018 Endless Mobile, Inc.
+ *
+ * libanimation is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 2.1 of the
+ * License, or (at your option) any later version.
+ *
+ * libanimation is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with eos-companion-app-service.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Tests for the direct solver for the rest position of the mesh,
+ * checking it against integrating the mesh until it settles.
+ */
+#include <algorithm>                    // for max
+#include <cmath>                        // for sin, cos
+#include <cstddef>                      // for size_t
+
+#include <gmock/gmock-matchers.h>       // for EXPECT_THAT, etc
+#include <gmock/gmock.h>                // IWYU pragma: keep
+#include <gtest/gtest.h>                // for AssertHelper, TEST_F, etc
+
+#include <animation/wobbly/wobbly.h>    // for Point, Vector
+#include <animation/wobbly/wobbly_internal.h>  // for EquilibriumSolver, etc
+
+#include <mathematical_model_matcher.h>  // for Eq, EqDispatchHelper, etc
+#include <ostream_point_operator.h>     // for operator<<
+
+using ::testing::Test;
+
+using ::animation::matchers::Eq;
+
+namespace
+{
+    constexpr double SpringConstant = wobbly::Model::DefaultSpringConstant;
+    constexpr double Friction = wobbly::Model::Friction;
+    constexpr double Mass = wobbly::Model::Mass;
+    constexpr size_t MaximumSteps = 2000;
+
+    class EquilibriumSolver :
+        public Test
+    {
+        public:
+
+            EquilibriumSolver () :
+                tileSize (20.0, 30.0)
+            {
+                wobbly::mesh::CalculatePositionArray (animation::Point (0, 0),
+                                                      positions,
+                                                      tileSize);
+                velocities.fill (0.0);
+            }
+
+            /* Moves every point away from its rest position */
+            void Disturb ()
+            {
+                for (size_t i = 0; i < wobbly::config::TotalIndices; ++i)
+                {
+                    positions[i * 2] += std::sin (i) * 15.0;
+                    positions[i * 2 + 1] += std::cos (i) * 10.0;
+                }
+            }
+
+            wobbly::MeshArray Solve ()
+            {
+                wobbly::MeshArray settled;
+                solver.Solve (positions,
+                              velocities,
+                              anchors,
+                              tileSize,
+                              Friction,
+                              Mass,
+                              1.0,
+                              settled);
+                return settled;
+            }
+
+            wobbly::MeshArray Integrate ()
+            {
+                wobbly::MeshArray points (positions);
+                wobbly::EulerIntegration integrator;
+                integrator.Velocities () = velocities;
+
+                double const springConstant = SpringConstant;
+                double const friction = Friction;
+                wobbly::SpringStep <wobbly::EulerIntegration> step (integrator,
+                                                                     points,
+                                                                     springConstant,
+                                                                     friction,
+                                                                     tileSize);
+
+                /* Points pulled between several anchors never stop
+                 * exerting force, but they do stop moving */
+                for (size_t i = 0; i < MaximumSteps && step (points, anchors); ++i);
+
+                return points;
+            }
+
+            /* Integration stops once the delta on each spring drops under
+             * the clip threshold, so it only ends up near the exact rest
+             * position, the error adding up along each row and column */
+            void ExpectNearIntegration (wobbly::MeshArray const &settled)
+            {
+                double const tolerance = wobbly::Spring::ClipThreshold *
+                                         (wobbly::config::Width - 1);
+
+                wobbly::MeshArray const integrated (Integrate ());
+
+                for (size_t i = 0; i < settled.size (); ++i)
+                    EXPECT_NEAR (integrated[i], settled[i], tolerance) << i;
+            }
+
+            animation::Vector          tileSize;
+            wobbly::MeshArray          positions;
+            wobbly::MeshArray          velocities;
+            wobbly::AnchorArray        anchors;
+            wobbly::EquilibriumSolver <wobbly::config::Width,
+                                       wobbly::config::Height> solver;
+    };
+
+    TEST_F (EquilibriumSolver, MeshAtRestStaysWhereItIs)
+    {
+        wobbly::MeshArray const settled (Solve ());
+
+        for (size_t i = 0; i < settled.size (); ++i)
+            EXPECT_DOUBLE_EQ (positions[i], settled[i]);
+    }
+
+    TEST_F (EquilibriumSolver, SingleAnchorGivesRestShapeAroundAnchor)
+    {
+        Disturb ();
+        anchors.Lock (5);
+
+        wobbly::MeshArray const settled (Solve ());
+
+        animation::Point topLeft (positions[10] - tileSize.x,
+                                  positions[11] - tileSize.y);
+
+        EXPECT_THAT (animation::Point (settled[0], settled[1]),
+                     Eq (topLeft));
+        ExpectNearIntegration (settled);
+    }
+
+    TEST_F (EquilibriumSolver, AnchoredPointsDoNotMove)
+    {
+        Disturb ();
+        anchors.Lock (0);
+        anchors.Lock (wobbly::config::TotalIndices - 1);
+
+        wobbly::MeshArray const settled (Solve ());
+
+        EXPECT_EQ (positions[0], settled[0]);
+        EXPECT_EQ (positions[1], settled[1]);
+        EXPECT_EQ (positions[positions.size () - 2], settled[settled.size () - 2]);
+        EXPECT_EQ (positions[positions.size () - 1], settled[settled.size () - 1]);
+    }
+
+    TEST_F (EquilibriumSolver, SeveralAnchorsMatchesIntegration)
+    {
+        Disturb ();
+        anchors.Lock (0);
+        anchors.Lock (3);
+        anchors.Lock (14);
+
+        ExpectNearIntegration (Solve ());
+    }
+
+    TEST_F (EquilibriumSolver, FactorizationFollowsChangingAnchors)
+    {
+        Disturb ();
+        anchors.Lock (0);
+        anchors.Lock (3);
+        Solve ();
+
+        anchors.Unlock (3);
+        anchors.Lock (12);
+
+        ExpectNearIntegration (Solve ());
+    }
+
+    TEST_F (EquilibriumSolver, FreeMeshSettlesAroundCentroid)
+    {
+        Disturb ();
+
+        ExpectNearIntegration (Solve ());
+    }
+
+    TEST_F (EquilibriumSolver, FreeMeshDriftsWithMomentum)
+    {
+        for (size_t i = 0; i < wobbly::config::TotalIndices; ++i)
+        {
+            velocities[i * 2] = 5.0;
+            velocities[i * 2 + 1] = -3.0;
+        }
+
+        ExpectNearIntegration (Solve ());
+    }
+
+    /* The free mesh can be deformed along a row or a column alone,
+     * each being a path with nothing held */
+    TEST_F (EquilibriumSolver, SoftestModeOfFreeMeshIsLongestPath)
+    {
+        size_t const longest = std::max (wobbly::config::Width,
+                                         wobbly::config::Height);
+
+        EXPECT_DOUBLE_EQ (2.0 - 2.0 * std::cos (M_PI / longest),
+                          solver.SoftestMode (anchors));
+    }
+
+    /* Holding the top row leaves each column a path of Height - 1
+     * points held at one end, whose least eigenvalue is
+     * 2 - 2 cos (pi / (2 (Height - 1) + 1)) */
+    TEST_F (EquilibriumSolver, SoftestModeOfMeshHeldAlongTopRow)
+    {
+        for (size_t i = 0; i < wobbly::config::Width; ++i)
+            anchors.Lock (i);
+
+        size_t const free = wobbly::config::Height - 1;
+
+        EXPECT_NEAR (2.0 - 2.0 * std::cos (M_PI / (2 * free + 1)),
+                     solver.SoftestMode (anchors),
+                     1e-6);
+    }
+
+    TEST_F (EquilibriumSolver, SoftestModeStiffensWithMoreAnchors)
+    {
+        anchors.Lock (0);
+        double const one = solver.SoftestMode (anchors);
+
+        anchors.Lock (wobbly::config::TotalIndices - 1);
+        double const two = solver.SoftestMode (anchors);
+
+        EXPECT_LT (0.0, one);
+        EXPECT_LT (one, two);
+    }
+
+    /* Counts what goes through it to the heap */
+    class CountingAllocator :
+        public wobbly::Allocator
+    {
+        public:
+
+            void * Allocate (size_t size) override
+            {
+                ++allocations;
+                return Heap ().Allocate (size);
+            }
+
+            void Deallocate (void *block, size_t size) noexcept override
+            {
+                Heap ().Deallocate (block, size);
+            }
+
+            size_t allocations = 0;
+    };
+
+    TEST_F (EquilibriumSolver, FactorIsOnlyAllocatedOnceAnchored)
+    {
+        CountingAllocator counting;
+        wobbly::EquilibriumSolver <wobbly::config::Width,
+                                   wobbly::config::Height> lazy (counting);
+        wobbly::MeshArray settled;
+
+        auto const solve = [&]() {
+            lazy.Solve (positions,
+                        velocities,
+                        anchors,
+                        tileSize,
+                        Friction,
+                        Mass,
+                        1.0,
+                        settled);
+        };
+
+        solve ();
+        EXPECT_EQ (0, counting.allocations);
+
+        anchors.Lock (0);
+        solve ();
+        EXPECT_EQ (1, counting.allocations);
+
+        /* Changing anchors refactorizes in the same storage */
+        anchors.Lock (wobbly::config::TotalIndices - 1);
+        solve ();
+        EXPECT_EQ (1, counting.allocations);
+    }
+}
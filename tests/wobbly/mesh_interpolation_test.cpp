@@ -23,8 +23,9 @@
 #include <functional>                   // for function, __bind, __base, etc
 #include <memory>                       // for unique_ptr
 #include <sstream>                      // for basic_stringbuf<>::int_type, etc
+#include <vector>                       // for vector
 
-#include <math.h>                       // for pow, ceil
+#include <math.h>                       // for pow, ceil, sin, cos
 
 #include <stddef.h>                     // for size_t
 
@@ -301,4 +302,179 @@ namespace
     INSTANTIATE_TEST_CASE_P (UnitExtremes,
                              BezierMeshPoints,
                              ValuesIn (unitMeshExtremes));
+
+    class PiecewiseBezierMesh :
+        public Test
+    {
+        public:
+
+            static constexpr size_t Width = 8;
+            static constexpr size_t Height = 8;
+
+            PiecewiseBezierMesh ()
+            {
+                /* An irregular mesh, so that a patch which ignored some
+                 * of its points would not go unnoticed */
+                for (size_t j = 0; j < Height; ++j)
+                {
+                    for (size_t i = 0; i < Width; ++i)
+                    {
+                        auto pv (mesh.PointForIndex (i, j));
+                        agd::assign (pv,
+                                     animation::Point (i * 10.0 + std::sin (i + j) * 3,
+                                                       j * 20.0 + std::cos (i * j)));
+                    }
+                }
+            }
+
+            /* Rows are selected by the first unit co-ordinate */
+            static animation::Point UnitCoordsOf (size_t x, size_t y)
+            {
+                return animation::Point (y / (Height - 1.0),
+                                         x / (Width - 1.0));
+            }
+
+            /* Compares a grid from deformGrid against looking up each of
+             * its vertices with deformPoint */
+            template <typename DeformGrid, typename DeformPoint>
+            void ExpectGridMatchesPointwise (DeformGrid  const &deformGrid,
+                                             DeformPoint const &deformPoint)
+            {
+                size_t const uSteps = 9;
+                size_t const vSteps = 13;
+                std::vector <double> vertices (uSteps * vSteps * 2);
+
+                deformGrid (uSteps, vSteps, vertices.data ());
+
+                for (size_t v = 0; v < vSteps; ++v)
+                {
+                    for (size_t u = 0; u < uSteps; ++u)
+                    {
+                        size_t const index = (v * uSteps + u) * 2;
+                        animation::Point const unit (u / (uSteps - 1.0),
+                                                     v / (vSteps - 1.0));
+                        animation::Point const expected (deformPoint (unit));
+
+                        EXPECT_NEAR (agd::get <0> (expected), vertices[index], 10e-9);
+                        EXPECT_NEAR (agd::get <1> (expected), vertices[index + 1], 10e-9);
+                    }
+                }
+            }
+
+            wobbly::BasicBezierMesh <Width, Height> mesh;
+    };
+
+    TEST_F (PiecewiseBezierMesh, PassesThroughEveryPoint)
+    {
+        for (size_t j = 0; j < Height; ++j)
+        {
+            for (size_t i = 0; i < Width; ++i)
+            {
+                animation::Point expected;
+                agd::assign (expected, mesh.PointForIndex (i, j));
+
+                EXPECT_THAT (mesh.DeformUnitCoordsPiecewise (UnitCoordsOf (i, j)),
+                             Eq (expected));
+            }
+        }
+    }
+
+    TEST_F (PiecewiseBezierMesh, LinearDeformationForEvenlySpacedMesh)
+    {
+        for (size_t j = 0; j < Height; ++j)
+            for (size_t i = 0; i < Width; ++i)
+            {
+                auto pv (mesh.PointForIndex (i, j));
+                agd::assign (pv, animation::Point (i * 10.0, j * 20.0));
+            }
+
+        for (size_t sample = 0; sample <= 100; ++sample)
+        {
+            double const unit = sample / 100.0;
+            animation::Point const p (mesh.DeformUnitCoordsPiecewise (animation::Point (unit,
+                                                                                        unit)));
+
+            EXPECT_NEAR (unit * (Width - 1) * 10.0, agd::get <0> (p), 10e-9);
+            EXPECT_NEAR (unit * (Height - 1) * 20.0, agd::get <1> (p), 10e-9);
+        }
+    }
+
+    TEST_F (PiecewiseBezierMesh, UnaffectedByPointsOutsideNeighbourhood)
+    {
+        animation::Point const lookup (UnitCoordsOf (1, 1));
+        animation::Point const before (mesh.DeformUnitCoordsPiecewise (lookup));
+
+        auto pv (mesh.PointForIndex (Width - 1, Height - 1));
+        agd::assign (pv, animation::Point (1000.0, 1000.0));
+
+        EXPECT_THAT (mesh.DeformUnitCoordsPiecewise (lookup), Eq (before));
+    }
+
+    TEST_F (PiecewiseBezierMesh, DerivativeContinuousAcrossPatchBoundary)
+    {
+        double const boundary = 3.0 / (Height - 1);
+        double const h = 10e-7;
+
+        auto const deform = [this](double u) {
+            return mesh.DeformUnitCoordsPiecewise (animation::Point (u, 0.3));
+        };
+
+        animation::Point const below (deform (boundary - h));
+        animation::Point const at (deform (boundary));
+        animation::Point const above (deform (boundary + h));
+
+        for (size_t d = 0; d < 2; ++d)
+        {
+            double const b = d ? agd::get <1> (below) : agd::get <0> (below);
+            double const a = d ? agd::get <1> (at) : agd::get <0> (at);
+            double const c = d ? agd::get <1> (above) : agd::get <0> (above);
+
+            EXPECT_NEAR ((a - b) / h, (c - a) / h, 10e-3);
+        }
+    }
+
+    TEST_F (PiecewiseBezierMesh, SinglePatchGridMatchesEachVertex)
+    {
+        ExpectGridMatchesPointwise ([this](size_t u, size_t v, double *out) {
+                                        mesh.DeformGrid (u, v, out);
+                                    },
+                                    [this](animation::Point const &unit) {
+                                        return mesh.DeformUnitCoordsToMeshSpace (unit);
+                                    });
+    }
+
+    TEST_F (PiecewiseBezierMesh, PiecewiseGridMatchesEachVertex)
+    {
+        ExpectGridMatchesPointwise ([this](size_t u, size_t v, double *out) {
+                                        mesh.DeformGridPiecewise (u, v, out);
+                                    },
+                                    [this](animation::Point const &unit) {
+                                        return mesh.DeformUnitCoordsPiecewise (unit);
+                                    });
+    }
+
+    TEST (BezierBasisTable, SharedBetweenLookupsOfSameDensity)
+    {
+        auto const &table (wobbly::bezier::BasisTable <4>::Bernstein (17));
+
+        EXPECT_EQ (&table, &wobbly::bezier::BasisTable <4>::Bernstein (17));
+        EXPECT_NE (&table, &wobbly::bezier::BasisTable <4>::Bernstein (18));
+        EXPECT_NE (&table, &wobbly::bezier::BasisTable <4>::CatmullRom (17));
+    }
+
+    TEST (BezierBasisTable, MatchesBasisCoefficientsAtEachSample)
+    {
+        size_t const steps = 11;
+        auto const &table (wobbly::bezier::BasisTable <4>::Bernstein (steps));
+
+        for (size_t sample = 0; sample < steps; ++sample)
+        {
+            double coefficients[4];
+            wobbly::bezier::BasisCoefficients (sample / (steps - 1.0),
+                                               coefficients);
+
+            EXPECT_THAT (std::vector <double> (table[sample], table[sample] + 4),
+                         ElementsAreArray (coefficients));
+        }
+    }
 }
@@ -21,11 +21,13 @@
  */
 #include <algorithm>                    // for max
 #include <array>                        // for array, array<>::value_type
+#include <chrono>                       // for milliseconds, etc
 #include <functional>                   // for function, __bind, __base, etc
 #include <memory>                       // for unique_ptr
 #include <sstream>                      // for operator<<, ostream, etc
 #include <vector>                       // for vector
 
+#include <cmath>                        // for isfinite, fabs, sin, cos
 #include <cstddef>                      // for size_t
 #include <stdlib.h>                     // for exit
 #include <math.h>                       // for ceil
@@ -269,8 +271,9 @@ namespace
         {
         }
 
-        static void ApplyMovement (std::unique_ptr <double[]>    &ptr,
-                                   animation::Vector const       &movement)
+        template <typename Data>
+        static void ApplyMovement (Data                    &ptr,
+                                   animation::Vector const &movement)
         {
             animation::PointView <double> pv (ptr.get (), 0);
             agd::pointwise_add (pv, movement);
@@ -591,6 +594,21 @@ namespace
     /* This tests that if we pass in a different preference for a
      * desired distance for this spring, that force points in accordance
      * with that preference */
+    TEST_F (SpringMesh, NoPotentialEnergyAtDesiredLengths)
+    {
+        EXPECT_NEAR (0.0, springMesh.PotentialEnergy (SpringConstant), 1e-9);
+    }
+
+    /* The corner has two springs, each stretched by the movement */
+    TEST_F (SpringMesh, PotentialEnergyQuadraticInStretch)
+    {
+        animation::PointView <double> corner (mesh, 0);
+        agd::pointwise_add (corner, animation::Vector (4, 0));
+
+        EXPECT_DOUBLE_EQ (SpringConstant / 4 * (4 * 4 + 4 * 4),
+                          springMesh.PotentialEnergy (SpringConstant));
+    }
+
     TEST_F (SpringMesh, DesiredDistanceCanBeDifferentToSpringPositionAtGrab)
     {
         /* Insert a temporary anchor between points (1) and (2) on the grid */
@@ -971,6 +989,97 @@ namespace
         EXPECT_THAT (model.Extremes (), ElementsAreArray (scaledExtremes));
     }
 
+    /* Leaves the model wobbling freely with nothing holding it */
+    void FlingModel (wobbly::Model &model)
+    {
+        {
+            wobbly::Anchor grab (model.GrabAnchor (animation::Point (TextureWidth / 2,
+                                                                     0)));
+            grab.MoveBy (animation::Vector (100, 100));
+            model.Step (16 * 5);
+        }
+
+        model.Step (16 * 2);
+    }
+
+    /* Without anchors, settling can stop short of the exact target by
+     * about as much as the velocity clip threshold */
+    ::testing::Matcher <animation::Point const &>
+    NearlySettledAt (animation::Point const &point)
+    {
+        animation::Point lower (point);
+        animation::Point upper (point);
+        agd::pointwise_add (lower, animation::Point (-1.5, -1.5));
+        agd::pointwise_add (upper, animation::Point (1.5, 1.5));
+
+        return WithinGeometry (PointBox (lower, upper));
+    }
+
+    TEST_F (SpringBezierModel, RepeatedMoveModelToWhileWobblingSettlesAtLastTarget)
+    {
+        FlingModel (model);
+
+        for (size_t i = 1; i <= 10; ++i)
+        {
+            model.MoveModelTo (animation::Point (i * 20.0, i * 10.0));
+            model.Step (16);
+        }
+
+        while (model.Step (16));
+
+        EXPECT_THAT (model.Extremes ()[0],
+                     NearlySettledAt (animation::Point (200, 100)));
+    }
+
+    TEST_F (SpringBezierModel, MoveModelToWhileWobblingAfterResizeSettlesAtTarget)
+    {
+        FlingModel (model);
+
+        model.MoveModelTo (animation::Point (50, 50));
+        model.ResizeModel (TextureWidthAfterResize, TextureHeightAfterResize);
+        model.Step (16);
+        model.MoveModelTo (animation::Point (100, 100));
+
+        while (model.Step (16));
+
+        EXPECT_THAT (model.Extremes ()[0],
+                     NearlySettledAt (animation::Point (100, 100)));
+    }
+
+    TEST_F (SpringBezierModel, MoveModelToWhileWobblingAfterRegrabSettlesAtTarget)
+    {
+        FlingModel (model);
+        model.MoveModelTo (animation::Point (50, 50));
+
+        FlingModel (model);
+        model.MoveModelTo (animation::Point (100, 100));
+
+        while (model.Step (16));
+
+        EXPECT_THAT (model.Extremes ()[0],
+                     NearlySettledAt (animation::Point (100, 100)));
+    }
+
+    TEST_F (SpringBezierModel, MoveModelToFollowsChangesToFriction)
+    {
+        wobbly::Model::Settings settings = wobbly::Model::DefaultSettings;
+        wobbly::Model frictionModel (animation::Point (0, 0),
+                                     TextureWidth,
+                                     TextureHeight,
+                                     settings);
+
+        FlingModel (frictionModel);
+        frictionModel.MoveModelTo (animation::Point (50, 50));
+
+        settings.friction *= 2;
+        frictionModel.MoveModelTo (animation::Point (100, 100));
+
+        while (frictionModel.Step (16));
+
+        EXPECT_THAT (frictionModel.Extremes ()[0],
+                     NearlySettledAt (animation::Point (100, 100)));
+    }
+
     TEST_F (SpringBezierModel, NetForceIsZeroAfterResizingSettledModel)
     {
         model.ResizeModel (TextureWidthAfterResize,
@@ -1450,7 +1559,9 @@ namespace
             wobbly::MeshArray forces;
     };
 
-    typedef Types <wobbly::EulerIntegration> IntegrationStrategies;
+    typedef Types <wobbly::EulerIntegration,
+                   wobbly::SymplecticEulerIntegration,
+                   wobbly::VerletIntegration> IntegrationStrategies;
     TYPED_TEST_CASE (IntegrationStrategy, IntegrationStrategies);
 
     TYPED_TEST (IntegrationStrategy, NoMotionOnReset)
@@ -1536,7 +1647,7 @@ namespace
 
                 integrator.Step (0,
                                  timestep,
-                                 1.0,
+                                 0.0,
                                  1.0,
                                  TestFixture::points,
                                  TestFixture::forces);
@@ -1548,6 +1659,195 @@ namespace
                      SatisfiesModel (Parabolic <double> ()));
     }
 
+    TYPED_TEST (IntegrationStrategy, SameMotionAsEulerForShortSteps)
+    {
+        animation::PointView <double> forceView (TestFixture::forces, 0);
+        animation::PointView <double> pointView (TestFixture::points, 0);
+
+        auto const travelled = [this, &forceView, &pointView](auto &&integrator) {
+            agd::assign (pointView, animation::Point (0, 0));
+            agd::assign (forceView, animation::Vector (100.0, 50.0));
+
+            for (size_t i = 0; i < 400; ++i)
+                integrator.Step (0,
+                                 0.01,
+                                 1.0,
+                                 1.0,
+                                 TestFixture::points,
+                                 TestFixture::forces);
+
+            animation::Point result;
+            agd::assign (result, pointView);
+            return result;
+        };
+
+        animation::Point const expected (travelled (wobbly::EulerIntegration ()));
+        animation::Point const actual (travelled (TypeParam ()));
+
+        EXPECT_NEAR (agd::get <0> (expected), agd::get <0> (actual),
+                     agd::get <0> (expected) * 0.01);
+        EXPECT_NEAR (agd::get <1> (expected), agd::get <1> (actual),
+                     agd::get <1> (expected) * 0.01);
+    }
+
+    /* Integrates a disturbed mesh with its first point anchored in
+     * steps of the given length at the default spring constant and
+     * friction, returning true if it comes to rest */
+    template <typename Strategy>
+    bool SettlesDisturbedMesh (Strategy &strategy, double time)
+    {
+        typedef wobbly::ModelBase MB;
+
+        animation::Vector const tileSize (50.0, 100.0);
+        wobbly::MeshArray positions;
+
+        for (size_t i = 0; i < wobbly::config::TotalIndices; ++i)
+        {
+            animation::PointView <double> point (positions, i);
+            agd::assign (point,
+                         animation::Point ((i % wobbly::config::Width) * 50.0 +
+                                           std::sin (i * 1.7) * 20.0,
+                                           (i / wobbly::config::Width) * 100.0 +
+                                           std::cos (i * 2.3) * 20.0));
+        }
+
+        wobbly::SpringMesh mesh (positions, tileSize);
+        wobbly::AnchorArray anchors;
+        anchors.Lock (0);
+
+        for (size_t step = 0; step < 1000; ++step)
+        {
+            auto const result = mesh.CalculateForces (MB::DefaultSpringConstant);
+            bool const more = strategy.StepAll (time,
+                                                MB::Friction,
+                                                MB::Mass,
+                                                positions,
+                                                result.forces,
+                                                anchors.AnchorMask ());
+
+            for (double coordinate : positions)
+                if (!std::isfinite (coordinate) || std::fabs (coordinate) > 1e6)
+                    return false;
+
+            if (!more)
+                return true;
+        }
+
+        return false;
+    }
+
+    template <typename Strategy>
+    bool SettlesDisturbedMesh (double time)
+    {
+        Strategy strategy;
+        return SettlesDisturbedMesh (strategy, time);
+    }
+
+    TYPED_TEST (IntegrationStrategy, SettlesDisturbedMeshAtUsualStep)
+    {
+        EXPECT_TRUE (SettlesDisturbedMesh <TypeParam> (1.0));
+    }
+
+    TEST (IntegrationStability, EulerDivergesAtDoubleStep)
+    {
+        EXPECT_FALSE (SettlesDisturbedMesh <wobbly::EulerIntegration> (2.0));
+    }
+
+    TEST (IntegrationStability, SymplecticEulerSettlesAtDoubleStep)
+    {
+        EXPECT_TRUE (SettlesDisturbedMesh <wobbly::SymplecticEulerIntegration> (2.0));
+    }
+
+    TEST (IntegrationStability, VerletSettlesAtDoubleStep)
+    {
+        EXPECT_TRUE (SettlesDisturbedMesh <wobbly::VerletIntegration> (2.0));
+    }
+
+    TEST (ImplicitEulerIntegration, SettlesDisturbedMeshAtAnyStep)
+    {
+        double const springConstant = wobbly::Model::DefaultSpringConstant;
+
+        for (double time : { 1.0, 2.0, 16.0, 256.0 })
+        {
+            wobbly::ImplicitEulerIntegration integrator (springConstant);
+            EXPECT_TRUE (SettlesDisturbedMesh (integrator, time)) << time;
+        }
+    }
+
+    TEST (ImplicitEulerIntegration, SolvesForVelocityAtEndOfStep)
+    {
+        typedef wobbly::ModelBase MB;
+
+        double const springConstant = MB::DefaultSpringConstant;
+        double const time = 16.0;
+        animation::Vector const tileSize (10.0, 10.0);
+        size_t const free = wobbly::config::Width + 1;
+
+        /* One point with four neighbours which can not move, pulled
+         * away from where it would rest */
+        wobbly::MeshArray positions;
+        wobbly::mesh::CalculatePositionArray (animation::Point (0, 0),
+                                              positions,
+                                              tileSize);
+        wobbly::SpringMesh mesh (positions, tileSize);
+
+        wobbly::AnchorArray anchors;
+        for (size_t i = 0; i < wobbly::config::TotalIndices; ++i)
+            if (i != free)
+                anchors.Lock (i);
+
+        positions[free * 2] += 4.0;
+
+        auto const result = mesh.CalculateForces (springConstant);
+        double const force = result.forces[free * 2];
+
+        wobbly::ImplicitEulerIntegration integrator (springConstant);
+        integrator.StepAll (time,
+                            MB::Friction,
+                            MB::Mass,
+                            positions,
+                            result.forces,
+                            anchors.AnchorMask ());
+
+        /* The springs pull back less as the point moves back, by
+         * k / 2 per spring for each unit it moves */
+        double const expected =
+            (force * time / MB::Mass) /
+            (1.0 + MB::Friction * time / MB::Mass +
+             4 * springConstant * time * time / (4.0 * MB::Mass));
+
+        EXPECT_NEAR (expected, integrator.Velocities ()[free * 2], 1e-9);
+        EXPECT_NEAR (4.0 + expected * time / 2, positions[free * 2] - 10.0, 1e-9);
+    }
+
+    TEST (ImplicitEulerIntegration, AnchoredPointsHaveNoVelocity)
+    {
+        double const springConstant = wobbly::Model::DefaultSpringConstant;
+        animation::Vector const tileSize (10.0, 10.0);
+
+        wobbly::MeshArray positions;
+        wobbly::mesh::CalculatePositionArray (animation::Point (0, 0),
+                                              positions,
+                                              tileSize);
+        wobbly::SpringMesh mesh (positions, tileSize);
+        positions[0] -= 20.0;
+
+        wobbly::AnchorArray anchors;
+        anchors.Lock (0);
+
+        wobbly::ImplicitEulerIntegration integrator (springConstant);
+        integrator.StepAll (16.0,
+                            wobbly::Model::Friction,
+                            wobbly::Model::Mass,
+                            positions,
+                            mesh.CalculateForces (springConstant).forces,
+                            anchors.AnchorMask ());
+
+        EXPECT_EQ (-20.0, positions[0]);
+        EXPECT_EQ (0.0, integrator.Velocities ()[0]);
+        EXPECT_NE (0.0, integrator.Velocities ()[2]);
+    }
+
     TEST (SpringStep, ContinueStepWhenSpringsHaveForces)
     {
         /* All points will start at zero, so a positive spring force
@@ -1569,4 +1869,931 @@ namespace
 
         EXPECT_TRUE (stepper (positions, anchors));
     }
+
+    TEST (SpringStep, FusedSweepMatchesSeparateSteps)
+    {
+        double const springConstant = 8.0;
+        double const springFriction = 3.0;
+        double const maximumRange = 20.0;
+        animation::Vector const tileSize (10.0, 10.0);
+
+        /* Start from a distorted grid with one anchor, an inserted anchor
+         * and active constrainment, so that every part of the step is
+         * exercised */
+        wobbly::MeshArray separatePositions;
+        for (size_t i = 0; i < wobbly::config::TotalIndices; ++i)
+        {
+            animation::PointView <double> point (separatePositions, i);
+            agd::assign (point,
+                         animation::Point ((i % wobbly::config::Width) * 10.0 +
+                                           std::sin (i) * 30.0,
+                                           (i / wobbly::config::Width) * 10.0 +
+                                           std::cos (i) * 7.0));
+        }
+
+        wobbly::MeshArray fusedPositions (separatePositions);
+
+        wobbly::TargetMesh targets ([](wobbly::MeshArray &) {});
+        wobbly::mesh::CalculatePositionArray (animation::Point (0, 0),
+                                              targets.PointArray (),
+                                              tileSize);
+        auto handle (targets.Activate ());
+        wobbly::ConstrainmentStep constrainment (maximumRange, targets);
+
+        wobbly::AnchorArray anchors;
+        anchors.Lock (0);
+
+        wobbly::EulerIntegration separateIntegrator, fusedIntegrator;
+        wobbly::SpringStep <wobbly::EulerIntegration>
+            separate (separateIntegrator,
+                      separatePositions,
+                      springConstant,
+                      springFriction,
+                      tileSize);
+        wobbly::SpringStep <wobbly::EulerIntegration>
+            fused (fusedIntegrator,
+                   fusedPositions,
+                   springConstant,
+                   springFriction,
+                   tileSize);
+
+        auto const first = [](wobbly::Spring const &spring) {
+            return spring.FirstPosition ();
+        };
+        auto const second = [](wobbly::Spring const &spring) {
+            return spring.SecondPosition ();
+        };
+
+        animation::Point const install (12.0, 13.0);
+        auto separateAnchor (separate.InstallAnchorSprings (install,
+                                                            first,
+                                                            second));
+        auto fusedAnchor (fused.InstallAnchorSprings (install,
+                                                      first,
+                                                      second));
+
+        for (size_t i = 0; i < 20; ++i)
+        {
+            bool separateMore = constrainment (separatePositions, anchors);
+            separateMore |= separate (separatePositions, anchors);
+
+            bool fusedMore = fused (fusedPositions, anchors, constrainment);
+
+            ASSERT_EQ (separateMore, fusedMore);
+            ASSERT_THAT (fusedPositions, ElementsAreArray (separatePositions));
+        }
+    }
+
+    TEST (SpringStep, SleepingPointsMatchSeparateSteps)
+    {
+        double const springConstant = 8.0;
+        double const springFriction = 3.0;
+        animation::Vector const tileSize (10.0, 10.0);
+
+        /* A mesh at rest with only its far corner pulled away, so that
+         * most of it has nothing to do to begin with and all of it has
+         * nothing to do at the end */
+        wobbly::MeshArray separatePositions;
+        wobbly::mesh::CalculatePositionArray (animation::Point (0, 0),
+                                              separatePositions,
+                                              tileSize);
+
+        size_t const corner = wobbly::config::TotalIndices - 1;
+        animation::PointView <double> cornerPoint (separatePositions, corner);
+        agd::pointwise_add (cornerPoint, animation::Point (30.0, 20.0));
+
+        wobbly::MeshArray fusedPositions (separatePositions);
+
+        /* Targets which are never activated, so nothing is constrained */
+        wobbly::TargetMesh targets ([](wobbly::MeshArray &) {});
+        wobbly::ConstrainmentStep constrainment (20.0, targets);
+
+        wobbly::AnchorArray anchors;
+        anchors.Lock (0);
+
+        wobbly::EulerIntegration separateIntegrator, fusedIntegrator;
+        wobbly::SpringStep <wobbly::EulerIntegration>
+            separate (separateIntegrator,
+                      separatePositions,
+                      springConstant,
+                      springFriction,
+                      tileSize);
+        wobbly::SpringStep <wobbly::EulerIntegration>
+            fused (fusedIntegrator,
+                   fusedPositions,
+                   springConstant,
+                   springFriction,
+                   tileSize);
+
+        size_t firstSlept = 0;
+        size_t lastSlept = 0;
+        size_t sleptSprings = 0;
+
+        auto const step = [&]() {
+            bool const separateMore = separate (separatePositions, anchors);
+            bool const fusedMore = fused (fusedPositions, anchors, constrainment);
+
+            ASSERT_EQ (separateMore, fusedMore);
+            ASSERT_THAT (fusedPositions, ElementsAreArray (separatePositions));
+            ASSERT_THAT (fusedIntegrator.Velocities (),
+                         ElementsAreArray (separateIntegrator.Velocities ()));
+
+            sleptSprings += fused.SleptSprings ();
+        };
+
+        for (size_t i = 0; i < 200; ++i)
+        {
+            step ();
+
+            if (i == 1)
+                firstSlept = fused.SleptPoints ();
+        }
+
+        lastSlept = fused.SleptPoints ();
+
+        /* Moving a point from outside the step wakes it and its
+         * neighbours, which then carry on as they would have done */
+        for (wobbly::MeshArray *positions : { &separatePositions,
+                                              &fusedPositions })
+        {
+            animation::PointView <double> point (*positions, corner);
+            agd::pointwise_add (point, animation::Point (-15.0, 10.0));
+        }
+
+        for (size_t i = 0; i < 200; ++i)
+            step ();
+
+        EXPECT_GT (firstSlept, 0);
+        EXPECT_EQ (wobbly::config::TotalIndices, lastSlept);
+        EXPECT_GT (sleptSprings, 0);
+    }
+
+    /* Tests which should hold for every instantiated mesh resolution */
+    template <typename Model>
+    class BasicModelResolution :
+        public Test
+    {
+        public:
+
+            BasicModelResolution () :
+                model (animation::Point (0, 0),
+                       TextureWidth,
+                       TextureHeight)
+            {
+            }
+
+            Model model;
+    };
+
+    typedef ::testing::Types <wobbly::BasicModel <3, 3>,
+                              wobbly::BasicModel <4, 4>,
+                              wobbly::BasicModel <8, 8>> ModelResolutionTypes;
+
+    TYPED_TEST_CASE (BasicModelResolution, ModelResolutionTypes);
+
+    TYPED_TEST (BasicModelResolution, CornersDeformToModelCorners)
+    {
+        animation::Point const bottomRight (TextureWidth, TextureHeight);
+
+        EXPECT_THAT (this->model.DeformTexcoords (animation::Point (0, 0)),
+                     Eq (animation::Point (0, 0)));
+        EXPECT_THAT (this->model.DeformTexcoords (animation::Point (1, 1)),
+                     Eq (bottomRight));
+    }
+
+    TYPED_TEST (BasicModelResolution, PiecewiseSurfaceMatchesSinglePatchAtRest)
+    {
+        /* Both surfaces are exact for an undeformed mesh */
+        animation::Point const samples[] =
+        {
+            animation::Point (0.0, 0.0),
+            animation::Point (0.25, 0.75),
+            animation::Point (0.5, 0.5),
+            animation::Point (1.0, 1.0)
+        };
+
+        for (auto const &sample : samples)
+        {
+            animation::Point const single (this->model.DeformTexcoords (sample));
+
+            this->model.SetSurface (wobbly::ModelBase::Surface::PiecewiseBicubic);
+            animation::Point const piecewise (this->model.DeformTexcoords (sample));
+            this->model.SetSurface (wobbly::ModelBase::Surface::SinglePatch);
+
+            EXPECT_THAT (piecewise, Eq (single));
+        }
+    }
+
+    TYPED_TEST (BasicModelResolution, DeformGridMatchesDeformTexcoords)
+    {
+        typedef wobbly::ModelBase::Surface Surface;
+
+        {
+            wobbly::Anchor grab (this->model.GrabAnchor (animation::Point (50, 0)));
+            grab.MoveBy (animation::Vector (30, 40));
+            this->model.Step (64);
+        }
+
+        size_t const uSteps = 5;
+        size_t const vSteps = 7;
+        std::vector <double> vertices (uSteps * vSteps * 2);
+
+        for (Surface surface : { Surface::SinglePatch, Surface::PiecewiseBicubic })
+        {
+            this->model.SetSurface (surface);
+            this->model.DeformGrid (uSteps, vSteps, vertices.data ());
+
+            for (size_t v = 0; v < vSteps; ++v)
+            {
+                for (size_t u = 0; u < uSteps; ++u)
+                {
+                    size_t const index = (v * uSteps + u) * 2;
+                    animation::Point const unit (u / (uSteps - 1.0),
+                                                 v / (vSteps - 1.0));
+
+                    EXPECT_THAT (animation::Point (vertices[index],
+                                                   vertices[index + 1]),
+                                 Eq (this->model.DeformTexcoords (unit)));
+                }
+            }
+        }
+    }
+
+    TYPED_TEST (BasicModelResolution, SettlesAtGrabbedPosition)
+    {
+        wobbly::Anchor grab (this->model.GrabAnchor (animation::Point (0, 0)));
+        grab.MoveBy (animation::Vector (100, 100));
+
+        while (this->model.Step (16));
+
+        EXPECT_THAT (this->model.Extremes ()[0],
+                     Eq (animation::Point (100, 100)));
+    }
+
+    class ModelDetail :
+        public ::testing::Test
+    {
+        public:
+
+            ModelDetail () :
+                full (animation::Point (0, 0), TextureWidth, TextureHeight),
+                model (animation::Point (0, 0), TextureWidth, TextureHeight)
+            {
+            }
+
+            void Disturb ()
+            {
+                for (wobbly::Model *m : { &full, &model })
+                {
+                    wobbly::Anchor grab (m->GrabAnchor (animation::Point (0, 0)));
+                    grab.MoveBy (animation::Vector (20, 10));
+                }
+            }
+
+            void ExpectSameExtremes (double tolerance)
+            {
+                for (size_t corner = 0; corner < 4; ++corner)
+                {
+                    auto const expected (full.Extremes ()[corner]);
+                    auto const actual (model.Extremes ()[corner]);
+
+                    EXPECT_NEAR (agd::get <0> (expected), agd::get <0> (actual), tolerance);
+                    EXPECT_NEAR (agd::get <1> (expected), agd::get <1> (actual), tolerance);
+                }
+            }
+
+            wobbly::Model full;
+            wobbly::Model model;
+    };
+
+    TEST_F (ModelDetail, ReducedIntegratesOncePerRatioSteps)
+    {
+        Disturb ();
+        model.SetDetail (wobbly::Model::Detail::Reduced);
+
+        for (size_t i = 0; i < 10; ++i)
+        {
+            full.Step (16);
+
+            for (size_t j = 0; j < wobbly::Model::ReducedStepRatio; ++j)
+                model.Step (16);
+
+            ExpectSameExtremes (0.0);
+        }
+    }
+
+    TEST_F (ModelDetail, ReducedStillAnimatingBetweenIntegrations)
+    {
+        Disturb ();
+        model.SetDetail (wobbly::Model::Detail::Reduced);
+
+        EXPECT_TRUE (model.Step (16));
+    }
+
+    TEST_F (ModelDetail, ChangingBetweenFullAndReducedCarriesOn)
+    {
+        Disturb ();
+
+        full.Step (16);
+        model.Step (16);
+
+        model.SetDetail (wobbly::Model::Detail::Reduced);
+        full.Step (16);
+        model.Step (16);
+        model.Step (16);
+
+        model.SetDetail (wobbly::Model::Detail::Full);
+        full.Step (16);
+        model.Step (16);
+
+        ExpectSameExtremes (0.0);
+    }
+
+    TEST_F (ModelDetail, RigidSettlesWhereFullWould)
+    {
+        Disturb ();
+
+        while (full.Step (16));
+        model.SetDetail (wobbly::Model::Detail::Rigid);
+
+        ExpectSameExtremes (1.0);
+    }
+
+    TEST_F (ModelDetail, RigidNeverAnimates)
+    {
+        Disturb ();
+        model.SetDetail (wobbly::Model::Detail::Rigid);
+
+        EXPECT_FALSE (model.Step (16));
+    }
+
+    TEST_F (ModelDetail, RigidMovesWholeMeshWithAnchor)
+    {
+        model.SetDetail (wobbly::Model::Detail::Rigid);
+
+        wobbly::Anchor grab (model.GrabAnchor (animation::Point (0, 0)));
+        grab.MoveBy (animation::Vector (20, 10));
+        model.Step (16);
+
+        full.MoveModelBy (animation::Vector (20, 10));
+
+        ExpectSameExtremes (0.0);
+    }
+
+    TEST_F (ModelDetail, FullAfterRigidStartsAtRest)
+    {
+        model.SetDetail (wobbly::Model::Detail::Rigid);
+        model.MoveModelBy (animation::Vector (20, 10));
+        model.SetDetail (wobbly::Model::Detail::Full);
+
+        EXPECT_FALSE (model.Step (16));
+    }
+
+    TEST (ModelDetailForSize, RigidWhenNotVisible)
+    {
+        EXPECT_EQ (wobbly::Model::Detail::Rigid,
+                   wobbly::Model::DetailForSize (0, 0));
+    }
+
+    TEST (ModelDetailForSize, ReducedWhenSmall)
+    {
+        EXPECT_EQ (wobbly::Model::Detail::Reduced,
+                   wobbly::Model::DetailForSize (64, 400));
+    }
+
+    TEST (ModelDetailForSize, FullWhenLarge)
+    {
+        EXPECT_EQ (wobbly::Model::Detail::Full,
+                   wobbly::Model::DetailForSize (400, 400));
+    }
+
+    class ModelCatchUp :
+        public ::testing::Test
+    {
+        public:
+
+            ModelCatchUp () :
+                stepped (animation::Point (0, 0), TextureWidth, TextureHeight),
+                model (animation::Point (0, 0), TextureWidth, TextureHeight)
+            {
+            }
+
+            void ExpectSameExtremes (double tolerance)
+            {
+                for (size_t corner = 0; corner < 4; ++corner)
+                {
+                    auto const expected (stepped.Extremes ()[corner]);
+                    auto const actual (model.Extremes ()[corner]);
+
+                    EXPECT_NEAR (agd::get <0> (expected), agd::get <0> (actual), tolerance);
+                    EXPECT_NEAR (agd::get <1> (expected), agd::get <1> (actual), tolerance);
+                }
+            }
+
+            static constexpr unsigned int StepTime =
+                wobbly::Model::StepInterval.count ();
+
+            wobbly::Model stepped;
+            wobbly::Model model;
+    };
+
+    TEST_F (ModelCatchUp, ShortGapsSteppedOneByOne)
+    {
+        wobbly::Anchor steppedGrab (stepped.GrabAnchor (animation::Point (0, 0)));
+        wobbly::Anchor grab (model.GrabAnchor (animation::Point (0, 0)));
+        steppedGrab.MoveBy (animation::Vector (100, 50));
+        grab.MoveBy (animation::Vector (100, 50));
+
+        for (size_t i = 0; i < wobbly::Model::CatchUpSteps; ++i)
+            stepped.Step (StepTime);
+
+        model.Step (StepTime * wobbly::Model::CatchUpSteps);
+
+        ExpectSameExtremes (0.0);
+    }
+
+    TEST_F (ModelCatchUp, LongGapsNotSteppedOneByOne)
+    {
+        wobbly::Anchor steppedGrab (stepped.GrabAnchor (animation::Point (0, 0)));
+        wobbly::Anchor grab (model.GrabAnchor (animation::Point (0, 0)));
+        steppedGrab.MoveBy (animation::Vector (100, 50));
+        grab.MoveBy (animation::Vector (100, 50));
+
+        for (size_t i = 0; i <= wobbly::Model::CatchUpSteps; ++i)
+            stepped.Step (StepTime);
+
+        model.Step (StepTime * (wobbly::Model::CatchUpSteps + 1));
+
+        EXPECT_THAT (model.Extremes ()[3],
+                     Not (Eq (stepped.Extremes ()[3])));
+    }
+
+    TEST_F (ModelCatchUp, SettlesWhereShortStepsWouldWhileHeld)
+    {
+        wobbly::Anchor steppedGrab (stepped.GrabAnchor (animation::Point (0, 0)));
+        wobbly::Anchor grab (model.GrabAnchor (animation::Point (0, 0)));
+        steppedGrab.MoveBy (animation::Vector (100, 50));
+        grab.MoveBy (animation::Vector (100, 50));
+
+        while (stepped.Step (StepTime));
+
+        model.Step (500);
+        while (model.Step (StepTime));
+
+        ExpectSameExtremes (0.0);
+    }
+
+    TEST_F (ModelCatchUp, SettlesAfterVeryLongGap)
+    {
+        {
+            wobbly::Anchor grab (model.GrabAnchor (animation::Point (0, 0)));
+            grab.MoveBy (animation::Vector (100, 50));
+            model.Step (StepTime);
+        }
+
+        model.Step (60000);
+        EXPECT_FALSE (model.Step (StepTime));
+    }
+
+    TEST_F (ModelCatchUp, InsertedAnchorsSteppedOneByOne)
+    {
+        wobbly::Anchor steppedInserted (stepped.InsertAnchor (animation::Point (20, 0)));
+        wobbly::Anchor inserted (model.InsertAnchor (animation::Point (20, 0)));
+        steppedInserted.MoveBy (animation::Vector (100, 50));
+        inserted.MoveBy (animation::Vector (100, 50));
+
+        for (size_t i = 0; i < 4 * wobbly::Model::CatchUpSteps; ++i)
+            stepped.Step (StepTime);
+
+        model.Step (StepTime * 4 * wobbly::Model::CatchUpSteps);
+
+        ExpectSameExtremes (0.0);
+    }
+
+    class ModelAdaptiveStepping :
+        public ::testing::Test
+    {
+        public:
+
+            ModelAdaptiveStepping () :
+                settings (wobbly::Model::DefaultSettings),
+                stepped (animation::Point (0, 0), TextureWidth, TextureHeight, settings),
+                model (animation::Point (0, 0), TextureWidth, TextureHeight, settings)
+            {
+                model.SetAdaptiveStepping (true);
+            }
+
+            /* Moves a corner of both models by delta */
+            void Disturb (animation::Vector const &delta)
+            {
+                for (wobbly::Model *m : { &stepped, &model })
+                {
+                    wobbly::Anchor grab (m->GrabAnchor (animation::Point (0, 0)));
+                    grab.MoveBy (delta);
+                }
+            }
+
+            /* Whether the bottom right corner is within tolerance of
+             * where it started, which NaN never is */
+            static bool NearStart (wobbly::Model const &m, double tolerance)
+            {
+                auto const corner (m.Extremes ()[3]);
+
+                return std::fabs (agd::get <0> (corner) - TextureWidth) < tolerance &&
+                       std::fabs (agd::get <1> (corner) - TextureHeight) < tolerance;
+            }
+
+            static constexpr unsigned int StepTime =
+                wobbly::Model::StepInterval.count ();
+
+            wobbly::Model::Settings settings;
+            wobbly::Model           stepped;
+            wobbly::Model           model;
+    };
+
+    TEST_F (ModelAdaptiveStepping, SameAsFixedStepsForDefaultSettings)
+    {
+        Disturb (animation::Vector (20, 10));
+
+        for (size_t i = 0; i < 20; ++i)
+        {
+            stepped.Step (StepTime);
+            model.Step (StepTime);
+
+            EXPECT_EQ (1, model.SubSteps ());
+        }
+
+        for (size_t corner = 0; corner < 4; ++corner)
+        {
+            auto const expected (stepped.Extremes ()[corner]);
+            auto const actual (model.Extremes ()[corner]);
+
+            EXPECT_EQ (agd::get <0> (expected), agd::get <0> (actual));
+            EXPECT_EQ (agd::get <1> (expected), agd::get <1> (actual));
+        }
+    }
+
+    TEST_F (ModelAdaptiveStepping, StiffSpringsStayStableWhereFixedStepsDiverge)
+    {
+        settings.springConstant = 100.0;
+        Disturb (animation::Vector (20, 10));
+
+        for (size_t i = 0; i < 400; ++i)
+        {
+            stepped.Step (StepTime);
+            model.Step (StepTime);
+        }
+
+        /* Stiff springs chatter about where they would settle, since
+         * spring forces are clipped, so they need not have settled */
+        EXPECT_FALSE (NearStart (stepped, 10.0));
+        EXPECT_TRUE (NearStart (model, 10.0));
+        EXPECT_FALSE (model.Diverged ());
+    }
+
+    TEST_F (ModelAdaptiveStepping, HighFrictionSettlesWhereFixedStepsDiverge)
+    {
+        settings.friction = 30.0;
+        Disturb (animation::Vector (20, 10));
+
+        for (size_t i = 0; i < 400; ++i)
+        {
+            stepped.Step (StepTime);
+            model.Step (StepTime);
+        }
+
+        EXPECT_FALSE (NearStart (stepped, 10.0));
+        EXPECT_TRUE (NearStart (model, 10.0));
+        EXPECT_FALSE (model.Step (StepTime));
+    }
+
+    TEST_F (ModelAdaptiveStepping, SubdividesStepsForStiffSprings)
+    {
+        settings.springConstant = 100.0;
+        Disturb (animation::Vector (20, 10));
+
+        model.Step (StepTime);
+        EXPECT_LT (1, model.SubSteps ());
+    }
+
+    TEST_F (ModelAdaptiveStepping, SubdividesStepsForLargeForces)
+    {
+        Disturb (animation::Vector (500, 500));
+
+        model.Step (StepTime);
+        EXPECT_LT (1, model.SubSteps ());
+    }
+
+    TEST_F (ModelAdaptiveStepping, CombinesStepsNearRest)
+    {
+        Disturb (animation::Vector (0.2, 0.1));
+
+        model.Step (StepTime * 2);
+        EXPECT_EQ (1, model.SubSteps ());
+    }
+
+    TEST_F (ModelAdaptiveStepping, PutsMeshAtRestIfNoStepIsStable)
+    {
+        settings.springConstant = 1e6;
+        Disturb (animation::Vector (20, 10));
+
+        EXPECT_FALSE (model.Step (StepTime));
+        EXPECT_TRUE (model.Diverged ());
+        EXPECT_TRUE (NearStart (model, 10.0));
+    }
+
+    TEST (ModelSleeping, SettledMeshSleepsUntilAnchorMoves)
+    {
+        constexpr unsigned int StepTime = wobbly::Model::StepInterval.count ();
+
+        wobbly::Model model (animation::Point (0, 0),
+                             TextureWidth,
+                             TextureHeight);
+        wobbly::Anchor grab (model.GrabAnchor (animation::Point (0, 0)));
+
+        grab.MoveBy (animation::Point (20, 10));
+
+        for (size_t i = 0; i < 1000 && model.Step (StepTime); ++i);
+
+        /* Settling snaps the mesh to where the anchor holds it, which
+         * wakes everything for one more step */
+        model.Step (StepTime);
+        model.Step (StepTime);
+        size_t const settled = model.SleepingPoints ();
+        size_t const settledSprings = model.SleepingSprings ();
+
+        grab.MoveBy (animation::Point (10, 0));
+        model.Step (StepTime);
+
+        size_t const width = wobbly::config::Width;
+        size_t const height = wobbly::config::Height;
+
+        EXPECT_EQ (width * height, settled);
+        EXPECT_EQ ((width - 1) * height + width * (height - 1), settledSprings);
+        EXPECT_GT (settled, model.SleepingPoints ());
+    }
+
+    class ModelSettleTime :
+        public ::testing::Test
+    {
+        public:
+
+            ModelSettleTime () :
+                settings (wobbly::Model::DefaultSettings)
+            {
+            }
+
+            /* Drags a corner of model by delta, lets go and steps once */
+            static void Release (wobbly::Model           &model,
+                                 animation::Vector const &delta)
+            {
+                {
+                    wobbly::Anchor grab (model.GrabAnchor (animation::Point (0, 0)));
+                    grab.MoveBy (delta);
+                    model.Step (StepTime);
+                }
+
+                model.Step (StepTime);
+            }
+
+            /* Steps model until it settles, returning how long it was
+             * until no corner moved further than threshold from where
+             * the model settled */
+            static std::chrono::milliseconds
+            TimeUntilWithin (wobbly::Model &model, double threshold)
+            {
+                std::vector <std::array <animation::Point, 4>> extremes;
+
+                while (model.Step (StepTime))
+                    extremes.push_back (model.Extremes ());
+
+                auto const settled (model.Extremes ());
+                size_t within = 0;
+
+                for (size_t step = 0; step < extremes.size (); ++step)
+                    for (size_t corner = 0; corner < 4; ++corner)
+                    {
+                        auto const &now (extremes[step][corner]);
+                        auto const &then (settled[corner]);
+
+                        if (std::fabs (agd::get <0> (now) - agd::get <0> (then)) > threshold ||
+                            std::fabs (agd::get <1> (now) - agd::get <1> (then)) > threshold)
+                            within = step + 1;
+                    }
+
+                return wobbly::Model::StepInterval * within;
+            }
+
+            static constexpr unsigned int StepTime =
+                wobbly::Model::StepInterval.count ();
+
+            wobbly::Model::Settings settings;
+    };
+
+    TEST_F (ModelSettleTime, ZeroAtRest)
+    {
+        wobbly::Model model (animation::Point (0, 0), TextureWidth, TextureHeight);
+
+        EXPECT_EQ (0, model.SettleTime ().count ());
+    }
+
+    TEST_F (ModelSettleTime, NoSoonerThanMeshComesWithinThreshold)
+    {
+        wobbly::Model model (animation::Point (0, 0), TextureWidth, TextureHeight);
+        Release (model, animation::Vector (100, 50));
+
+        auto const predicted (model.SettleTime (0.5));
+        auto const actual (TimeUntilWithin (model, 0.5));
+
+        EXPECT_LE (actual.count (), predicted.count ());
+        EXPECT_LE (predicted.count (), 3 * actual.count ());
+    }
+
+    TEST_F (ModelSettleTime, LongerForLargerDisturbances)
+    {
+        wobbly::Model small (animation::Point (0, 0), TextureWidth, TextureHeight);
+        wobbly::Model large (animation::Point (0, 0), TextureWidth, TextureHeight);
+        Release (small, animation::Vector (10, 5));
+        Release (large, animation::Vector (100, 50));
+
+        EXPECT_LT (small.SettleTime ().count (), large.SettleTime ().count ());
+    }
+
+    TEST_F (ModelSettleTime, ShorterWithMoreFriction)
+    {
+        wobbly::Model::Settings higherF (settings);
+        higherF.friction *= 2;
+
+        wobbly::Model lower (animation::Point (0, 0), TextureWidth, TextureHeight, settings);
+        wobbly::Model higher (animation::Point (0, 0), TextureWidth, TextureHeight, higherF);
+        Release (lower, animation::Vector (100, 50));
+        Release (higher, animation::Vector (100, 50));
+
+        EXPECT_GT (lower.SettleTime ().count (), higher.SettleTime ().count ());
+    }
+
+    TEST_F (ModelSettleTime, ShortensAsMeshSettles)
+    {
+        wobbly::Model model (animation::Point (0, 0), TextureWidth, TextureHeight);
+        Release (model, animation::Vector (100, 50));
+
+        auto const before (model.SettleTime ());
+
+        for (size_t i = 0; i < 10; ++i)
+            model.Step (StepTime);
+
+        EXPECT_LT (model.SettleTime ().count (), before.count ());
+    }
+
+    TEST_F (ModelSettleTime, LongerAtReducedDetail)
+    {
+        wobbly::Model model (animation::Point (0, 0), TextureWidth, TextureHeight);
+        Release (model, animation::Vector (100, 50));
+
+        auto const full (model.SettleTime ());
+        model.SetDetail (wobbly::Model::Detail::Reduced);
+
+        EXPECT_NEAR (full.count () * wobbly::Model::ReducedStepRatio,
+                     model.SettleTime ().count (),
+                     StepTime * wobbly::Model::ReducedStepRatio);
+    }
+
+    class ModelAdvance :
+        public ::testing::Test
+    {
+        public:
+
+            ModelAdvance () :
+                stepped (animation::Point (0, 0), TextureWidth, TextureHeight),
+                model (animation::Point (0, 0), TextureWidth, TextureHeight)
+            {
+                for (wobbly::Model *m : { &stepped, &model })
+                    Disturb (*m);
+            }
+
+            static void Disturb (wobbly::Model &m)
+            {
+                wobbly::Anchor grab (m.GrabAnchor (animation::Point (0, 0)));
+                grab.MoveBy (animation::Vector (20, 10));
+            }
+
+            void ExpectSameExtremes ()
+            {
+                for (size_t corner = 0; corner < 4; ++corner)
+                {
+                    auto const expected (stepped.Extremes ()[corner]);
+                    auto const actual (model.Extremes ()[corner]);
+
+                    EXPECT_EQ (agd::get <0> (expected), agd::get <0> (actual));
+                    EXPECT_EQ (agd::get <1> (expected), agd::get <1> (actual));
+                }
+            }
+
+            wobbly::Model stepped;
+            wobbly::Model model;
+    };
+
+    TEST_F (ModelAdvance, CarriesRemainderToNextCall)
+    {
+        model.Advance (std::chrono::milliseconds (7));
+        model.Advance (std::chrono::milliseconds (7));
+        ExpectSameExtremes ();
+
+        model.Advance (std::chrono::milliseconds (7));
+        stepped.Step (16);
+        ExpectSameExtremes ();
+    }
+
+    TEST_F (ModelAdvance, SameStepsWhateverTheFrameRate)
+    {
+        /* A second at 144 Hz covers 62 whole steps, where Step would
+         * have rounded each frame up to a step of its own */
+        for (size_t frame = 0; frame < 144; ++frame)
+            model.Advance (std::chrono::nanoseconds (1000000000 / 144));
+
+        for (size_t step = 0; step < 62; ++step)
+            stepped.Step (16);
+
+        ExpectSameExtremes ();
+    }
+
+    TEST_F (ModelAdvance, NegativeDeltaTakesNoTime)
+    {
+        model.Advance (std::chrono::milliseconds (-40));
+        ExpectSameExtremes ();
+        EXPECT_DOUBLE_EQ (0.0, model.InterpolationFactor ());
+
+        model.Advance (std::chrono::milliseconds (16));
+        stepped.Step (16);
+        ExpectSameExtremes ();
+    }
+
+    TEST_F (ModelAdvance, AdvanceToTakesTimeSinceLastTimestamp)
+    {
+        model.AdvanceTo (std::chrono::microseconds (5000));
+        ExpectSameExtremes ();
+
+        model.AdvanceTo (std::chrono::microseconds (5000 + 32000));
+        stepped.Step (32);
+        ExpectSameExtremes ();
+    }
+
+    TEST_F (ModelAdvance, InterpolationFactorIsTimeTowardsNextStep)
+    {
+        model.Advance (std::chrono::milliseconds (20));
+
+        EXPECT_DOUBLE_EQ (0.25, model.InterpolationFactor ());
+    }
+
+    TEST_F (ModelAdvance, InterpolatedMeshBlendsLastTwoSteps)
+    {
+        wobbly::Model twice (animation::Point (0, 0), TextureWidth, TextureHeight);
+        Disturb (twice);
+
+        stepped.Step (16);
+        twice.Step (32);
+
+        /* Two steps and half way towards the next */
+        model.SetInterpolation (true);
+        model.Advance (std::chrono::milliseconds (40));
+
+        for (auto const &texcoords : { animation::Point (0, 0),
+                                       animation::Point (0.5, 0.25),
+                                       animation::Point (1, 1) })
+        {
+            auto const before (stepped.DeformTexcoords (texcoords));
+            auto const after (twice.DeformTexcoords (texcoords));
+            auto const blended (model.DeformTexcoords (texcoords));
+
+            EXPECT_NEAR ((agd::get <0> (before) + agd::get <0> (after)) / 2,
+                         agd::get <0> (blended),
+                         1e-9);
+            EXPECT_NEAR ((agd::get <1> (before) + agd::get <1> (after)) / 2,
+                         agd::get <1> (blended),
+                         1e-9);
+        }
+    }
+
+    TEST_F (ModelAdvance, InterpolatedMeshCatchesUpOnceSettled)
+    {
+        /* Held anchors snap the mesh to where it settles once it
+         * stops moving, which the blend must not lag behind */
+        wobbly::Anchor steppedGrab (stepped.GrabAnchor (animation::Point (0, 0)));
+        wobbly::Anchor grab (model.GrabAnchor (animation::Point (0, 0)));
+
+        /* Leaves the blend half way between steps from here on */
+        model.SetInterpolation (true);
+        model.Advance (std::chrono::milliseconds (8));
+
+        for (size_t step = 0; step < 1000; ++step)
+        {
+            bool const more = stepped.Step (16);
+            model.Advance (std::chrono::milliseconds (16));
+
+            if (!more)
+                break;
+        }
+
+        ExpectSameExtremes ();
+    }
 }
@@ -0,0 +1,674 @@
+/*
+ * tests/wobbly/pool_test.cpp
+ *
+ * Copyright 2018 Endless Mobile, Inc.
+ *
+ * libanimation is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 2.1 of the
+ * License, or (at your option) any later version.
+ *
+ * libanimation is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with eos-companion-app-service.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Tests for stepping many models at once through a ModelPool.
+ */
+#include <array>                        // for array, operator==
+#include <atomic>                       // for atomic
+#include <chrono>                       // for nanoseconds, hours
+#include <cstddef>                      // for size_t
+#include <memory>                       // for unique_ptr
+#include <stdexcept>                    // for logic_error
+#include <vector>                       // for vector
+
+#include <gmock/gmock-matchers.h>       // for EXPECT_THAT, etc
+#include <gmock/gmock.h>                // IWYU pragma: keep
+#include <gtest/gtest.h>                // for AssertHelper, TEST_F, etc
+
+#include <animation/wobbly/wobbly.h>    // for ModelPool, ThreadPool, etc
+
+#include <mathematical_model_matcher.h>  // for Eq, EqDispatchHelper, etc
+#include <ostream_point_operator.h>     // for operator<<
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::Test;
+using ::testing::Values;
+using ::testing::WithParamInterface;
+
+using ::animation::matchers::Eq;
+
+namespace
+{
+    constexpr double TextureWidth = 50.0;
+    constexpr double TextureHeight = 100.0;
+
+    class ModelPool :
+        public Test
+    {
+        public:
+
+            wobbly::Model & Create (animation::Point const &position)
+            {
+                return pool.Create (position, TextureWidth, TextureHeight);
+            }
+
+            wobbly::ModelPool pool;
+    };
+
+    TEST_F (ModelPool, PooledModelStepsLikeStandaloneModel)
+    {
+        wobbly::Model standalone (animation::Point (0, 0),
+                                  TextureWidth,
+                                  TextureHeight);
+        wobbly::Model &pooled (Create (animation::Point (0, 0)));
+
+        for (wobbly::Model *model : { &standalone, &pooled })
+        {
+            wobbly::Anchor grab (model->GrabAnchor (animation::Point (10, 10)));
+            grab.MoveBy (animation::Point (30, 20));
+        }
+
+        standalone.Step (48);
+        pool.StepAll (48);
+
+        for (size_t i = 0; i < 4; ++i)
+            EXPECT_THAT (pooled.Extremes ()[i],
+                         Eq (standalone.Extremes ()[i]));
+    }
+
+    TEST_F (ModelPool, StepAllReturnsOnlyAnimatingModels)
+    {
+        Create (animation::Point (0, 0));
+        wobbly::Model &moving (Create (animation::Point (100, 0)));
+        Create (animation::Point (200, 0));
+
+        {
+            wobbly::Anchor grab (moving.GrabAnchor (animation::Point (100, 0)));
+            grab.MoveBy (animation::Point (20, 20));
+        }
+
+        EXPECT_THAT (pool.StepAll (16), ElementsAre (&moving));
+    }
+
+    TEST_F (ModelPool, NothingAnimatingOnceSettled)
+    {
+        wobbly::Model &model (Create (animation::Point (0, 0)));
+
+        {
+            wobbly::Anchor grab (model.GrabAnchor (animation::Point (0, 0)));
+            grab.MoveBy (animation::Point (20, 20));
+        }
+
+        while (!pool.StepAll (16).empty ());
+
+        EXPECT_THAT (pool.StepAll (16), IsEmpty ());
+    }
+
+    TEST_F (ModelPool, DestroyedModelsLeavePool)
+    {
+        wobbly::Model &first (Create (animation::Point (0, 0)));
+        Create (animation::Point (100, 0));
+
+        pool.Destroy (first);
+
+        EXPECT_EQ (1, pool.Size ());
+    }
+
+    TEST_F (ModelPool, DestroyedModelNotReturnedAsAnimating)
+    {
+        wobbly::Model &model (Create (animation::Point (0, 0)));
+
+        {
+            wobbly::Anchor grab (model.GrabAnchor (animation::Point (0, 0)));
+            grab.MoveBy (animation::Point (20, 20));
+        }
+
+        auto const &animating (pool.StepAll (16));
+        pool.Destroy (model);
+
+        EXPECT_THAT (animating, IsEmpty ());
+    }
+
+    TEST_F (ModelPool, StorageOfDestroyedModelIsReused)
+    {
+        wobbly::Model &first (Create (animation::Point (0, 0)));
+        wobbly::Model *address = &first;
+
+        pool.Destroy (first);
+
+        EXPECT_EQ (address, &Create (animation::Point (50, 50)));
+    }
+
+    TEST_F (ModelPool, ModelsStayPutAsPoolGrows)
+    {
+        std::vector <wobbly::Model *> models;
+
+        for (size_t i = 0; i < 100; ++i)
+            models.push_back (&Create (animation::Point (i, 0)));
+
+        for (size_t i = 0; i < models.size (); ++i)
+            EXPECT_THAT (models[i]->Extremes ()[0],
+                         Eq (animation::Point (i, 0)));
+    }
+
+    TEST_F (ModelPool, ReleasedModelsStepExactlyLikeStandaloneModels)
+    {
+        /* More than a batch of lanes, some with an anchor still inserted
+         * and so stepped on their own */
+        constexpr size_t Models = 7;
+
+        std::vector <std::unique_ptr <wobbly::Model>> standalone;
+        std::vector <wobbly::Model *> pooled;
+        std::vector <wobbly::Anchor> inserted;
+
+        for (size_t i = 0; i < Models; ++i)
+        {
+            animation::Point const position (i * 100.0, 0);
+
+            standalone.emplace_back (new wobbly::Model (position,
+                                                        TextureWidth + i,
+                                                        TextureHeight));
+            pooled.push_back (&pool.Create (position,
+                                            TextureWidth + i,
+                                            TextureHeight));
+        }
+
+        for (size_t i = 0; i < Models; ++i)
+        {
+            for (wobbly::Model *model : { standalone[i].get (), pooled[i] })
+            {
+                animation::Point const grabPoint (i * 100.0 + 10, 10);
+
+                if (i % 3 == 2)
+                {
+                    inserted.push_back (model->InsertAnchor (grabPoint));
+                    inserted.back ().MoveBy (animation::Point (15, 5));
+                    continue;
+                }
+
+                wobbly::Anchor grab (model->GrabAnchor (grabPoint));
+                grab.MoveBy (animation::Point (i * 5.0, 20));
+            }
+        }
+
+        for (size_t frame = 0; frame < 40; ++frame)
+        {
+            std::vector <wobbly::Model *> expected;
+
+            for (size_t i = 0; i < Models; ++i)
+                if (standalone[i]->Step (16))
+                    expected.push_back (pooled[i]);
+
+            EXPECT_EQ (expected, pool.StepAll (16));
+
+            for (size_t i = 0; i < Models; ++i)
+            {
+                for (size_t corner = 0; corner < 4; ++corner)
+                {
+                    auto const a (standalone[i]->Extremes ()[corner]);
+                    auto const b (pooled[i]->Extremes ()[corner]);
+
+                    EXPECT_EQ (animation::geometry::dimension::get <0> (a),
+                               animation::geometry::dimension::get <0> (b));
+                    EXPECT_EQ (animation::geometry::dimension::get <1> (a),
+                               animation::geometry::dimension::get <1> (b));
+                }
+            }
+        }
+    }
+
+    TEST_F (ModelPool, ReducedDetailModelStepsLikeStandalone)
+    {
+        wobbly::Model standalone (animation::Point (0, 0),
+                                  TextureWidth,
+                                  TextureHeight);
+        wobbly::Model &pooled (Create (animation::Point (0, 0)));
+
+        for (wobbly::Model *model : { &standalone, &pooled })
+        {
+            model->SetDetail (wobbly::Model::Detail::Reduced);
+
+            wobbly::Anchor grab (model->GrabAnchor (animation::Point (10, 10)));
+            grab.MoveBy (animation::Point (30, 20));
+        }
+
+        for (size_t frame = 0; frame < 5; ++frame)
+        {
+            standalone.Step (16);
+            pool.StepAll (16);
+
+            for (size_t i = 0; i < 4; ++i)
+                EXPECT_THAT (pooled.Extremes ()[i],
+                             Eq (standalone.Extremes ()[i]));
+        }
+    }
+
+    TEST_F (ModelPool, NewModelsAreNotActive)
+    {
+        Create (animation::Point (0, 0));
+        Create (animation::Point (100, 0));
+
+        EXPECT_EQ (0, pool.ActiveSize ());
+    }
+
+    TEST_F (ModelPool, GrabbingModelMakesItActive)
+    {
+        wobbly::Model &model (Create (animation::Point (0, 0)));
+        wobbly::Anchor grab (model.GrabAnchor (animation::Point (0, 0)));
+
+        EXPECT_EQ (1, pool.ActiveSize ());
+    }
+
+    TEST_F (ModelPool, InsertingAnchorMakesModelActive)
+    {
+        wobbly::Model &model (Create (animation::Point (0, 0)));
+        wobbly::Anchor insert (model.InsertAnchor (animation::Point (10, 10)));
+
+        EXPECT_EQ (1, pool.ActiveSize ());
+    }
+
+    TEST_F (ModelPool, MovingModelMakesItActive)
+    {
+        Create (animation::Point (0, 0)).MoveModelTo (animation::Point (10, 10));
+        Create (animation::Point (100, 0)).MoveModelBy (animation::Point (10, 10));
+
+        EXPECT_EQ (2, pool.ActiveSize ());
+    }
+
+    TEST_F (ModelPool, ResizingModelMakesItActive)
+    {
+        Create (animation::Point (0, 0)).ResizeModel (TextureWidth * 2,
+                                                      TextureHeight);
+
+        EXPECT_EQ (1, pool.ActiveSize ());
+    }
+
+    TEST_F (ModelPool, ActivateMakesModelActive)
+    {
+        pool.Activate (Create (animation::Point (0, 0)));
+
+        EXPECT_EQ (1, pool.ActiveSize ());
+    }
+
+    TEST_F (ModelPool, SettledModelsLeaveActiveSet)
+    {
+        wobbly::Model &model (Create (animation::Point (0, 0)));
+
+        {
+            wobbly::Anchor grab (model.GrabAnchor (animation::Point (0, 0)));
+            grab.MoveBy (animation::Point (20, 20));
+        }
+
+        while (!pool.StepAll (16).empty ());
+
+        EXPECT_EQ (0, pool.ActiveSize ());
+    }
+
+    TEST_F (ModelPool, HeldModelsStayActiveOnceSettled)
+    {
+        wobbly::Model &model (Create (animation::Point (0, 0)));
+        wobbly::Anchor grab (model.GrabAnchor (animation::Point (0, 0)));
+
+        grab.MoveBy (animation::Point (20, 20));
+        while (!pool.StepAll (16).empty ());
+
+        EXPECT_EQ (1, pool.ActiveSize ());
+    }
+
+    TEST_F (ModelPool, AnchorMovedAfterSettlingIsFollowed)
+    {
+        wobbly::Model &model (Create (animation::Point (0, 0)));
+        wobbly::Anchor grab (model.GrabAnchor (animation::Point (0, 0)));
+
+        while (!pool.StepAll (16).empty ());
+
+        grab.MoveBy (animation::Point (20, 20));
+
+        EXPECT_THAT (pool.StepAll (16), ElementsAre (&model));
+    }
+
+    TEST_F (ModelPool, ForEachActiveVisitsOnlyActiveModels)
+    {
+        Create (animation::Point (0, 0));
+        wobbly::Model &moved (Create (animation::Point (100, 0)));
+        Create (animation::Point (200, 0));
+
+        moved.MoveModelBy (animation::Point (10, 10));
+
+        std::vector <wobbly::Model *> visited;
+        pool.ForEachActive ([&visited](wobbly::Model &model) {
+            visited.push_back (&model);
+        });
+
+        EXPECT_THAT (visited, ElementsAre (&moved));
+    }
+
+    TEST_F (ModelPool, DestroyedModelsLeaveActiveSet)
+    {
+        wobbly::Model &model (Create (animation::Point (0, 0)));
+
+        model.MoveModelBy (animation::Point (10, 10));
+        pool.Destroy (model);
+
+        EXPECT_EQ (0, pool.ActiveSize ());
+    }
+
+    class ModelPoolBudget :
+        public ModelPool
+    {
+        public:
+
+            /* More models than are stepped at once, all moving */
+            static constexpr size_t Models = 20;
+
+            ModelPoolBudget ()
+            {
+                for (size_t i = 0; i < Models; ++i)
+                {
+                    models.push_back (&Create (animation::Point (i * 100.0, 0)));
+
+                    wobbly::Anchor grab (models.back ()->GrabAnchor (animation::Point (i * 100.0, 0)));
+                    grab.MoveBy (animation::Point (20, 20));
+                }
+            }
+
+            /* Positions of a few points across the surface of a model,
+             * which change whenever any point on the mesh moves */
+            typedef std::array <double, 3 * 3 * 2> Samples;
+
+            static Samples Sample (wobbly::Model const &model)
+            {
+                Samples samples;
+                model.DeformGrid (3, 3, samples.data ());
+                return samples;
+            }
+
+            std::vector <Samples> SampleAll () const
+            {
+                std::vector <Samples> samples;
+
+                for (wobbly::Model *model : models)
+                    samples.push_back (Sample (*model));
+
+                return samples;
+            }
+
+            static constexpr std::chrono::nanoseconds NoBudget {0};
+            static constexpr std::chrono::nanoseconds UnlimitedBudget {
+                std::chrono::hours (1)
+            };
+
+            std::vector <wobbly::Model *> models;
+    };
+
+    TEST_F (ModelPoolBudget, UnlimitedBudgetStepsLikeStepAll)
+    {
+        wobbly::ModelPool other;
+
+        for (size_t i = 0; i < Models; ++i)
+        {
+            wobbly::Model &model (other.Create (animation::Point (i * 100.0, 0),
+                                                TextureWidth,
+                                                TextureHeight));
+            wobbly::Anchor grab (model.GrabAnchor (animation::Point (i * 100.0, 0)));
+            grab.MoveBy (animation::Point (20, 20));
+        }
+
+        for (size_t frame = 0; frame < 10; ++frame)
+        {
+            auto const &expected (other.StepAll (16));
+            auto const &animating (pool.StepAllWithin (16, UnlimitedBudget));
+
+            ASSERT_EQ (expected.size (), animating.size ());
+
+            for (size_t i = 0; i < expected.size (); ++i)
+                for (size_t corner = 0; corner < 4; ++corner)
+                    EXPECT_THAT (animating[i]->Extremes ()[corner],
+                                 Eq (expected[i]->Extremes ()[corner]));
+        }
+
+        EXPECT_EQ (0, pool.LastBudgetUsage ().deferred);
+    }
+
+    TEST_F (ModelPoolBudget, ModelsOverBudgetAreNotStepped)
+    {
+        auto const before (SampleAll ());
+
+        pool.StepAllWithin (16, NoBudget);
+
+        auto const after (SampleAll ());
+        size_t unchanged = 0;
+
+        for (size_t i = 0; i < Models; ++i)
+            if (before[i] == after[i])
+                ++unchanged;
+
+        EXPECT_EQ (pool.LastBudgetUsage ().deferred, unchanged);
+        EXPECT_LT (0, pool.LastBudgetUsage ().deferred);
+        EXPECT_EQ (Models,
+                   pool.LastBudgetUsage ().stepped +
+                   pool.LastBudgetUsage ().deferred);
+    }
+
+    TEST_F (ModelPoolBudget, ModelsOverBudgetStillAnimating)
+    {
+        EXPECT_EQ (Models, pool.StepAllWithin (16, NoBudget).size ());
+    }
+
+    TEST_F (ModelPoolBudget, FocusedModelsAlwaysStepped)
+    {
+        wobbly::Model &focused (*models.back ());
+        auto const before (Sample (focused));
+
+        pool.SetPriority (focused, { true, 0.0 });
+        pool.StepAllWithin (16, NoBudget);
+
+        EXPECT_NE (before, Sample (focused));
+    }
+
+    TEST_F (ModelPoolBudget, GrabbedModelsAlwaysStepped)
+    {
+        wobbly::Model &grabbed (*models.back ());
+        wobbly::Anchor grab (grabbed.GrabAnchor (animation::Point (0, 0)));
+        auto const before (Sample (grabbed));
+
+        pool.StepAllWithin (16, NoBudget);
+
+        EXPECT_NE (before, Sample (grabbed));
+    }
+
+    TEST_F (ModelPoolBudget, LargerModelsSteppedFirst)
+    {
+        wobbly::Model &large (*models.back ());
+        auto const before (Sample (large));
+
+        pool.SetPriority (large, { false, 1000.0 * 1000.0 });
+        pool.StepAllWithin (16, NoBudget);
+
+        EXPECT_NE (before, Sample (large));
+    }
+
+    TEST_F (ModelPoolBudget, EveryModelSteppedEventually)
+    {
+        auto const before (SampleAll ());
+
+        for (size_t frame = 0; frame < Models; ++frame)
+            pool.StepAllWithin (16, NoBudget);
+
+        auto const after (SampleAll ());
+
+        for (size_t i = 0; i < Models; ++i)
+            EXPECT_NE (before[i], after[i]) << i;
+    }
+
+    TEST (ModelPoolOwnership, DestroyingModelFromAnotherPoolThrows)
+    {
+        wobbly::ModelPool pool;
+        wobbly::ModelPool other;
+        wobbly::Model &model (other.Create (animation::Point (0, 0),
+                                            TextureWidth,
+                                            TextureHeight));
+
+        EXPECT_THROW (pool.Destroy (model), std::logic_error);
+    }
+
+    TEST (ThreadPool, RunsEveryChunkExactlyOnce)
+    {
+        wobbly::ThreadPool threads (4);
+        std::vector <std::atomic <int>> runs (1000);
+
+        for (auto &count : runs)
+            count = 0;
+
+        threads.Run (runs.size (), [&runs](size_t chunk) {
+            ++runs[chunk];
+        });
+
+        for (size_t i = 0; i < runs.size (); ++i)
+            EXPECT_EQ (1, runs[i]) << i;
+    }
+
+    TEST (ThreadPool, RunsWithNoChunks)
+    {
+        wobbly::ThreadPool threads (4);
+        bool ran = false;
+
+        threads.Run (0, [&ran](size_t) { ran = true; });
+
+        EXPECT_FALSE (ran);
+    }
+
+    TEST (ThreadPool, ReusableAcrossRuns)
+    {
+        wobbly::ThreadPool threads (3);
+        std::atomic <size_t> total (0);
+
+        for (size_t run = 0; run < 100; ++run)
+            threads.Run (run, [&total](size_t) { ++total; });
+
+        EXPECT_EQ (99 * 100 / 2, total);
+    }
+
+    /* Steps the same set of models across a varying number of threads */
+    class ModelPoolThreads :
+        public Test,
+        public WithParamInterface <size_t>
+    {
+        public:
+
+            /* Starts every model wobbling in a slightly different way,
+             * with some left still */
+            static void Populate (wobbly::ModelPool &pool)
+            {
+                for (size_t i = 0; i < 70; ++i)
+                {
+                    wobbly::Model &model (pool.Create (animation::Point (i * 10.0, 0),
+                                                       TextureWidth,
+                                                       TextureHeight));
+
+                    if (i % 3 == 0)
+                        continue;
+
+                    wobbly::Anchor grab (model.GrabAnchor (animation::Point (i * 10.0, 0)));
+                    grab.MoveBy (animation::Point (i % 7 * 5.0, i % 5 * 8.0));
+                }
+            }
+    };
+
+    TEST_P (ModelPoolThreads, SameResultAsSingleThread)
+    {
+        wobbly::ModelPool serial;
+        wobbly::ModelPool parallel;
+        wobbly::ThreadPool threads (GetParam ());
+
+        Populate (serial);
+        Populate (parallel);
+
+        /* The first frame is long enough for the models to catch up,
+         * which is where stepping allocates */
+        unsigned int const catchUp = (wobbly::ModelBase::CatchUpSteps + 1) *
+                                     wobbly::ModelBase::StepInterval.count ();
+
+        for (size_t frame = 0; frame < 20; ++frame)
+        {
+            unsigned int const delta = frame == 0 ? catchUp : 16;
+            auto const &expected (serial.StepAll (delta));
+            auto const &animating (parallel.StepAll (delta, threads));
+
+            ASSERT_EQ (expected.size (), animating.size ());
+
+            for (size_t i = 0; i < expected.size (); ++i)
+            {
+                for (size_t corner = 0; corner < 4; ++corner)
+                {
+                    auto const a (expected[i]->Extremes ()[corner]);
+                    auto const b (animating[i]->Extremes ()[corner]);
+
+                    EXPECT_EQ (animation::geometry::dimension::get <0> (a),
+                               animation::geometry::dimension::get <0> (b));
+                    EXPECT_EQ (animation::geometry::dimension::get <1> (a),
+                               animation::geometry::dimension::get <1> (b));
+                }
+            }
+        }
+    }
+
+    /* Counts whatever goes through it, from any thread */
+    class CountingAllocator :
+        public wobbly::Allocator
+    {
+        public:
+
+            void * Allocate (size_t size) override
+            {
+                ++allocations;
+                return Heap ().Allocate (size);
+            }
+
+            void Deallocate (void *block, size_t size) noexcept override
+            {
+                Heap ().Deallocate (block, size);
+            }
+
+            std::atomic <size_t> allocations { 0 };
+    };
+
+    /* Catching up allocates the factors of the catch-up integrator and
+     * the solver, which must not come from the pool's allocator while
+     * StepAll steps models on several threads */
+    TEST_P (ModelPoolThreads, CatchingUpLeavesPoolAllocatorAlone)
+    {
+        CountingAllocator counting;
+        wobbly::ModelPool pool (counting);
+        wobbly::ThreadPool threads (GetParam ());
+        std::vector <wobbly::Anchor> grabs;
+
+        for (size_t i = 0; i < 70; ++i)
+        {
+            wobbly::Model &model (pool.Create (animation::Point (i * 10.0, 0),
+                                               TextureWidth,
+                                               TextureHeight));
+
+            grabs.push_back (model.GrabAnchor (animation::Point (i * 10.0, 0)));
+            grabs.back ().MoveBy (animation::Point (i % 7 * 5.0, i % 5 * 8.0));
+        }
+
+        size_t const created = counting.allocations;
+        unsigned int const delta = (wobbly::ModelBase::CatchUpSteps + 1) *
+                                   wobbly::ModelBase::StepInterval.count ();
+
+        pool.StepAll (delta, threads);
+        EXPECT_EQ (created, counting.allocations);
+    }
+
+    INSTANTIATE_TEST_CASE_P (ThreadCounts,
+                             ModelPoolThreads,
+                             Values (1, 2, 3, 8));
+}
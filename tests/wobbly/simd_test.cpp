@@ -0,0 +1,565 @@
+/*
+ * tests/wobbly/simd_test.cpp
+ *
+ * Copyright 2018 Endless Mobile, Inc.
+ *
+ * libanimation is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 2.1 of the
+ * License, or (at your option) any later version.
+ *
+ * libanimation is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with eos-companion-app-service.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Tests for the vectorized wobbly kernels, checking that each variant
+ * agrees exactly with the generic implementation.
+ */
+#include <algorithm>                    // for fill
+#include <memory>                       // for unique_ptr
+#include <random>                       // for mt19937, etc
+#include <vector>                       // for vector
+
+#include <math.h>                       // for sin
+
+#include <stddef.h>                     // for size_t
+#include <stdint.h>                     // for uint64_t
+
+#include <gmock/gmock-matchers.h>       // for ElementsAreArray, etc
+#include <gmock/gmock.h>                // IWYU pragma: keep
+#include <gtest/gtest-param-test.h>     // for Values, etc
+#include <gtest/gtest.h>                // for AssertHelper, TEST_P, etc
+
+#include <animation/wobbly/wobbly.h>    // for PointView, Vector
+#include <animation/wobbly/wobbly_internal.h>  // for EulerIntegrate, etc
+#include <animation/wobbly/wobbly_simd.h>  // for SpringForceKernelFor, etc
+
+using ::testing::ElementsAreArray;
+using ::testing::Values;
+using ::testing::WithParamInterface;
+
+namespace
+{
+    namespace agd = animation::geometry::dimension;
+    namespace ws = wobbly::simd;
+
+    constexpr size_t GridWidth = 5;
+    constexpr size_t GridHeight = 5;
+    constexpr size_t GridPoints = GridWidth * GridHeight;
+    constexpr double SpringConstant = 8.0;
+
+    class SIMDSpringForces :
+        public ::testing::Test,
+        public WithParamInterface <ws::Isa>
+    {
+        public:
+
+            SIMDSpringForces () :
+                positions (GridPoints * 2),
+                forces (GridPoints * 2, 0.0),
+                expectedForces (GridPoints * 2, 0.0)
+            {
+                /* An odd number of springs, some of which share endpoints
+                 * and some of which have deltas below the clip threshold */
+                std::mt19937 generator (1);
+                std::uniform_real_distribution <double> jitter (-2.0, 2.0);
+
+                for (size_t j = 0; j < GridHeight; ++j)
+                {
+                    for (size_t i = 0; i < GridWidth; ++i)
+                    {
+                        size_t const index = j * GridWidth + i;
+                        positions[index * 2] = i * 10.0 + jitter (generator);
+                        positions[index * 2 + 1] = j * 10.0 + jitter (generator);
+
+                        if (j < GridHeight - 1)
+                            AddSpring (index, index + GridWidth, 0.0, 10.0);
+                        if (i < GridWidth - 1)
+                            AddSpring (index, index + 1, 10.0, 0.0);
+                    }
+                }
+
+                AddSpring (0, GridPoints - 1, 40.0, 40.0);
+            }
+
+            void AddSpring (size_t first, size_t second, double x, double y)
+            {
+                firstIndices.push_back (first);
+                secondIndices.push_back (second);
+                desired.push_back (x);
+                desired.push_back (y);
+            }
+
+            ws::SpringBatch Batch () const
+            {
+                return {
+                    firstIndices.data (),
+                    secondIndices.data (),
+                    desired.data (),
+                    firstIndices.size ()
+                };
+            }
+
+            bool ApplyExpected ()
+            {
+                bool more = false;
+
+                for (size_t i = 0; i < firstIndices.size (); ++i)
+                {
+                    animation::PointView <double const> posA (positions.data (),
+                                                              firstIndices[i]);
+                    animation::PointView <double const> posB (positions.data (),
+                                                              secondIndices[i]);
+                    animation::PointView <double> forceA (expectedForces.data (),
+                                                          firstIndices[i]);
+                    animation::PointView <double> forceB (expectedForces.data (),
+                                                          secondIndices[i]);
+                    animation::Vector distance (desired[i * 2],
+                                                desired[i * 2 + 1]);
+
+                    more |= wobbly::springs::ApplyForces (posA,
+                                                          posB,
+                                                          distance,
+                                                          forceA,
+                                                          forceB,
+                                                          SpringConstant);
+                }
+
+                return more;
+            }
+
+            std::vector <double> positions;
+            std::vector <double> forces;
+            std::vector <double> expectedForces;
+
+            std::vector <size_t> firstIndices;
+            std::vector <size_t> secondIndices;
+            std::vector <double> desired;
+    };
+
+    TEST (SIMD, SelectedIsaIsSupported)
+    {
+        EXPECT_TRUE (ws::IsaSupported (ws::SelectedIsa ()));
+    }
+
+    TEST_P (SIMDSpringForces, ForcesIdenticalToGenericImplementation)
+    {
+        /* Nothing to compare on this CPU */
+        if (!ws::IsaSupported (GetParam ()))
+            return;
+
+        ws::SpringForceKernel kernel (ws::SpringForceKernelFor (GetParam ()));
+        ASSERT_NE (nullptr, kernel);
+
+        bool expectedMore = ApplyExpected ();
+        bool more = kernel (positions.data (),
+                            forces.data (),
+                            Batch (),
+                            SpringConstant);
+
+        EXPECT_EQ (expectedMore, more);
+        EXPECT_THAT (forces, ElementsAreArray (expectedForces));
+    }
+
+    TEST_P (SIMDSpringForces, NoForceWhereAllDeltasClipped)
+    {
+        if (!ws::IsaSupported (GetParam ()))
+            return;
+
+        ws::SpringForceKernel kernel (ws::SpringForceKernelFor (GetParam ()));
+        ASSERT_NE (nullptr, kernel);
+
+        /* Put every point exactly where its springs want it to be */
+        for (size_t j = 0; j < GridHeight; ++j)
+        {
+            for (size_t i = 0; i < GridWidth; ++i)
+            {
+                size_t const index = j * GridWidth + i;
+                positions[index * 2] = i * 10.0 + 0.1;
+                positions[index * 2 + 1] = j * 10.0 - 0.1;
+            }
+        }
+
+        bool more = kernel (positions.data (),
+                            forces.data (),
+                            Batch (),
+                            SpringConstant);
+
+        EXPECT_FALSE (more);
+        EXPECT_THAT (forces, ElementsAreArray (expectedForces));
+    }
+
+    INSTANTIATE_TEST_CASE_P (Variants, SIMDSpringForces,
+                             Values (ws::Isa::Scalar,
+                                     ws::Isa::SSE2,
+                                     ws::Isa::AVX2));
+
+    constexpr double Time = 1.0;
+    constexpr double Friction = 3.0;
+    constexpr double Mass = 15.0;
+
+    class SIMDEulerIntegration :
+        public ::testing::Test,
+        public WithParamInterface <ws::Isa>
+    {
+        public:
+
+            SIMDEulerIntegration () :
+                positions (GridPoints * 2),
+                velocities (GridPoints * 2),
+                forces (GridPoints * 2)
+            {
+                /* Some velocities end up below the clip threshold */
+                std::mt19937 generator (1);
+                std::uniform_real_distribution <double> value (-5.0, 5.0);
+
+                for (size_t i = 0; i < GridPoints * 2; ++i)
+                {
+                    positions[i] = value (generator) * 10.0;
+                    velocities[i] = value (generator) / 10.0;
+                    forces[i] = value (generator);
+                }
+
+                /* Anchor every third point */
+                anchorMask[0] = 0;
+                for (size_t i = 0; i < GridPoints; i += 3)
+                    anchorMask[0] |= uint64_t (1) << i;
+
+                expectedPositions = positions;
+                expectedVelocities = velocities;
+            }
+
+            bool IntegrateExpected ()
+            {
+                bool more = false;
+
+                for (size_t i = 0; i < GridPoints; ++i)
+                {
+                    typedef animation::PointView <double> DPV;
+                    typedef animation::PointView <double const> CDPV;
+
+                    if (anchorMask[0] & (uint64_t (1) << i))
+                    {
+                        DPV velocity (expectedVelocities.data (), i);
+                        agd::assign_value (velocity, 0.0);
+                        continue;
+                    }
+
+                    more |= wobbly::EulerIntegrate (Time,
+                                                    Friction,
+                                                    Mass,
+                                                    DPV (expectedPositions.data (),
+                                                         i),
+                                                    DPV (expectedVelocities.data (),
+                                                         i),
+                                                    CDPV (forces.data (), i));
+                }
+
+                return more;
+            }
+
+            std::vector <double> positions;
+            std::vector <double> velocities;
+            std::vector <double> forces;
+            uint64_t             anchorMask[1];
+
+            std::vector <double> expectedPositions;
+            std::vector <double> expectedVelocities;
+    };
+
+    TEST_P (SIMDEulerIntegration, IdenticalToGenericImplementation)
+    {
+        if (!ws::IsaSupported (GetParam ()))
+            return;
+
+        ws::EulerIntegrationKernel kernel (ws::EulerIntegrationKernelFor (GetParam ()));
+        ASSERT_NE (nullptr, kernel);
+
+        bool expectedMore = IntegrateExpected ();
+        bool more = kernel (Time,
+                            Friction,
+                            Mass,
+                            positions.data (),
+                            velocities.data (),
+                            forces.data (),
+                            anchorMask,
+                            GridPoints);
+
+        EXPECT_EQ (expectedMore, more);
+        EXPECT_THAT (positions, ElementsAreArray (expectedPositions));
+        EXPECT_THAT (velocities, ElementsAreArray (expectedVelocities));
+    }
+
+    TEST_P (SIMDEulerIntegration, NoVelocityRemainingWhereOnlyAnchorsMove)
+    {
+        if (!ws::IsaSupported (GetParam ()))
+            return;
+
+        ws::EulerIntegrationKernel kernel (ws::EulerIntegrationKernelFor (GetParam ()));
+        ASSERT_NE (nullptr, kernel);
+
+        /* Everything at rest except anchored points */
+        std::fill (velocities.begin (), velocities.end (), 0.0);
+        std::fill (forces.begin (), forces.end (), 0.0);
+        for (size_t i = 0; i < GridPoints; i += 3)
+        {
+            velocities[i * 2] = 10.0;
+            forces[i * 2 + 1] = 10.0;
+        }
+
+        bool more = kernel (Time,
+                            Friction,
+                            Mass,
+                            positions.data (),
+                            velocities.data (),
+                            forces.data (),
+                            anchorMask,
+                            GridPoints);
+
+        EXPECT_FALSE (more);
+        EXPECT_THAT (positions, ElementsAreArray (expectedPositions));
+    }
+
+    INSTANTIATE_TEST_CASE_P (Variants, SIMDEulerIntegration,
+                             Values (ws::Isa::Scalar,
+                                     ws::Isa::SSE2,
+                                     ws::Isa::AVX2));
+
+    /* Every lane gets its own mesh, spring lengths, anchors and settings,
+     * so that a kernel mixing up lanes would not go unnoticed */
+    class LaneMeshes
+    {
+        public:
+
+            static constexpr size_t L = ws::Lanes;
+
+            LaneMeshes () :
+                positions (GridPoints * 2 * L),
+                velocities (GridPoints * 2 * L),
+                forces (GridPoints * 2 * L, 0.0),
+                anchored (GridPoints * L, 0)
+            {
+                std::mt19937 generator (1);
+                std::uniform_real_distribution <double> jitter (-4.0, 4.0);
+
+                for (size_t j = 0; j < GridHeight; ++j)
+                {
+                    for (size_t i = 0; i < GridWidth; ++i)
+                    {
+                        size_t const index = j * GridWidth + i;
+
+                        if (j < GridHeight - 1)
+                            AddSpring (index, index + GridWidth, 0.0, 10.0);
+                        if (i < GridWidth - 1)
+                            AddSpring (index, index + 1, 10.0, 0.0);
+
+                        for (size_t l = 0; l < L; ++l)
+                        {
+                            positions[(index * 2) * L + l] = i * 10.0 + jitter (generator);
+                            positions[(index * 2 + 1) * L + l] = j * 10.0 + jitter (generator);
+                            velocities[(index * 2) * L + l] = jitter (generator) / 8;
+                            velocities[(index * 2 + 1) * L + l] = jitter (generator) / 8;
+
+                            if ((index + l) % 7 == 0)
+                                anchored[index * L + l] = ~uint64_t (0);
+                        }
+                    }
+                }
+
+                /* Lengths vary with the lane, like differently sized
+                 * windows */
+                desired.resize (firstIndices.size () * 2 * L);
+                for (size_t s = 0; s < firstIndices.size (); ++s)
+                    for (size_t c = 0; c < 2; ++c)
+                        for (size_t l = 0; l < L; ++l)
+                            desired[(s * 2 + c) * L + l] = baseDesired[s * 2 + c] * (1.0 + l / 4.0);
+
+                for (size_t l = 0; l < L; ++l)
+                {
+                    springConstant[l] = 6.0 + l;
+                    friction[l] = 2.0 + l / 2.0;
+                }
+
+                for (size_t i = 0; i < GridPoints; ++i)
+                {
+                    offsets.push_back (entries.size ());
+
+                    for (size_t s = 0; s < firstIndices.size (); ++s)
+                    {
+                        if (firstIndices[s] == i)
+                            entries.push_back (s << 1);
+                        if (secondIndices[s] == i)
+                            entries.push_back ((s << 1) | 1);
+                    }
+                }
+
+                offsets.push_back (entries.size ());
+            }
+
+            void AddSpring (size_t first, size_t second, double x, double y)
+            {
+                firstIndices.push_back (first);
+                secondIndices.push_back (second);
+                baseDesired.push_back (x);
+                baseDesired.push_back (y);
+            }
+
+            unsigned int Step (ws::LaneStepKernel kernel)
+            {
+                ws::LaneMesh const mesh = {
+                    firstIndices.data (),
+                    secondIndices.data (),
+                    offsets.data (),
+                    entries.data (),
+                    GridPoints
+                };
+                ws::LaneState const state = {
+                    positions.data (),
+                    velocities.data (),
+                    forces.data (),
+                    desired.data (),
+                    anchored.data (),
+                    springConstant,
+                    friction
+                };
+
+                return kernel (mesh, state, Time, Mass);
+            }
+
+            std::vector <double>   positions;
+            std::vector <double>   velocities;
+            std::vector <double>   forces;
+            std::vector <uint64_t> anchored;
+            std::vector <double>   desired;
+            double                 springConstant[L];
+            double                 friction[L];
+
+            std::vector <size_t> firstIndices;
+            std::vector <size_t> secondIndices;
+            std::vector <double> baseDesired;
+            std::vector <size_t> offsets;
+            std::vector <size_t> entries;
+    };
+
+    class SIMDLaneStep :
+        public ::testing::Test,
+        public WithParamInterface <ws::Isa>,
+        public LaneMeshes
+    {
+    };
+
+    TEST_P (SIMDLaneStep, IdenticalToScalarKernel)
+    {
+        if (!ws::IsaSupported (GetParam ()))
+            return;
+
+        ws::LaneStepKernel kernel (ws::LaneStepKernelFor (GetParam ()));
+        ASSERT_NE (nullptr, kernel);
+
+        LaneMeshes expected;
+
+        for (size_t i = 0; i < 10; ++i)
+            EXPECT_EQ (expected.Step (ws::LaneStepKernelFor (ws::Isa::Scalar)),
+                       Step (kernel));
+
+        EXPECT_THAT (positions, ElementsAreArray (expected.positions));
+        EXPECT_THAT (velocities, ElementsAreArray (expected.velocities));
+    }
+
+    TEST_P (SIMDLaneStep, SettledLanesLeftOutOfResult)
+    {
+        if (!ws::IsaSupported (GetParam ()))
+            return;
+
+        ws::LaneStepKernel kernel (ws::LaneStepKernelFor (GetParam ()));
+        ASSERT_NE (nullptr, kernel);
+
+        /* Put the second lane exactly at rest */
+        for (size_t i = 0; i < GridPoints; ++i)
+        {
+            positions[(i * 2) * L + 1] = (i % GridWidth) * 10.0 * 1.25;
+            positions[(i * 2 + 1) * L + 1] = (i / GridWidth) * 10.0 * 1.25;
+            velocities[(i * 2) * L + 1] = 0.0;
+            velocities[(i * 2 + 1) * L + 1] = 0.0;
+        }
+
+        EXPECT_EQ (0u, Step (kernel) & 2u);
+    }
+
+    INSTANTIATE_TEST_CASE_P (Variants, SIMDLaneStep,
+                             Values (ws::Isa::Scalar,
+                                     ws::Isa::SSE2,
+                                     ws::Isa::AVX2));
+
+    TEST (LaneBatch, IdenticalToSpringStepForEachModel)
+    {
+        typedef wobbly::BasicSpringMesh <4, 4> SpringMesh;
+        typedef wobbly::SpringStep <wobbly::EulerIntegration> Step;
+
+        constexpr size_t Models = ws::Lanes - 1;
+
+        wobbly::MeshArray positions[Models];
+        wobbly::EulerIntegration integrators[Models];
+        wobbly::AnchorArray anchors[Models];
+        std::unique_ptr <Step> steps[Models];
+        double const springConstant[Models] = { 8.0, 6.0, 10.0 };
+        double const friction[Models] = { 3.0, 2.0, 4.0 };
+
+        wobbly::MeshArray scratch;
+        SpringMesh grid (scratch, animation::Vector (1, 1));
+        wobbly::LaneTopology <4, 4> topology (grid.BaseSprings ());
+        wobbly::LaneBatch <4, 4> lanes (topology);
+
+        for (size_t m = 0; m < Models; ++m)
+        {
+            animation::Vector const tileSize (10.0 + m, 20.0 - m);
+
+            wobbly::mesh::CalculatePositionArray (animation::Point (m, 0),
+                                                  positions[m],
+                                                  tileSize);
+            for (size_t i = 0; i < positions[m].size (); ++i)
+                positions[m][i] += std::sin (i + m) * 5.0;
+
+            anchors[m].Lock (m * 5);
+
+            steps[m].reset (new Step (integrators[m],
+                                      positions[m],
+                                      springConstant[m],
+                                      friction[m],
+                                      tileSize));
+
+            wobbly::MeshArray spare;
+            SpringMesh lengths (spare, tileSize);
+
+            EXPECT_EQ (m, lanes.Load (positions[m],
+                                      integrators[m].Velocities (),
+                                      lengths.BaseSprings ().desired,
+                                      anchors[m].AnchorMask (),
+                                      springConstant[m],
+                                      friction[m]));
+        }
+
+        unsigned int const more = lanes.Step (5, Mass);
+
+        for (size_t m = 0; m < Models; ++m)
+        {
+            bool expectedMore = false;
+
+            for (size_t i = 0; i < 5; ++i)
+                expectedMore |= (*steps[m]) (positions[m], anchors[m]);
+
+            wobbly::MeshArray lanePositions, laneVelocities;
+            lanes.Store (m, lanePositions, laneVelocities);
+
+            EXPECT_EQ (expectedMore, (more >> m) & 1) << m;
+            EXPECT_THAT (lanePositions, ElementsAreArray (positions[m])) << m;
+            EXPECT_THAT (laneVelocities,
+                         ElementsAreArray (integrators[m].Velocities ())) << m;
+        }
+    }
+}
@@ -0,0 +1,244 @@
+/*
+ * tests/wobbly/snapshot_test.cpp
+ *
+ * Copyright 2018 Endless Mobile, Inc.
+ *
+ * libanimation is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 2.1 of the
+ * License, or (at your option) any later version.
+ *
+ * libanimation is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with eos-companion-app-service.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Tests for reading snapshots of a model from another thread.
+ */
+#include <array>                        // for array
+#include <atomic>                       // for atomic
+#include <cstddef>                      // for size_t
+#include <thread>                       // for thread
+#include <vector>                       // for vector
+
+#include <gmock/gmock-matchers.h>       // for EXPECT_THAT, etc
+#include <gmock/gmock.h>                // IWYU pragma: keep
+#include <gtest/gtest.h>                // for AssertHelper, TEST_F, etc
+
+#include <animation/wobbly/wobbly.h>    // for Model, ModelPool, etc
+
+#include <mathematical_model_matcher.h>  // for Eq, EqDispatchHelper, etc
+#include <ostream_point_operator.h>     // for operator<<
+
+using ::testing::ElementsAreArray;
+using ::testing::Test;
+
+using ::animation::matchers::Eq;
+
+namespace
+{
+    namespace agd = animation::geometry::dimension;
+
+    constexpr double TextureWidth = 50.0;
+    constexpr double TextureHeight = 100.0;
+
+    void ExpectSameExtremes (std::array <animation::Point, 4> const &expected,
+                             std::array <animation::Point, 4> const &actual)
+    {
+        for (size_t corner = 0; corner < 4; ++corner)
+        {
+            EXPECT_EQ (agd::get <0> (expected[corner]), agd::get <0> (actual[corner]));
+            EXPECT_EQ (agd::get <1> (expected[corner]), agd::get <1> (actual[corner]));
+        }
+    }
+
+    class ModelSnapshot :
+        public Test
+    {
+        public:
+
+            ModelSnapshot () :
+                model (animation::Point (0, 0), TextureWidth, TextureHeight)
+            {
+                model.PublishSnapshots ();
+            }
+
+            void Disturb ()
+            {
+                wobbly::Anchor grab (model.GrabAnchor (animation::Point (10, 10)));
+                grab.MoveBy (animation::Point (30, 20));
+            }
+
+            wobbly::Model model;
+    };
+
+    TEST_F (ModelSnapshot, FirstSnapshotIsMeshWhenPublishingStarted)
+    {
+        auto const snapshot (model.LatestSnapshot ());
+
+        EXPECT_EQ (0, snapshot.Sequence ());
+        ExpectSameExtremes (model.Extremes (), snapshot.Extremes ());
+    }
+
+    TEST_F (ModelSnapshot, EachStepPublishesSnapshot)
+    {
+        Disturb ();
+
+        for (unsigned long long step = 1; step <= 3; ++step)
+        {
+            model.Step (16);
+
+            auto const snapshot (model.LatestSnapshot ());
+
+            EXPECT_EQ (step, snapshot.Sequence ());
+            ExpectSameExtremes (model.Extremes (), snapshot.Extremes ());
+        }
+    }
+
+    TEST_F (ModelSnapshot, SnapshotUnchangedUntilNextRead)
+    {
+        Disturb ();
+        model.Step (16);
+
+        auto const snapshot (model.LatestSnapshot ());
+        auto const extremes (snapshot.Extremes ());
+
+        for (size_t i = 0; i < 5; ++i)
+            model.Step (16);
+
+        EXPECT_EQ (1, snapshot.Sequence ());
+        ExpectSameExtremes (extremes, snapshot.Extremes ());
+    }
+
+    TEST_F (ModelSnapshot, DeformsLikeModel)
+    {
+        typedef wobbly::ModelBase::Surface Surface;
+
+        Disturb ();
+
+        for (Surface surface : { Surface::SinglePatch, Surface::PiecewiseBicubic })
+        {
+            model.SetSurface (surface);
+            model.Step (16);
+
+            auto const snapshot (model.LatestSnapshot ());
+            animation::Point const texcoords (0.3, 0.6);
+
+            EXPECT_THAT (snapshot.DeformTexcoords (texcoords),
+                         Eq (model.DeformTexcoords (texcoords)));
+
+            std::vector <double> expected (4 * 5 * 2);
+            std::vector <double> deformed (4 * 5 * 2);
+
+            model.DeformGrid (4, 5, expected.data ());
+            snapshot.DeformGrid (4, 5, deformed.data ());
+
+            EXPECT_THAT (deformed, ElementsAreArray (expected));
+        }
+    }
+
+    TEST (PooledModelSnapshot, StepAllPublishesSnapshot)
+    {
+        wobbly::ModelPool pool;
+        std::vector <wobbly::Model *> models;
+
+        /* Enough models to be stepped in lanes as well as on their own */
+        for (size_t i = 0; i < 5; ++i)
+        {
+            wobbly::Model &model (pool.Create (animation::Point (i * 100.0, 0),
+                                               TextureWidth,
+                                               TextureHeight));
+            model.PublishSnapshots ();
+            models.push_back (&model);
+
+            wobbly::Anchor grab (model.GrabAnchor (animation::Point (i * 100.0, 0)));
+            grab.MoveBy (animation::Point (20, 20));
+        }
+
+        pool.StepAll (16);
+
+        for (wobbly::Model *model : models)
+        {
+            auto const snapshot (model->LatestSnapshot ());
+
+            EXPECT_EQ (1, snapshot.Sequence ());
+            ExpectSameExtremes (model->Extremes (), snapshot.Extremes ());
+        }
+    }
+
+    /* Steps a model on one thread while another keeps reading snapshots
+     * of it, then checks that every snapshot read was exactly the mesh
+     * after that step, by stepping an identical model again on its own */
+    TEST (ModelSnapshotThreads, ReaderSeesWholeSteps)
+    {
+        constexpr size_t Steps = 2000;
+
+        auto const disturb = [](wobbly::Model &model, size_t step) {
+            wobbly::Anchor grab (model.GrabAnchor (animation::Point (0, 0)));
+            grab.MoveBy (animation::Point (step % 7 * 3.0, step % 5 * 4.0));
+        };
+
+        wobbly::Model model (animation::Point (0, 0), TextureWidth, TextureHeight);
+        std::atomic <bool> done (false);
+
+        struct Read
+        {
+            unsigned long long               sequence;
+            std::array <animation::Point, 4> extremes;
+        };
+
+        std::vector <Read> reads;
+
+        model.PublishSnapshots ();
+
+        std::thread reader ([&model, &done, &reads]() {
+            while (!done)
+            {
+                auto const snapshot (model.LatestSnapshot ());
+
+                if (reads.empty () || reads.back ().sequence != snapshot.Sequence ())
+                    reads.push_back ({ snapshot.Sequence (), snapshot.Extremes () });
+            }
+        });
+
+        for (size_t step = 0; step < Steps; ++step)
+        {
+            if (step % 50 == 0)
+                disturb (model, step);
+
+            model.Step (16);
+        }
+
+        done = true;
+        reader.join ();
+
+        wobbly::Model replay (animation::Point (0, 0), TextureWidth, TextureHeight);
+        std::vector <std::array <animation::Point, 4>> expected;
+
+        expected.push_back (replay.Extremes ());
+
+        for (size_t step = 0; step < Steps; ++step)
+        {
+            if (step % 50 == 0)
+                disturb (replay, step);
+
+            replay.Step (16);
+            expected.push_back (replay.Extremes ());
+        }
+
+        unsigned long long last = 0;
+
+        for (Read const &read : reads)
+        {
+            ASSERT_LE (last, read.sequence);
+            ASSERT_LE (read.sequence, Steps);
+
+            ExpectSameExtremes (expected[read.sequence], read.extremes);
+            last = read.sequence;
+        }
+    }
+}